@@ -26,6 +26,22 @@ static void TextWindow(char const* name, char const * begin, char const * end, s
 	ImGui::EndChild();
 }
 
+// leaves text null if the file isn't there
+static void LoadText(char const* fileName, char ** text, char ** textEnd)
+{
+	VFile_Handle fh = VFile_FromFile(fileName, Os_FM_Read);
+	if(!fh) {
+		return;
+	}
+	uint64_t const size = VFile_Size(fh);
+	*text = (char*) MEMORY_MALLOC(size);
+	if(*text) {
+		VFile_Read(fh, *text, size);
+		*textEnd = *text + size;
+	}
+	VFile_Close(fh);
+}
+
 void About_Open() {
 	aboutOpen = true;
 }
@@ -53,22 +69,13 @@ void About_Display() {
 		ImGui::Spacing();
 		ImGui::Text("By Deano Calver using lots of open source software!");
 
+		// the license texts (LIBRARY_LICENSES is thousands of lines) are only read once the window is up
 		if(licenseText == nullptr) {
-			VFile_Handle fh = VFile_FromFile("LICENSE", Os_FM_Read);
-			uint64_t const size = VFile_Size(fh);
-			licenseText = (char*) MEMORY_MALLOC(size);
-			VFile_Read(fh, licenseText, size);
-			VFile_Close(fh);
-			licenseTextEnd = licenseText + size;
+			LoadText("LICENSE", &licenseText, &licenseTextEnd);
 		}
 
 		if(liblicensesText == nullptr) {
-			VFile_Handle fh = VFile_FromFile("LIBRARY_LICENSES", Os_FM_Read);
-			uint64_t const size = VFile_Size(fh);
-			liblicensesText = (char*) MEMORY_MALLOC(size);
-			VFile_Read(fh, liblicensesText, size);
-			VFile_Close(fh);
-			liblicensesTextEnd = liblicensesText + size;
+			LoadText("LIBRARY_LICENSES", &liblicensesText, &liblicensesTextEnd);
 		}
 
 		if(licenseText != nullptr) {
@@ -89,5 +96,10 @@ void About_Display() {
 		}
 
 		ImGui::End();
+
+		// closed with the title bar X, the texts aren't worth keeping until next time
+		if(aboutOpen == false) {
+			About_Close();
+		}
 	}
 }
\ No newline at end of file
@@ -0,0 +1,734 @@
+#include "al2o3_platform/platform.h"
+#include "al2o3_memory/memory.h"
+#include "al2o3_os/time.h"
+#include "gfx_image/image.h"
+#include "gfx_image/create.h"
+
+#include "bc6h.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BC6H_SSE2 1
+#include <emmintrin.h>
+#else
+#define BC6H_SSE2 0
+#endif
+
+static const uint32_t BC6H_BLOCK_BYTES = 16;
+// each output texel is 4 halfs, the alpha of BC6H is always one
+static const uint16_t HALF_ONE = 0x3C00;
+// how many block rows a task handles at once, small enough to balance big mips vs tiny ones
+static const uint32_t ROWS_PER_TASK = 4;
+static const uint32_t BENCHMARK_BLOCK_COUNT = 256 * 1024;
+
+namespace {
+
+// endpoints w,x are region 0, y,z region 1. Fields index endpoint * 3 + channel
+enum Field : uint8_t {
+	RW, GW, BW,
+	RX, GX, BX,
+	RY, GY, BY,
+	RZ, GZ, BZ,
+	D, // partition
+};
+
+// a run of consecutive block bits going to field bits [lowBit, lowBit + count)
+struct Segment {
+	uint8_t field;
+	uint8_t lowBit;
+	uint8_t count;
+};
+
+static const uint32_t MAX_SEGMENTS = 24;
+
+struct Mode {
+	uint8_t modeBits;
+	bool twoRegions;
+	bool transformed;
+	uint8_t endpointBits;
+	uint8_t deltaBits[3];
+	Segment segments[MAX_SEGMENTS]; // zero count terminates
+};
+
+// the D3D11 BC6H bit layouts in stream order, reversed fields are written a bit at a time
+static const Mode Modes[14] = {
+		{2, true, true, 10, {5, 5, 5}, {
+				{GY, 4, 1}, {BY, 4, 1}, {BZ, 4, 1}, {RW, 0, 10}, {GW, 0, 10}, {BW, 0, 10},
+				{RX, 0, 5}, {GZ, 4, 1}, {GY, 0, 4}, {GX, 0, 5}, {BZ, 0, 1}, {GZ, 0, 4},
+				{BX, 0, 5}, {BZ, 1, 1}, {BY, 0, 4}, {RY, 0, 5}, {BZ, 2, 1}, {RZ, 0, 5},
+				{BZ, 3, 1}, {D, 0, 5}}},
+		{2, true, true, 7, {6, 6, 6}, {
+				{GY, 5, 1}, {GZ, 4, 1}, {GZ, 5, 1}, {RW, 0, 7}, {BZ, 0, 1}, {BZ, 1, 1},
+				{BY, 4, 1}, {GW, 0, 7}, {BY, 5, 1}, {BZ, 2, 1}, {GY, 4, 1}, {BW, 0, 7},
+				{BZ, 3, 1}, {BZ, 5, 1}, {BZ, 4, 1}, {RX, 0, 6}, {GY, 0, 4}, {GX, 0, 6},
+				{GZ, 0, 4}, {BX, 0, 6}, {BY, 0, 4}, {RY, 0, 6}, {RZ, 0, 6}, {D, 0, 5}}},
+		{5, true, true, 11, {5, 4, 4}, {
+				{RW, 0, 10}, {GW, 0, 10}, {BW, 0, 10}, {RX, 0, 5}, {RW, 10, 1}, {GY, 0, 4},
+				{GX, 0, 4}, {GW, 10, 1}, {BZ, 0, 1}, {GZ, 0, 4}, {BX, 0, 4}, {BW, 10, 1},
+				{BZ, 1, 1}, {BY, 0, 4}, {RY, 0, 5}, {BZ, 2, 1}, {RZ, 0, 5}, {BZ, 3, 1},
+				{D, 0, 5}}},
+		{5, true, true, 11, {4, 5, 4}, {
+				{RW, 0, 10}, {GW, 0, 10}, {BW, 0, 10}, {RX, 0, 4}, {RW, 10, 1}, {GZ, 4, 1},
+				{GY, 0, 4}, {GX, 0, 5}, {GW, 10, 1}, {GZ, 0, 4}, {BX, 0, 4}, {BW, 10, 1},
+				{BZ, 1, 1}, {BY, 0, 4}, {RY, 0, 4}, {BZ, 0, 1}, {BZ, 2, 1}, {RZ, 0, 4},
+				{GY, 4, 1}, {BZ, 3, 1}, {D, 0, 5}}},
+		{5, true, true, 11, {4, 4, 5}, {
+				{RW, 0, 10}, {GW, 0, 10}, {BW, 0, 10}, {RX, 0, 4}, {RW, 10, 1}, {BY, 4, 1},
+				{GY, 0, 4}, {GX, 0, 4}, {GW, 10, 1}, {BZ, 0, 1}, {GZ, 0, 4}, {BX, 0, 5},
+				{BW, 10, 1}, {BY, 0, 4}, {RY, 0, 4}, {BZ, 1, 1}, {BZ, 2, 1}, {RZ, 0, 4},
+				{BZ, 4, 1}, {BZ, 3, 1}, {D, 0, 5}}},
+		{5, true, true, 9, {5, 5, 5}, {
+				{RW, 0, 9}, {BY, 4, 1}, {GW, 0, 9}, {GY, 4, 1}, {BW, 0, 9}, {BZ, 4, 1},
+				{RX, 0, 5}, {GZ, 4, 1}, {GY, 0, 4}, {GX, 0, 5}, {BZ, 0, 1}, {GZ, 0, 4},
+				{BX, 0, 5}, {BZ, 1, 1}, {BY, 0, 4}, {RY, 0, 5}, {BZ, 2, 1}, {RZ, 0, 5},
+				{BZ, 3, 1}, {D, 0, 5}}},
+		{5, true, true, 8, {6, 5, 5}, {
+				{RW, 0, 8}, {GZ, 4, 1}, {BY, 4, 1}, {GW, 0, 8}, {BZ, 2, 1}, {GY, 4, 1},
+				{BW, 0, 8}, {BZ, 3, 1}, {BZ, 4, 1}, {RX, 0, 6}, {GY, 0, 4}, {GX, 0, 5},
+				{BZ, 0, 1}, {GZ, 0, 4}, {BX, 0, 5}, {BZ, 1, 1}, {BY, 0, 4}, {RY, 0, 6},
+				{RZ, 0, 6}, {D, 0, 5}}},
+		{5, true, true, 8, {5, 6, 5}, {
+				{RW, 0, 8}, {BZ, 0, 1}, {BY, 4, 1}, {GW, 0, 8}, {GY, 5, 1}, {GY, 4, 1},
+				{BW, 0, 8}, {GZ, 5, 1}, {BZ, 4, 1}, {RX, 0, 5}, {GZ, 4, 1}, {GY, 0, 4},
+				{GX, 0, 6}, {GZ, 0, 4}, {BX, 0, 5}, {BZ, 1, 1}, {BY, 0, 4}, {RY, 0, 5},
+				{BZ, 2, 1}, {RZ, 0, 5}, {BZ, 3, 1}, {D, 0, 5}}},
+		{5, true, true, 8, {5, 5, 6}, {
+				{RW, 0, 8}, {BZ, 1, 1}, {BY, 4, 1}, {GW, 0, 8}, {BY, 5, 1}, {GY, 4, 1},
+				{BW, 0, 8}, {BZ, 5, 1}, {BZ, 4, 1}, {RX, 0, 5}, {GZ, 4, 1}, {GY, 0, 4},
+				{GX, 0, 5}, {BZ, 0, 1}, {GZ, 0, 4}, {BX, 0, 6}, {BY, 0, 4}, {RY, 0, 5},
+				{BZ, 2, 1}, {RZ, 0, 5}, {BZ, 3, 1}, {D, 0, 5}}},
+		{5, true, false, 6, {6, 6, 6}, {
+				{RW, 0, 6}, {GZ, 4, 1}, {BZ, 0, 1}, {BZ, 1, 1}, {BY, 4, 1}, {GW, 0, 6},
+				{GY, 5, 1}, {BY, 5, 1}, {BZ, 2, 1}, {GY, 4, 1}, {BW, 0, 6}, {GZ, 5, 1},
+				{BZ, 3, 1}, {BZ, 5, 1}, {BZ, 4, 1}, {RX, 0, 6}, {GY, 0, 4}, {GX, 0, 6},
+				{GZ, 0, 4}, {BX, 0, 6}, {BY, 0, 4}, {RY, 0, 6}, {RZ, 0, 6}, {D, 0, 5}}},
+		{5, false, false, 10, {10, 10, 10}, {
+				{RW, 0, 10}, {GW, 0, 10}, {BW, 0, 10}, {RX, 0, 10}, {GX, 0, 10}, {BX, 0, 10}}},
+		{5, false, true, 11, {9, 9, 9}, {
+				{RW, 0, 10}, {GW, 0, 10}, {BW, 0, 10}, {RX, 0, 9}, {RW, 10, 1}, {GX, 0, 9},
+				{GW, 10, 1}, {BX, 0, 9}, {BW, 10, 1}}},
+		{5, false, true, 12, {8, 8, 8}, {
+				{RW, 0, 10}, {GW, 0, 10}, {BW, 0, 10}, {RX, 0, 8}, {RW, 11, 1}, {RW, 10, 1},
+				{GX, 0, 8}, {GW, 11, 1}, {GW, 10, 1}, {BX, 0, 8}, {BW, 11, 1}, {BW, 10, 1}}},
+		{5, false, true, 16, {4, 4, 4}, {
+				{RW, 0, 10}, {GW, 0, 10}, {BW, 0, 10}, {RX, 0, 4}, {RW, 15, 1}, {RW, 14, 1},
+				{RW, 13, 1}, {RW, 12, 1}, {RW, 11, 1}, {RW, 10, 1}, {GX, 0, 4}, {GW, 15, 1},
+				{GW, 14, 1}, {GW, 13, 1}, {GW, 12, 1}, {GW, 11, 1}, {GW, 10, 1}, {BX, 0, 4},
+				{BW, 15, 1}, {BW, 14, 1}, {BW, 13, 1}, {BW, 12, 1}, {BW, 11, 1}, {BW, 10, 1}}},
+};
+
+// the low 5 bits of a block to its Modes index, -1 is reserved. 2 bit modes repeat
+static const int8_t ModeOfBits[32] = {
+		0, 1, 2, 10, 0, 1, 3, 11, 0, 1, 4, 12, 0, 1, 5, 13,
+		0, 1, 6, -1, 0, 1, 7, -1, 0, 1, 8, -1, 0, 1, 9, -1,
+};
+
+// bit n set if texel n is in region 1
+static const uint16_t PartitionMasks[32] = {
+		0xCCCC, 0x8888, 0xEEEE, 0xECC8, 0xC880, 0xFEEC, 0xFEC8, 0xEC80,
+		0xC800, 0xFFEC, 0xFE80, 0xE800, 0xFFE8, 0xFF00, 0xFFF0, 0xF000,
+		0xF710, 0x008E, 0x7100, 0x08CE, 0x008C, 0x7310, 0x3100, 0x8CCE,
+		0x088C, 0x3110, 0x6666, 0x366C, 0x17E8, 0x0FF0, 0x718E, 0x399C,
+};
+
+// region 1's anchor texel, which like texel 0 stores its index a bit shorter
+static const uint8_t AnchorOfRegion1[32] = {
+		15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15,
+		15, 2, 8, 2, 2, 8, 8, 15, 2, 8, 2, 2, 8, 8, 2, 2,
+};
+
+static const uint8_t Weights3[8] = {0, 9, 18, 27, 37, 46, 55, 64};
+static const uint8_t Weights4[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+// blocks with their expected RGB, alpha is always one. The random ones are cross checked
+// against Pillow's BC6H decoder at the 8 bits it outputs, apart from where it departs from
+// the D3D11 reference: it skips the +32 when interpolating and the sign extend after the
+// inverse transform. The mode 11 ones are built by hand, raw endpoints and every weight once,
+// their halfs worked from the D3D11 spec's unquantize, lerp and finish_unquantize (what
+// DirectXTex's D3DX_BC6H decode does) without going through this decoder
+struct KnownAnswer {
+	uint8_t block[BC6H_BLOCK_BYTES];
+	bool isSigned;
+	uint16_t rgb[16 * 3];
+};
+
+static const KnownAnswer KnownAnswers[] = {
+		// unsigned mode 1
+		{{0xB8, 0xE8, 0xCD, 0x4E, 0xA9, 0x3D, 0x7D, 0x0A, 0x1D, 0xF0, 0x42, 0x13, 0xB6, 0x27, 0x3B, 0x04},
+		 false, {
+				0x656A, 0x31D4, 0x1448, 0x6621, 0x3279, 0x1362, 0x65A7, 0x31F6, 0x136B, 0x6621, 0x3279, 0x1362,
+				0x656A, 0x31D4, 0x1448, 0x6445, 0x32C4, 0x1308, 0x65A7, 0x31F6, 0x136B, 0x65A7, 0x31F6, 0x136B,
+				0x64DA, 0x324A, 0x13AB, 0x650A, 0x3222, 0x13DF, 0x65A7, 0x31F6, 0x136B, 0x65A7, 0x31F6, 0x136B,
+				0x653A, 0x31FB, 0x1414, 0x64A5, 0x3275, 0x1371, 0x656A, 0x31D4, 0x1448, 0x671C, 0x3386, 0x1350,
+		}},
+		// unsigned mode 2
+		{{0x79, 0xD3, 0xCF, 0xC3, 0x07, 0xB3, 0xCA, 0xBA, 0xA6, 0x27, 0xB9, 0xD8, 0x49, 0xC4, 0xF7, 0x2C},
+		 false, {
+				0x34CC, 0x243C, 0x5B74, 0x41E0, 0x2719, 0x59F5, 0x2C80, 0x3260, 0x54E3, 0x29B7, 0x1C18, 0x5A75,
+				0x6A90, 0x2FFF, 0x554B, 0x2C80, 0x3260, 0x54E3, 0x2C80, 0x3260, 0x54E3, 0x2C80, 0x3260, 0x54E3,
+				0x2BF5, 0x2E04, 0x55FA, 0x2ACE, 0x24D0, 0x5847, 0x292C, 0x17BC, 0x5B8C, 0x2A43, 0x2074, 0x595E,
+				0x292C, 0x17BC, 0x5B8C, 0x2ACE, 0x24D0, 0x5847, 0x2A43, 0x2074, 0x595E, 0x2D0C, 0x36BC, 0x53CC,
+		}},
+		// unsigned mode 10
+		{{0x1E, 0xF8, 0x94, 0x6B, 0x71, 0x00, 0x81, 0x87, 0xD2, 0x7F, 0xF1, 0x3A, 0x6E, 0x40, 0x29, 0xC9},
+		 false, {
+				0x0000, 0x5068, 0x67A8, 0x1C18, 0x1078, 0x1E08, 0x1431, 0x2273, 0x32BD, 0x1824, 0x1975, 0x2862,
+				0x03F3, 0x476A, 0x5D4D, 0x1824, 0x1975, 0x2862, 0x1431, 0x2273, 0x32BD, 0x03F3, 0x476A, 0x5D4D,
+				0x0000, 0x5068, 0x67A8, 0x103D, 0x2B71, 0x3D17, 0x07E6, 0x3E6C, 0x52F3, 0x5CAA, 0x1FF8, 0x24FE,
+				0x03F3, 0x476A, 0x5D4D, 0x5689, 0x1FF8, 0x265B, 0x5689, 0x1FF8, 0x265B, 0x62CC, 0x1FF8, 0x23A1,
+		}},
+		// unsigned mode 14
+		{{0xEF, 0x8A, 0x6D, 0x0C, 0x91, 0x07, 0x82, 0x15, 0xBC, 0x2C, 0x8C, 0x60, 0xB7, 0x2A, 0x28, 0xD5},
+		 false, {
+				0x746A, 0x3E6A, 0x1F3F, 0x746A, 0x3E6A, 0x1F3E, 0x746B, 0x3E6A, 0x1F3E, 0x746A, 0x3E6A, 0x1F40,
+				0x746B, 0x3E6A, 0x1F3E, 0x746A, 0x3E6A, 0x1F3F, 0x746A, 0x3E6A, 0x1F40, 0x746A, 0x3E6A, 0x1F3F,
+				0x746A, 0x3E6A, 0x1F3F, 0x746A, 0x3E6A, 0x1F3E, 0x746A, 0x3E6A, 0x1F3F, 0x746A, 0x3E6A, 0x1F40,
+				0x746A, 0x3E6A, 0x1F3F, 0x746A, 0x3E6A, 0x1F40, 0x746A, 0x3E6A, 0x1F3F, 0x746B, 0x3E6A, 0x1F3E,
+		}},
+		// signed mode 3
+		{{0x22, 0x42, 0x21, 0xE6, 0x89, 0x59, 0x77, 0x4C, 0x14, 0x61, 0xEE, 0xE6, 0x37, 0xDB, 0x07, 0xAC},
+		 true, {
+				0xBCC4, 0xF45F, 0xDF0B, 0xBB9F, 0xF458, 0xDE7E, 0xBAED, 0xF484, 0xDE68, 0xBB33, 0xF473, 0xDE71,
+				0xBD8F, 0xF4B1, 0xDF77, 0xBDD1, 0xF4CB, 0xDF9A, 0xBB7C, 0xF460, 0xDE7A, 0xBAED, 0xF484, 0xDE68,
+				0xBCC4, 0xF45F, 0xDF0B, 0xBCC4, 0xF45F, 0xDF0B, 0xBDD1, 0xF4CB, 0xDF9A, 0xBB33, 0xF473, 0xDE71,
+				0xBC00, 0xF411, 0xDEA2, 0xBC00, 0xF411, 0xDEA2, 0xBCC4, 0xF45F, 0xDF0B, 0xBD4E, 0xF497, 0xDF54,
+		}},
+		// signed mode 11
+		{{0xA3, 0xD6, 0x31, 0xB8, 0xF9, 0x0B, 0x24, 0x98, 0x42, 0x94, 0x21, 0x81, 0x9E, 0x59, 0x81, 0x56},
+		 true, {
+				0xC576, 0x1AF5, 0x36AC, 0xA249, 0x2441, 0x3ACE, 0xA249, 0x2441, 0x3ACE, 0x1687, 0x3346, 0x417B,
+				0xC576, 0x1AF5, 0x36AC, 0xB7EF, 0x1E88, 0x3843, 0xC576, 0x1AF5, 0x36AC, 0x0BB5, 0x306A, 0x4035,
+				0x520E, 0x4302, 0x4879, 0x1687, 0x3346, 0x417B, 0x1687, 0x3346, 0x417B, 0x9777, 0x271D, 0x3C13,
+				0xC576, 0x1AF5, 0x36AC, 0x0BB5, 0x306A, 0x4035, 0x89EF, 0x2AB1, 0x3DAA, 0x9777, 0x271D, 0x3C13,
+		}},
+		// unsigned mode 11
+		{{0x03, 0x80, 0xFF, 0x59, 0xFA, 0x1F, 0x00, 0x5E, 0x11, 0x32, 0x54, 0x76, 0x98, 0xBA, 0xDC, 0xFE},
+		 false, {
+				0x0000, 0x7BFF, 0x2463, 0x07C0, 0x743F, 0x276A, 0x1170, 0x6A8F, 0x2B33, 0x1930, 0x62CF, 0x2E3A,
+				0x20F0, 0x5B0F, 0x3141, 0x28B0, 0x534F, 0x3448, 0x3260, 0x499F, 0x3811, 0x3A20, 0x41DF, 0x3B18,
+				0x41DF, 0x3A20, 0x3E1F, 0x499F, 0x3260, 0x4126, 0x534F, 0x28B0, 0x44EE, 0x5B0F, 0x20F0, 0x47F5,
+				0x62CF, 0x1930, 0x4AFC, 0x6A8F, 0x1170, 0x4E03, 0x743F, 0x07C0, 0x51CC, 0x7BFF, 0x0000, 0x54D3,
+		}},
+		// signed mode 11
+		{{0x03, 0x40, 0x80, 0x38, 0xFF, 0x0F, 0x60, 0x00, 0x10, 0x32, 0x54, 0x76, 0x98, 0xBA, 0xDC, 0xFE},
+		 true, {
+				0xFBFF, 0x3E1F, 0x9857, 0xEC7F, 0x365B, 0x96D1, 0xD91F, 0x2CA6, 0x94EA, 0xC99F, 0x24E2, 0x9364,
+				0xBA20, 0x1D1E, 0x91DF, 0xAAA0, 0x155A, 0x9059, 0x9740, 0x0BA5, 0x8E73, 0x87C0, 0x03E1, 0x8CEE,
+				0x07C0, 0x83E1, 0x8B68, 0x1740, 0x8BA5, 0x89E3, 0x2AA0, 0x955A, 0x87FC, 0x3A20, 0x9D1E, 0x8676,
+				0x499F, 0xA4E2, 0x84F1, 0x591F, 0xACA6, 0x836B, 0x6C7F, 0xB65B, 0x8185, 0x7BFF, 0xBE1F, 0x0000,
+		}},
+		// reserved mode, the reference decodes these to zero
+		{{0x5F, 0x82, 0xC2, 0xD9, 0xCF, 0xEB, 0x0F, 0xA3, 0x21, 0xD7, 0xD9, 0x82, 0xF8, 0xBD, 0x10, 0x45},
+		 false, {}},
+};
+
+// everything the interpolation needs, endpoints already unquantised
+struct Block {
+	int32_t endpoints[12];
+	uint8_t weights[16];
+	uint16_t regionMask;
+};
+
+struct Bits {
+	uint64_t lo;
+	uint64_t hi;
+};
+
+uint32_t BitsAt(Bits const &bits, uint32_t start, uint32_t count) {
+	uint64_t v;
+	if (start >= 64) {
+		v = bits.hi >> (start - 64);
+	} else if (start + count <= 64) {
+		v = bits.lo >> start;
+	} else {
+		v = (bits.lo >> start) | (bits.hi << (64 - start));
+	}
+	return (uint32_t) (v & ((1ull << count) - 1));
+}
+
+int32_t SignExtend(int32_t v, uint32_t bits) {
+	uint32_t const shift = 32 - bits;
+	return (int32_t) ((uint32_t) v << shift) >> shift;
+}
+
+int32_t UnquantiseScalar(int32_t v, uint32_t bits, bool isSigned) {
+	if (!isSigned) {
+		if (bits >= 15 || v == 0) {
+			return v;
+		}
+		if (v == (1 << bits) - 1) {
+			return 0xFFFF;
+		}
+		return ((v << 16) + 0x8000) >> bits;
+	}
+
+	if (bits >= 16) {
+		return v;
+	}
+	bool const negative = v < 0;
+	int32_t const magnitude = negative ? -v : v;
+	int32_t q;
+	if (magnitude == 0) {
+		q = 0;
+	} else if (magnitude >= (1 << (bits - 1)) - 1) {
+		q = 0x7FFF;
+	} else {
+		q = ((magnitude << 15) + 0x4000) >> (bits - 1);
+	}
+	return negative ? -q : q;
+}
+
+uint16_t FinishUnquantiseScalar(int32_t v, bool isSigned) {
+	if (!isSigned) {
+		return (uint16_t) ((v * 31) >> 6);
+	}
+	int32_t const magnitude = v < 0 ? ((-v) * 31) >> 5 : (v * 31) >> 5;
+	return (uint16_t) ((v < 0 && magnitude ? 0x8000 : 0) | magnitude);
+}
+
+#if BC6H_SSE2
+void UnquantiseEndpointsSSE2(int32_t endpoints[12], uint32_t bits, bool isSigned) {
+	if (bits >= (isSigned ? 16u : 15u)) {
+		return;
+	}
+	__m128i const zero = _mm_setzero_si128();
+	for (uint32_t i = 0; i < 12; i += 4) {
+		__m128i v = _mm_loadu_si128((__m128i const *) (endpoints + i));
+		__m128i q;
+		if (!isSigned) {
+			__m128i const max = _mm_set1_epi32((1 << bits) - 1);
+			q = _mm_srl_epi32(_mm_add_epi32(_mm_slli_epi32(v, 16), _mm_set1_epi32(0x8000)), _mm_cvtsi32_si128(bits));
+			__m128i const isMax = _mm_cmpeq_epi32(v, max);
+			q = _mm_or_si128(_mm_andnot_si128(isMax, q), _mm_and_si128(isMax, _mm_set1_epi32(0xFFFF)));
+			q = _mm_andnot_si128(_mm_cmpeq_epi32(v, zero), q);
+		} else {
+			__m128i const sign = _mm_srai_epi32(v, 31);
+			__m128i const magnitude = _mm_sub_epi32(_mm_xor_si128(v, sign), sign);
+			__m128i const almostMax = _mm_set1_epi32((1 << (bits - 1)) - 2);
+			q = _mm_sra_epi32(_mm_add_epi32(_mm_slli_epi32(magnitude, 15), _mm_set1_epi32(0x4000)),
+												_mm_cvtsi32_si128(bits - 1));
+			__m128i const isMax = _mm_cmpgt_epi32(magnitude, almostMax);
+			q = _mm_or_si128(_mm_andnot_si128(isMax, q), _mm_and_si128(isMax, _mm_set1_epi32(0x7FFF)));
+			q = _mm_andnot_si128(_mm_cmpeq_epi32(magnitude, zero), q);
+			q = _mm_sub_epi32(_mm_xor_si128(q, sign), sign);
+		}
+		_mm_storeu_si128((__m128i *) (endpoints + i), q);
+	}
+}
+#endif
+
+// false for the reserved modes
+bool UnpackBlock(uint8_t const *src, bool isSigned, bool simd, Block *out) {
+	Bits bits;
+	memcpy(&bits.lo, src, sizeof(uint64_t));
+	memcpy(&bits.hi, src + sizeof(uint64_t), sizeof(uint64_t));
+
+	int8_t const modeIndex = ModeOfBits[bits.lo & 0x1F];
+	if (modeIndex < 0) {
+		return false;
+	}
+	Mode const &mode = Modes[modeIndex];
+
+	uint32_t fields[13] = {};
+	uint32_t pos = mode.modeBits;
+	for (uint32_t i = 0; i < MAX_SEGMENTS && mode.segments[i].count; ++i) {
+		Segment const &segment = mode.segments[i];
+		fields[segment.field] |= BitsAt(bits, pos, segment.count) << segment.lowBit;
+		pos += segment.count;
+	}
+
+	uint32_t const endpointCount = mode.twoRegions ? 12 : 6;
+	uint32_t const epb = mode.endpointBits;
+	int32_t *e = out->endpoints;
+	for (uint32_t i = 0; i < 12; ++i) {
+		e[i] = (int32_t) fields[i];
+	}
+	if (isSigned) {
+		for (uint32_t c = 0; c < 3; ++c) {
+			e[c] = SignExtend(e[c], epb);
+		}
+	}
+	if (isSigned || mode.transformed) {
+		for (uint32_t i = 3; i < endpointCount; ++i) {
+			e[i] = SignExtend(e[i], mode.deltaBits[i % 3]);
+		}
+	}
+	if (mode.transformed) {
+		int32_t const mask = (1 << epb) - 1;
+		for (uint32_t i = 3; i < endpointCount; ++i) {
+			e[i] = (e[i % 3] + e[i]) & mask;
+			if (isSigned) {
+				e[i] = SignExtend(e[i], epb);
+			}
+		}
+	}
+
+#if BC6H_SSE2
+	if (simd) {
+		UnquantiseEndpointsSSE2(e, epb, isSigned);
+	} else
+#endif
+	{
+		for (uint32_t i = 0; i < 12; ++i) {
+			e[i] = UnquantiseScalar(e[i], epb, isSigned);
+		}
+	}
+
+	if (mode.twoRegions) {
+		uint32_t const partition = fields[D];
+		uint32_t const anchor = AnchorOfRegion1[partition];
+		out->regionMask = PartitionMasks[partition];
+		pos = 82;
+		for (uint32_t i = 0; i < 16; ++i) {
+			uint32_t const count = (i == 0 || i == anchor) ? 2 : 3;
+			out->weights[i] = Weights3[BitsAt(bits, pos, count)];
+			pos += count;
+		}
+	} else {
+		out->regionMask = 0;
+		pos = 65;
+		for (uint32_t i = 0; i < 16; ++i) {
+			uint32_t const count = i == 0 ? 3 : 4;
+			out->weights[i] = Weights4[BitsAt(bits, pos, count)];
+			pos += count;
+		}
+	}
+	return true;
+}
+
+void InterpolateScalar(Block const &block, bool isSigned, uint16_t *texels) {
+	for (uint32_t i = 0; i < 16; ++i) {
+		int32_t const *e = block.endpoints + ((block.regionMask >> i) & 1) * 6;
+		int32_t const w = block.weights[i];
+		for (uint32_t c = 0; c < 3; ++c) {
+			int32_t const v = (e[c] * (64 - w) + e[3 + c] * w + 32) >> 6;
+			texels[i * 4 + c] = FinishUnquantiseScalar(v, isSigned);
+		}
+		texels[i * 4 + 3] = HALF_ONE;
+	}
+}
+
+#if BC6H_SSE2
+// each lane is a texels (e0, e1) pair against its (64 - w, w) so madd does the lerp.
+// unsigned endpoints are biased into int16 range and the bias added back after
+void InterpolateSSE2(Block const &block, bool isSigned, uint16_t *texels) {
+	int32_t const bias = isSigned ? 0 : 0x8000;
+	int32_t const *e = block.endpoints;
+
+	__m128i pairs[2][3];
+	for (uint32_t region = 0; region < 2; ++region) {
+		for (uint32_t c = 0; c < 3; ++c) {
+			uint32_t const e0 = (uint16_t) (e[region * 6 + c] - bias);
+			uint32_t const e1 = (uint16_t) (e[region * 6 + 3 + c] - bias);
+			pairs[region][c] = _mm_set1_epi32((int32_t) (e0 | (e1 << 16)));
+		}
+	}
+
+	__m128i const regionBits = _mm_setr_epi32(1, 2, 4, 8);
+	__m128i const rounding = _mm_set1_epi32(bias * 64 + 32);
+	__m128i const zero = _mm_setzero_si128();
+	__m128i const alpha = _mm_set1_epi16((short) HALF_ONE);
+	__m128i const signBit = _mm_set1_epi32(0x8000);
+
+	// a quad of texels is a row of the block
+	for (uint32_t row = 0; row < 4; ++row) {
+		uint8_t const *w = block.weights + row * 4;
+		__m128i const weights = _mm_setr_epi16((short) (64 - w[0]), (short) w[0], (short) (64 - w[1]), (short) w[1],
+																					 (short) (64 - w[2]), (short) w[2], (short) (64 - w[3]), (short) w[3]);
+		__m128i const rowMask = _mm_set1_epi32((block.regionMask >> (row * 4)) & 0xF);
+		__m128i const inRegion1 = _mm_cmpeq_epi32(_mm_and_si128(rowMask, regionBits), regionBits);
+
+		__m128i channels[3];
+		for (uint32_t c = 0; c < 3; ++c) {
+			__m128i const pair = _mm_or_si128(_mm_and_si128(inRegion1, pairs[1][c]),
+																				_mm_andnot_si128(inRegion1, pairs[0][c]));
+			__m128i const v = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(pair, weights), rounding), 6);
+			__m128i h;
+			if (!isSigned) {
+				h = _mm_srli_epi32(_mm_sub_epi32(_mm_slli_epi32(v, 5), v), 6);
+			} else {
+				__m128i const sign = _mm_srai_epi32(v, 31);
+				__m128i const magnitude = _mm_sub_epi32(_mm_xor_si128(v, sign), sign);
+				h = _mm_srli_epi32(_mm_sub_epi32(_mm_slli_epi32(magnitude, 5), magnitude), 5);
+				// a result that rounds to zero stays positive zero
+				h = _mm_or_si128(h, _mm_andnot_si128(_mm_cmpeq_epi32(h, zero), _mm_and_si128(sign, signBit)));
+			}
+			// sign extend from 16 bits so the saturating pack keeps the bit pattern
+			h = _mm_srai_epi32(_mm_slli_epi32(h, 16), 16);
+			channels[c] = _mm_packs_epi32(h, h);
+		}
+
+		__m128i const rg = _mm_unpacklo_epi16(channels[0], channels[1]);
+		__m128i const ba = _mm_unpacklo_epi16(channels[2], alpha);
+		_mm_storeu_si128((__m128i *) (texels + row * 16), _mm_unpacklo_epi32(rg, ba));
+		_mm_storeu_si128((__m128i *) (texels + row * 16 + 8), _mm_unpackhi_epi32(rg, ba));
+	}
+}
+#endif
+
+void DecodeBlock(uint8_t const *src, bool isSigned, bool simd, uint16_t *texels) {
+	Block block;
+	if (!UnpackBlock(src, isSigned, simd, &block)) {
+		for (uint32_t i = 0; i < 16; ++i) {
+			texels[i * 4 + 0] = 0;
+			texels[i * 4 + 1] = 0;
+			texels[i * 4 + 2] = 0;
+			texels[i * 4 + 3] = HALF_ONE;
+		}
+		return;
+	}
+#if BC6H_SSE2
+	if (simd) {
+		InterpolateSSE2(block, isSigned, texels);
+		return;
+	}
+#endif
+	InterpolateScalar(block, isSigned, texels);
+}
+
+// a 2D slice of one mip level, rows are counted across all surfaces so tasks can split anywhere
+struct Surface {
+	uint8_t const *src;
+	uint16_t *dst;
+	uint32_t width;
+	uint32_t height;
+	uint32_t blocksWide;
+	uint32_t firstRow;
+	uint32_t rowCount;
+};
+
+struct DecodeJob {
+	Surface *surfaces;
+	uint32_t surfaceCount;
+	uint32_t totalRows;
+	bool isSigned;
+	bool simd;
+};
+
+void DecodeRow(DecodeJob const *job, Surface const &surface, uint32_t row) {
+	uint16_t texels[16 * 4];
+	uint8_t const *src = surface.src + (uint64_t) row * surface.blocksWide * BC6H_BLOCK_BYTES;
+	uint32_t const y0 = row * 4;
+	uint32_t const rows = surface.height - y0 < 4 ? surface.height - y0 : 4;
+
+	for (uint32_t bx = 0; bx < surface.blocksWide; ++bx) {
+		DecodeBlock(src + bx * BC6H_BLOCK_BYTES, job->isSigned, job->simd, texels);
+
+		uint32_t const x0 = bx * 4;
+		uint32_t const cols = surface.width - x0 < 4 ? surface.width - x0 : 4;
+		for (uint32_t y = 0; y < rows; ++y) {
+			memcpy(surface.dst + ((uint64_t) (y0 + y) * surface.width + x0) * 4, texels + y * 16, cols * 4 * sizeof(uint16_t));
+		}
+	}
+}
+
+void DecodeRows(DecodeJob const *job, uint32_t start, uint32_t end) {
+	uint32_t s = 0;
+	for (uint32_t row = start; row < end; ++row) {
+		while (row >= job->surfaces[s].firstRow + job->surfaces[s].rowCount) {
+			++s;
+		}
+		DecodeRow(job, job->surfaces[s], row - job->surfaces[s].firstRow);
+	}
+}
+
+void DecodeRowsTask(uint32_t start, uint32_t end, uint32_t threadnum, void *args) {
+	auto job = (DecodeJob const *) args;
+	uint32_t const endRow = end * ROWS_PER_TASK;
+	DecodeRows(job, start * ROWS_PER_TASK, endRow < job->totalRows ? endRow : job->totalRows);
+}
+
+void RunJob(DecodeJob *job, enkiTaskSchedulerHandle taskScheduler) {
+	if (!taskScheduler) {
+		DecodeRows(job, 0, job->totalRows);
+		return;
+	}
+	enkiTaskSetHandle task = enkiCreateTaskSet(taskScheduler, &DecodeRowsTask);
+	enkiAddTaskSetToPipe(taskScheduler, task, job, (job->totalRows + ROWS_PER_TASK - 1) / ROWS_PER_TASK);
+	enkiWaitForTaskSet(taskScheduler, task);
+	enkiDeleteTaskSet(task);
+}
+
+// logs any known answer either path gets wrong, false if there were any
+bool CheckKnownAnswers() {
+	uint32_t const count = sizeof(KnownAnswers) / sizeof(KnownAnswers[0]);
+	uint32_t exact = 0;
+	for (uint32_t i = 0; i < count; ++i) {
+		KnownAnswer const &answer = KnownAnswers[i];
+		bool blockExact = true;
+		for (uint32_t path = 0; path < 2; ++path) {
+			uint16_t texels[16 * 4];
+			DecodeBlock(answer.block, answer.isSigned, path != 0, texels);
+			bool match = true;
+			for (uint32_t t = 0; t < 16 && match; ++t) {
+				match = texels[t * 4 + 0] == answer.rgb[t * 3 + 0] && texels[t * 4 + 1] == answer.rgb[t * 3 + 1] &&
+						texels[t * 4 + 2] == answer.rgb[t * 3 + 2] && texels[t * 4 + 3] == HALF_ONE;
+			}
+			if (!match) {
+				LOGWARNING("BC6H known answer %u is wrong on the %s path", i, path ? "SIMD" : "scalar");
+				blockExact = false;
+			}
+		}
+		exact += blockExact;
+	}
+	LOGINFO("BC6H known answers: %u of %u blocks bit exact", exact, count);
+	return exact == count;
+}
+
+} // end anon namespace
+
+bool Bc6h_IsBc6h(TinyImageFormat format) {
+	return format == TinyImageFormat_DXBC6H_UFLOAT || format == TinyImageFormat_DXBC6H_SFLOAT;
+}
+
+void Bc6h_DecodeBlock(void const *block, bool isSigned, uint16_t texels[64]) {
+	DecodeBlock((uint8_t const *) block, isSigned, BC6H_SSE2 != 0, texels);
+}
+
+Image_ImageHeader const *Bc6h_Decode(Image_ImageHeader const *image, enkiTaskSchedulerHandle taskScheduler) {
+	if (!image || !Bc6h_IsBc6h(image->format)) {
+		return nullptr;
+	}
+
+	// only the levels the source has, a full chain would be wasted on a truncated one
+	size_t const mipCount = Image_MipMapCountOf(image);
+	Image_ImageHeader *decoded = nullptr;
+	Image_ImageHeader *lastLevel = nullptr;
+	for (size_t level = 0; level < mipCount; ++level) {
+		Image_ImageHeader const *src = Image_LinkedImageOf(image, level);
+		Image_ImageHeader *dst = Image_Create(src->width, src->height, src->depth, src->slices,
+																					TinyImageFormat_R16G16B16A16_SFLOAT);
+		if (!dst) {
+			if (decoded) {
+				Image_Destroy(decoded);
+			}
+			return nullptr;
+		}
+		if (lastLevel) {
+			lastLevel->nextType = Image_NT_MipMap;
+			lastLevel->nextImage = dst;
+		} else {
+			decoded = dst;
+		}
+		lastLevel = dst;
+	}
+
+	uint32_t surfaceCount = 0;
+	for (size_t level = 0; level < mipCount; ++level) {
+		Image_ImageHeader const *src = Image_LinkedImageOf(image, level);
+		surfaceCount += src->depth * src->slices;
+	}
+	auto surfaces = (Surface *) MEMORY_MALLOC(sizeof(Surface) * surfaceCount);
+	if (!surfaces) {
+		Image_Destroy(decoded);
+		return nullptr;
+	}
+
+	uint32_t totalRows = 0;
+	uint32_t index = 0;
+	for (size_t level = 0; level < mipCount; ++level) {
+		Image_ImageHeader const *src = Image_LinkedImageOf(image, level);
+		Image_ImageHeader const *dst = Image_LinkedImageOf(decoded, level);
+		uint32_t const blocksWide = (src->width + 3) / 4;
+		uint32_t const blocksHigh = (src->height + 3) / 4;
+		uint64_t const srcSurfaceBytes = (uint64_t) blocksWide * blocksHigh * BC6H_BLOCK_BYTES;
+		uint64_t const dstSurfaceTexels = (uint64_t) dst->width * dst->height;
+
+		for (uint32_t i = 0; i < src->depth * src->slices; ++i) {
+			Surface &surface = surfaces[index++];
+			surface.src = (uint8_t const *) Image_RawDataPtr(src) + i * srcSurfaceBytes;
+			surface.dst = (uint16_t *) Image_RawDataPtr(dst) + i * dstSurfaceTexels * 4;
+			surface.width = src->width;
+			surface.height = src->height;
+			surface.blocksWide = blocksWide;
+			surface.firstRow = totalRows;
+			surface.rowCount = blocksHigh;
+			totalRows += blocksHigh;
+		}
+	}
+
+	DecodeJob job{surfaces, surfaceCount, totalRows, image->format == TinyImageFormat_DXBC6H_SFLOAT, BC6H_SSE2 != 0};
+	int64_t const startUs = Os_GetUSec();
+	RunJob(&job, taskScheduler);
+	int64_t const decodeUs = Os_GetUSec() - startUs;
+
+	uint64_t blockCount = 0;
+	for (uint32_t i = 0; i < surfaceCount; ++i) {
+		blockCount += (uint64_t) surfaces[i].blocksWide * surfaces[i].rowCount;
+	}
+	LOGINFO("BC6H decoded %llu blocks in %.2fms (%.1f MTexel/s)",
+					(unsigned long long) blockCount,
+					(double) decodeUs / 1000.0,
+					decodeUs > 0 ? (double) (blockCount * 16) / (double) decodeUs : 0.0);
+
+	MEMORY_FREE(surfaces);
+	return decoded;
+}
+
+bool Bc6h_Benchmark(enkiTaskSchedulerHandle taskScheduler) {
+	bool ok = CheckKnownAnswers();
+
+	// a square of random blocks, mode bits are random too so reserved modes get a look in
+	uint32_t const blocksWide = 512;
+	uint32_t const blocksHigh = BENCHMARK_BLOCK_COUNT / blocksWide;
+	uint64_t const srcBytes = (uint64_t) BENCHMARK_BLOCK_COUNT * BC6H_BLOCK_BYTES;
+	uint64_t const dstBytes = (uint64_t) BENCHMARK_BLOCK_COUNT * 16 * 4 * sizeof(uint16_t);
+
+	auto src = (uint8_t *) MEMORY_MALLOC(srcBytes);
+	auto scalar = (uint16_t *) MEMORY_MALLOC(dstBytes);
+	auto simd = (uint16_t *) MEMORY_MALLOC(dstBytes);
+	if (!src || !scalar || !simd) {
+		MEMORY_FREE(src);
+		MEMORY_FREE(scalar);
+		MEMORY_FREE(simd);
+		return false;
+	}
+
+	uint32_t state = 0x12345678;
+	for (uint64_t i = 0; i < srcBytes; ++i) {
+		state ^= state << 13;
+		state ^= state >> 17;
+		state ^= state << 5;
+		src[i] = (uint8_t) state;
+	}
+
+	for (uint32_t sign = 0; sign < 2; ++sign) {
+		bool const isSigned = sign != 0;
+		Surface surface{src, scalar, blocksWide * 4, blocksHigh * 4, blocksWide, 0, blocksHigh};
+		DecodeJob job{&surface, 1, blocksHigh, isSigned, false};
+
+		int64_t startUs = Os_GetUSec();
+		RunJob(&job, nullptr);
+		int64_t const scalarUs = Os_GetUSec() - startUs;
+
+		surface.dst = simd;
+		job.simd = BC6H_SSE2 != 0;
+		startUs = Os_GetUSec();
+		RunJob(&job, nullptr);
+		int64_t const simdUs = Os_GetUSec() - startUs;
+
+		startUs = Os_GetUSec();
+		RunJob(&job, taskScheduler);
+		int64_t const threadedUs = Os_GetUSec() - startUs;
+
+		uint64_t mismatches = 0;
+		for (uint64_t i = 0; i < dstBytes / sizeof(uint16_t); ++i) {
+			mismatches += scalar[i] != simd[i];
+		}
+
+		double const texels = (double) BENCHMARK_BLOCK_COUNT * 16;
+		LOGINFO("BC6H %s benchmark: scalar %.1f, %s %.1f, %u threads %.1f MTexel/s, %llu scalar/simd mismatches",
+						isSigned ? "SFLOAT" : "UFLOAT",
+						texels / (double) (scalarUs > 0 ? scalarUs : 1),
+						BC6H_SSE2 ? "SSE2" : "scalar (no SIMD)",
+						texels / (double) (simdUs > 0 ? simdUs : 1),
+						enkiGetNumTaskThreads(taskScheduler),
+						texels / (double) (threadedUs > 0 ? threadedUs : 1),
+						(unsigned long long) mismatches);
+		ok &= mismatches == 0;
+	}
+
+	MEMORY_FREE(src);
+	MEMORY_FREE(scalar);
+	MEMORY_FREE(simd);
+	return ok;
+}
@@ -0,0 +1,26 @@
+#pragma once
+#ifndef DEVON_BC6H_HPP
+#define DEVON_BC6H_HPP
+
+#include "al2o3_enki/TaskScheduler_c.h"
+#include "gfx_image/image.h"
+
+// Software BC6H (signed and unsigned) decode to R16G16B16A16_SFLOAT for backends
+// that can't sample it. Follows the D3D11 reference decode so output is bit exact.
+// Endpoint unquantise and interpolation use SSE2 where available, block rows are
+// spread over the task scheduler.
+
+bool Bc6h_IsBc6h(TinyImageFormat format);
+
+// decodes every slice and the mip levels the source has, the source is left alone. Null if not BC6H
+Image_ImageHeader const *Bc6h_Decode(Image_ImageHeader const *image, enkiTaskSchedulerHandle taskScheduler);
+
+// a single 16 byte block to 4x4 RGBA halfs, row major
+void Bc6h_DecodeBlock(void const *block, bool isSigned, uint16_t texels[64]);
+
+// checks both paths against a handful of known answer blocks, then decodes a few MB of
+// random blocks scalar, SIMD and threaded and logs the throughput of each, along with
+// any disagreement between the scalar and SIMD paths. False if anything didn't match
+bool Bc6h_Benchmark(enkiTaskSchedulerHandle taskScheduler);
+
+#endif //DEVON_BC6H_HPP
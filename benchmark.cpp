@@ -0,0 +1,313 @@
+#include "al2o3_platform/platform.h"
+#include "al2o3_memory/memory.h"
+#include "al2o3_vfile/vfile.h"
+#include "gfx_image/image.h"
+#include "gfx_image/create.h"
+#include "render_basics/texture.h"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+#include "benchmark.hpp"
+#include "texture_load.hpp"
+#include "texture_bytes.hpp"
+
+// first frames pay for uploads and pipeline creation, leave them out
+static const uint32_t WARMUP_FRAMES = 30;
+// mips and slices step this often, zoom sweeps once a period
+static const uint32_t FRAMES_PER_MIP = 20;
+static const uint32_t FRAMES_PER_SLICE = 10;
+static const float ZOOM_PERIOD_FRAMES = 240.0f;
+// roughly how many screen pixels across each texture is at zoom 1 of the sweep
+static const float ON_SCREEN_SIZE = 256.0f;
+
+static TinyImageFormat const Formats[] = {
+		TinyImageFormat_R8G8B8A8_UNORM,
+		TinyImageFormat_R8_UNORM,
+		TinyImageFormat_R16G16B16A16_SFLOAT,
+		TinyImageFormat_R32G32B32A32_SFLOAT,
+		TinyImageFormat_DXBC1_RGBA_UNORM,
+		TinyImageFormat_DXBC7_UNORM,
+};
+static const uint32_t FORMAT_COUNT = sizeof(Formats) / sizeof(Formats[0]);
+
+struct Shape {
+	uint32_t width;
+	uint32_t height;
+	uint32_t slices;
+	bool mips;
+};
+static Shape const Shapes[] = {
+		{1024, 1024, 1, true},
+		{512, 512, 8, true},
+		{2048, 2048, 1, false},
+};
+static const uint32_t SHAPE_COUNT = sizeof(Shapes) / sizeof(Shapes[0]);
+
+struct Benchmark {
+	Render_RendererHandle renderer;
+	uint32_t textureCount;
+	uint32_t frameCount;
+	uint32_t frame; // including warm up
+
+	// one per frame after warm up
+	int64_t *cpuUs;
+	int64_t *gpuUs;
+	bool gpuMeasured;
+
+	// per texture totals after warm up
+	int64_t *encodeUs;
+	TinyImageFormat *formats;
+};
+
+namespace {
+
+uint32_t Hash(uint32_t x) {
+	x ^= x >> 16;
+	x *= 0x7feb352dU;
+	x ^= x >> 15;
+	x *= 0x846ca68bU;
+	x ^= x >> 16;
+	return x;
+}
+
+// noise in the 0-1 range for float formats, raw bytes for the rest (any bytes are valid BC1/BC7)
+void FillLevel(Image_ImageHeader *level, uint32_t seed) {
+	TinyImageFormat const format = level->format;
+	uint64_t const bytes = TextureBytes_Of(format, level->width, level->height, level->depth, level->slices, 1);
+	auto data = (uint8_t *) Image_RawDataPtr(level);
+
+	if (!TinyImageFormat_IsFloat(format)) {
+		for (uint64_t i = 0; i < bytes; ++i) {
+			data[i] = (uint8_t) Hash((uint32_t) i + seed);
+		}
+		return;
+	}
+
+	uint32_t const channelBits = TinyImageFormat_BitSizeOfBlock(format) / TinyImageFormat_ChannelCount(format);
+	if (channelBits == 16) {
+		auto halfs = (uint16_t *) data;
+		for (uint64_t i = 0; i < bytes / 2; ++i) {
+			halfs[i] = (uint16_t) (Hash((uint32_t) i + seed) % 0x3C00); // below 1.0
+		}
+	} else {
+		auto floats = (float *) data;
+		for (uint64_t i = 0; i < bytes / 4; ++i) {
+			floats[i] = (float) (Hash((uint32_t) i + seed) & 0xFFFF) / 65535.0f;
+		}
+	}
+}
+
+// nearest rank on a sorted array
+int64_t Percentile(int64_t const *sorted, uint32_t count, double p) {
+	if (count == 0) {
+		return 0;
+	}
+	auto rank = (uint32_t) ceil(p * (double) count);
+	rank = rank == 0 ? 1 : rank;
+	return sorted[(rank > count ? count : rank) - 1];
+}
+
+int CompareInt64(void const *a, void const *b) {
+	int64_t const x = *(int64_t const *) a;
+	int64_t const y = *(int64_t const *) b;
+	return x < y ? -1 : (x > y ? 1 : 0);
+}
+
+// writes "name": {mean, p50, p90, p99, max} in ms. values is sorted in place
+int WriteStats(char *line, size_t lineSize, char const *name, int64_t *values, uint32_t count) {
+	qsort(values, count, sizeof(int64_t), &CompareInt64);
+	int64_t total = 0;
+	for (uint32_t i = 0; i < count; ++i) {
+		total += values[i];
+	}
+	double const mean = count ? (double) total / (double) count : 0.0;
+	return snprintf(line, lineSize,
+									"\t\"%s\": {\"mean\": %.3f, \"p50\": %.3f, \"p90\": %.3f, \"p99\": %.3f, \"max\": %.3f},\n",
+									name,
+									mean / 1000.0,
+									(double) Percentile(values, count, 0.5) / 1000.0,
+									(double) Percentile(values, count, 0.9) / 1000.0,
+									(double) Percentile(values, count, 0.99) / 1000.0,
+									count ? (double) values[count - 1] / 1000.0 : 0.0);
+}
+
+// half the viewers pick their mip from the zoom like a user would, the rest step it.
+// Staggered by shape so each format gets both
+bool AutoMipOf(uint32_t index) {
+	return ((index / FORMAT_COUNT) + index) % 2 == 1;
+}
+
+uint32_t MeasuredFrames(Benchmark const *bench) {
+	return bench->frame > WARMUP_FRAMES ? bench->frame - WARMUP_FRAMES : 0;
+}
+
+} // end anon namespace
+
+BenchmarkHandle Benchmark_Create(Render_RendererHandle renderer, uint32_t textureCount, uint32_t frameCount) {
+	if (textureCount == 0 || frameCount == 0) {
+		return nullptr;
+	}
+
+	auto bench = (Benchmark *) MEMORY_CALLOC(1, sizeof(Benchmark));
+	if (!bench) {
+		return nullptr;
+	}
+	bench->renderer = renderer;
+	bench->textureCount = textureCount;
+	bench->frameCount = frameCount;
+	bench->gpuMeasured = true;
+	bench->cpuUs = (int64_t *) MEMORY_CALLOC(frameCount, sizeof(int64_t));
+	bench->gpuUs = (int64_t *) MEMORY_CALLOC(frameCount, sizeof(int64_t));
+	bench->encodeUs = (int64_t *) MEMORY_CALLOC(textureCount, sizeof(int64_t));
+	bench->formats = (TinyImageFormat *) MEMORY_CALLOC(textureCount, sizeof(TinyImageFormat));
+	if (!bench->cpuUs || !bench->gpuUs || !bench->encodeUs || !bench->formats) {
+		Benchmark_Destroy(bench);
+		return nullptr;
+	}
+	return bench;
+}
+
+void Benchmark_Destroy(BenchmarkHandle handle) {
+	auto bench = (Benchmark *) handle;
+	if (!bench) {
+		return;
+	}
+	MEMORY_FREE(bench->formats);
+	MEMORY_FREE(bench->encodeUs);
+	MEMORY_FREE(bench->gpuUs);
+	MEMORY_FREE(bench->cpuUs);
+	MEMORY_FREE(bench);
+}
+
+uint32_t Benchmark_TextureCount(BenchmarkHandle handle) {
+	auto bench = (Benchmark *) handle;
+	return bench ? bench->textureCount : 0;
+}
+
+Image_ImageHeader const *Benchmark_CreateImage(BenchmarkHandle handle, uint32_t index) {
+	auto bench = (Benchmark *) handle;
+	if (!bench || index >= bench->textureCount) {
+		return nullptr;
+	}
+
+	TinyImageFormat format = Formats[index % FORMAT_COUNT];
+	if (!Render_RendererCanShaderReadFrom(bench->renderer, format)) {
+		format = TinyImageFormat_R8G8B8A8_UNORM;
+	}
+	Shape const &shape = Shapes[(index / FORMAT_COUNT) % SHAPE_COUNT];
+
+	Image_ImageHeader *image = Image_Create(shape.width, shape.height, 1, shape.slices, format);
+	if (!image) {
+		return nullptr;
+	}
+	if (shape.mips && !Image_CreateMipMapChain(image, false)) {
+		Image_Destroy(image);
+		return nullptr;
+	}
+	for (uint32_t level = 0; level < (uint32_t) Image_MipMapCountOf(image); ++level) {
+		FillLevel((Image_ImageHeader *) Image_LinkedImageOf(image, level), (index << 8) + level);
+	}
+
+	bench->formats[index] = format;
+	return TextureLoad_PackMipmaps(image, nullptr);
+}
+
+void Benchmark_Animate(BenchmarkHandle handle, uint32_t index, Image_ImageHeader const *image, Benchmark_View *view) {
+	auto bench = (Benchmark *) handle;
+	if (!bench || !image) {
+		return;
+	}
+
+	// each texture is out of phase with the others so the total on screen area stays steady
+	float const phase = ((float) bench->frame / ZOOM_PERIOD_FRAMES) + ((float) index / (float) bench->textureCount);
+	float const sweep = 0.5f + 0.5f * sinf(phase * 6.2831853f);
+	view->zoom = (ON_SCREEN_SIZE / (float) image->width) * (0.25f + (1.75f * sweep));
+
+	auto const mipCount = (uint32_t) Image_MipMapCountOf(image);
+	view->autoMip = AutoMipOf(index);
+	view->mipLevel = ((bench->frame / FRAMES_PER_MIP) + index) % mipCount;
+	view->slice = ((bench->frame / FRAMES_PER_SLICE) + index) % image->slices;
+}
+
+void Benchmark_AddViewer(BenchmarkHandle handle, uint32_t index, int64_t encodeUs) {
+	auto bench = (Benchmark *) handle;
+	if (!bench || index >= bench->textureCount || bench->frame < WARMUP_FRAMES) {
+		return;
+	}
+	bench->encodeUs[index] += encodeUs;
+}
+
+bool Benchmark_AddFrame(BenchmarkHandle handle, int64_t cpuUs, int64_t gpuUs) {
+	auto bench = (Benchmark *) handle;
+	if (!bench) {
+		return false;
+	}
+
+	if (bench->frame >= WARMUP_FRAMES) {
+		uint32_t const i = bench->frame - WARMUP_FRAMES;
+		if (i >= bench->frameCount) {
+			return false;
+		}
+		bench->cpuUs[i] = cpuUs;
+		bench->gpuUs[i] = gpuUs;
+		if (gpuUs < 0) {
+			bench->gpuMeasured = false;
+		}
+	}
+	bench->frame++;
+	return MeasuredFrames(bench) < bench->frameCount;
+}
+
+bool Benchmark_WriteResults(BenchmarkHandle handle, char const *fileName) {
+	auto bench = (Benchmark *) handle;
+	if (!bench) {
+		return false;
+	}
+
+	VFile_Handle fh = VFile_FromFile(fileName, Os_FM_Write);
+	if (!fh) {
+		LOGINFO("Unable to open %s for the benchmark results", fileName);
+		return false;
+	}
+
+	uint32_t const count = MeasuredFrames(bench);
+	char line[1024];
+	int len = snprintf(line, sizeof(line), "{\n\t\"textures\": %u,\n\t\"frames\": %u,\n\t\"warmupFrames\": %u,\n",
+										 bench->textureCount, count, WARMUP_FRAMES);
+	VFile_Write(fh, line, (size_t) len);
+
+	len = WriteStats(line, sizeof(line), "cpuFrameMs", bench->cpuUs, count);
+	VFile_Write(fh, line, (size_t) len);
+	if (bench->gpuMeasured) {
+		// not GPU time, there are no timestamp queries and present may be vsynced
+		len = WriteStats(line, sizeof(line), "presentWaitMs", bench->gpuUs, count);
+		VFile_Write(fh, line, (size_t) len);
+		len = snprintf(line, sizeof(line),
+									 "\t\"presentWaitMsIs\": \"queue wait idle after present, includes present and vsync\",\n");
+		VFile_Write(fh, line, (size_t) len);
+	}
+
+	len = snprintf(line, sizeof(line), "\t\"viewers\": [");
+	VFile_Write(fh, line, (size_t) len);
+	for (uint32_t i = 0; i < bench->textureCount; ++i) {
+		Shape const &shape = Shapes[(i / FORMAT_COUNT) % SHAPE_COUNT];
+		len = snprintf(line, sizeof(line),
+									 "%s\n\t\t{\"format\": \"%s\", \"width\": %u, \"height\": %u, \"slices\": %u, \"mips\": %s, "
+									 "\"autoMip\": %s, \"meanEncodeUs\": %.2f}",
+									 i == 0 ? "" : ",",
+									 TinyImageFormat_Name(bench->formats[i]),
+									 shape.width, shape.height, shape.slices,
+									 shape.mips ? "true" : "false",
+									 AutoMipOf(i) ? "true" : "false",
+									 count ? (double) bench->encodeUs[i] / (double) count : 0.0);
+		VFile_Write(fh, line, (size_t) len);
+	}
+
+	len = snprintf(line, sizeof(line), "\n\t]\n}\n");
+	VFile_Write(fh, line, (size_t) len);
+	VFile_Close(fh);
+
+	LOGINFO("Benchmark of %u textures over %u frames written to %s", bench->textureCount, count, fileName);
+	return true;
+}
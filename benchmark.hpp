@@ -0,0 +1,41 @@
+#pragma once
+#ifndef DEVON_BENCHMARK_HPP
+#define DEVON_BENCHMARK_HPP
+
+#include "render_basics/api.h"
+#include "gfx_image/image.h"
+
+// Scripted render stress test. Synthetic textures of assorted formats and shapes
+// are opened, their zoom, mip and slice animated every frame, and CPU and GPU frame
+// time percentiles written as json at the end. render_basics has no GPU timestamps and
+// no way to turn vsync off, so rather than a GPU time the json has presentWaitMs, the
+// queue wait after present including present and vsync. Needs no files or particular
+// GPU so it runs under a software rasteriser (lavapipe) on CI machines.
+typedef struct Benchmark *BenchmarkHandle;
+
+BenchmarkHandle Benchmark_Create(Render_RendererHandle renderer, uint32_t textureCount, uint32_t frameCount);
+void Benchmark_Destroy(BenchmarkHandle handle);
+
+uint32_t Benchmark_TextureCount(BenchmarkHandle handle);
+// the index'th synthetic texture with packed mips, ready to upload. Formats the
+// renderer can't sample are swapped for RGBA8
+Image_ImageHeader const *Benchmark_CreateImage(BenchmarkHandle handle, uint32_t index);
+
+typedef struct Benchmark_View {
+	float zoom;
+	bool autoMip; // mip follows the zoom, mipLevel is ignored
+	uint32_t mipLevel;
+	uint32_t slice;
+} Benchmark_View;
+// where the index'th texture should be this frame
+void Benchmark_Animate(BenchmarkHandle handle, uint32_t index, Image_ImageHeader const *image, Benchmark_View *view);
+
+// per viewer CPU encode time for the frame about to be added
+void Benchmark_AddViewer(BenchmarkHandle handle, uint32_t index, int64_t encodeUs);
+// gpuUs < 0 if it wasn't measured. False once every frame is in
+bool Benchmark_AddFrame(BenchmarkHandle handle, int64_t cpuUs, int64_t gpuUs);
+
+// percentiles over the frames after warm up
+bool Benchmark_WriteResults(BenchmarkHandle handle, char const *fileName);
+
+#endif //DEVON_BENCHMARK_HPP
@@ -0,0 +1,682 @@
+#include "al2o3_platform/platform.h"
+#include "al2o3_memory/memory.h"
+#include "al2o3_os/time.h"
+#include "gfx_image/image.h"
+#include "gfx_imagedecompress/imagedecompress.h"
+#include "tiny_imageformat/tinyimageformat_decode.h"
+#include "gfx_imgui/imgui.h"
+#include "gfx_imgui/imgui_internal.h"
+
+#include "render_basics/api.h"
+#include "render_basics/buffer.h"
+#include "render_basics/descriptorset.h"
+#include "render_basics/framebuffer.h"
+#include "render_basics/graphicsencoder.h"
+#include "render_basics/texture.h"
+#include <atomic>
+
+#include "contact_sheet.hpp"
+#include "frames_in_flight.hpp"
+#include "quad_pipeline.hpp"
+#include "bc6h.hpp"
+
+// must match contactsheet_fragment.hlsl
+static const uint32_t MAX_CONTACT_SHEET_CELLS = 512;
+static const uint32_t CELL_SIZE = 256;
+static const uint32_t CELL_MIP_COUNT = 9; // 256 down to 1
+static const uint32_t CELL_SUPERSAMPLE = 4;
+static const uint32_t CELL_NAME_LENGTH = 64;
+// whilst building the atlas is re-uploaded with the cells landed so far this often, plus
+// this much longer per MB of atlas so big sheets don't spend the build re-uploading
+static const int64_t ATLAS_UPLOAD_PERIOD_US = 200000;
+static const int64_t ATLAS_UPLOAD_US_PER_MB = 2000;
+
+struct CellUniforms {
+	float colourMask[4];
+	int32_t mipLevel;
+	float alphaReplicate;
+	float padding[2];
+};
+
+struct SheetUniforms {
+	float scaleOffsetMatrix[16];
+	CellUniforms cells[MAX_CONTACT_SHEET_CELLS];
+};
+
+static const uint64_t UNIFORM_BUFFER_SIZE_PER_FRAME = (sizeof(SheetUniforms) + 255) & ~255;
+
+struct CellState {
+	bool colourChannelEnable[4];
+	int mipLevel;
+};
+
+namespace {
+
+// a build in flight, the workers own the sources and write the atlas data
+struct BuildArgs {
+	Image_ImageHeader const **sources; // the level each cell starts from, destroyed once used
+	uint32_t count;
+	uint8_t *atlasData;
+	uint64_t atlasSize;
+	std::atomic<uint32_t> cellsDone;
+	std::atomic<bool> cancel;
+};
+
+} // end anon namespace
+
+struct ContactSheet {
+	Render_RendererHandle renderer;
+	Render_FrameBufferHandle frameBuffer;
+	enkiTaskSchedulerHandle taskScheduler;
+
+	QuadPipeline quad;
+	Render_DescriptorSetHandle descriptorSet;
+	Render_BufferHandle uniformBuffer;
+
+	Render_TextureHandle atlas;
+	enkiTaskSetHandle buildTask;
+	BuildArgs build;
+	uint32_t uploadedCells;
+	int64_t lastUploadUs;
+	uint32_t cellCount;
+	char (*names)[CELL_NAME_LENGTH];
+	CellState *cellStates;
+
+	SheetUniforms uniforms;
+	SheetUniforms uploadedUniforms;
+	uint32_t dirtyFrames;
+
+	bool colourChannelEnable[4];
+	int mipLevel;
+	float cellDisplaySize;
+
+	Render_GraphicsEncoderHandle currentEncoder;
+};
+
+namespace {
+
+uint64_t CellByteCountOf(uint32_t level) {
+	uint32_t const size = CELL_SIZE >> level;
+	return (uint64_t) size * size * 4;
+}
+
+// atlas data is level major like Image_PackMipmaps, all cells of level 0 then level 1...
+uint8_t *CellDataOf(uint8_t *atlasData, uint32_t count, uint32_t cell, uint32_t level) {
+	uint64_t offset = 0;
+	for (uint32_t i = 0; i < level; ++i) {
+		offset += CellByteCountOf(i) * count;
+	}
+	return atlasData + offset + (CellByteCountOf(level) * cell);
+}
+
+uint64_t TopSliceByteCountOf(Image_ImageHeader const *image) {
+	uint32_t const bw = TinyImageFormat_WidthOfBlock(image->format);
+	uint32_t const bh = TinyImageFormat_HeightOfBlock(image->format);
+	uint64_t const blocks = (uint64_t) ((image->width + bw - 1) / bw) * ((image->height + bh - 1) / bh);
+	return blocks * TinyImageFormat_BitSizeOfBlock(image->format) / 8;
+}
+
+// a single 2D copy of the first slice of the smallest mip still at least a cell across,
+// so the build doesn't need the image and doesn't filter more than it has to. Caller destroys
+Image_ImageHeader const *CellSourceOf(Image_ImageHeader const *image) {
+	Image_ImageHeader const *level = image;
+	for (size_t i = 1; i < Image_MipMapCountOf(image); ++i) {
+		Image_ImageHeader const *next = Image_LinkedImageOf(image, i);
+		if ((next->width > next->height ? next->width : next->height) < CELL_SIZE) {
+			break;
+		}
+		level = next;
+	}
+
+	Image_ImageHeader *copy = Image_Create(level->width, level->height, 1, 1, level->format);
+	if (!copy) {
+		return nullptr;
+	}
+	memcpy(Image_RawDataPtr(copy), Image_RawDataPtr(level), TopSliceByteCountOf(level));
+	return copy;
+}
+
+// decompresses a cell source if needed, destroying it. Null if it can't be
+Image_ImageHeader const *DecodableOf(Image_ImageHeader const *source) {
+	if (!TinyImageFormat_IsCompressed(source->format)) {
+		return source;
+	}
+
+	// gfx_imagedecompress doesn't do BC6H. The cells are already spread across the
+	// workers so the decode runs inline
+	Image_ImageHeader const *decompressed = Bc6h_IsBc6h(source->format) ?
+																					Bc6h_Decode(source, nullptr) :
+																					Image_Decompress(source);
+	if (decompressed == source) {
+		decompressed = nullptr;
+	}
+	Image_Destroy(source);
+	return decompressed;
+}
+
+uint8_t ToUnorm8(float v) {
+	v = v < 0.0f ? 0.0f : (v > 1.0f ? 1.0f : v);
+	return (uint8_t) (v * 255.0f + 0.5f);
+}
+
+// fits the image into the cell keeping its aspect ratio, supersampled box filter
+void DownsampleIntoCell(Image_ImageHeader const *image, uint8_t *cell) {
+	uint32_t const w = image->width;
+	uint32_t const h = image->height;
+	float const scale = (float) CELL_SIZE / (float) (w > h ? w : h);
+	uint32_t contentW = (uint32_t) ((float) w * scale + 0.5f);
+	uint32_t contentH = (uint32_t) ((float) h * scale + 0.5f);
+	contentW = contentW ? contentW : 1;
+	contentH = contentH ? contentH : 1;
+	uint32_t const offsetX = (CELL_SIZE - contentW) / 2;
+	uint32_t const offsetY = (CELL_SIZE - contentH) / 2;
+
+	uint32_t const bw = TinyImageFormat_WidthOfBlock(image->format);
+	uint64_t const rowBytes = ((w + bw - 1) / bw) * TinyImageFormat_BitSizeOfBlock(image->format) / 8;
+
+	auto srcRow = (float *) MEMORY_MALLOC(sizeof(float) * 4 * w);
+	auto accum = (float *) MEMORY_MALLOC(sizeof(float) * 4 * contentW);
+	if (!srcRow || !accum) {
+		MEMORY_FREE(srcRow);
+		MEMORY_FREE(accum);
+		return;
+	}
+
+	float const weight = 1.0f / (float) (CELL_SUPERSAMPLE * CELL_SUPERSAMPLE);
+	for (uint32_t y = 0; y < contentH; ++y) {
+		memset(accum, 0, sizeof(float) * 4 * contentW);
+		for (uint32_t sy = 0; sy < CELL_SUPERSAMPLE; ++sy) {
+			float const fy = ((float) y + ((float) sy + 0.5f) / CELL_SUPERSAMPLE) / (float) contentH;
+			uint32_t srcY = (uint32_t) (fy * (float) h);
+			srcY = srcY < h ? srcY : h - 1;
+
+			TinyImageFormat_DecodeInput input{};
+			input.pixel = (uint8_t const *) Image_RawDataPtr(image) + (srcY * rowBytes);
+			TinyImageFormat_DecodeLogicalPixelsF(image->format, &input, w, srcRow);
+
+			for (uint32_t x = 0; x < contentW; ++x) {
+				for (uint32_t sx = 0; sx < CELL_SUPERSAMPLE; ++sx) {
+					float const fx = ((float) x + ((float) sx + 0.5f) / CELL_SUPERSAMPLE) / (float) contentW;
+					uint32_t srcX = (uint32_t) (fx * (float) w);
+					srcX = srcX < w ? srcX : w - 1;
+					for (uint32_t c = 0; c < 4; ++c) {
+						accum[(x * 4) + c] += srcRow[(srcX * 4) + c] * weight;
+					}
+				}
+			}
+		}
+
+		uint8_t *dst = cell + ((((offsetY + y) * CELL_SIZE) + offsetX) * 4);
+		for (uint32_t i = 0; i < contentW * 4; ++i) {
+			dst[i] = ToUnorm8(accum[i]);
+		}
+	}
+
+	MEMORY_FREE(accum);
+	MEMORY_FREE(srcRow);
+}
+
+void BuildMipOfCell(uint8_t const *src, uint8_t *dst, uint32_t dstSize) {
+	uint32_t const srcSize = dstSize * 2;
+	for (uint32_t y = 0; y < dstSize; ++y) {
+		for (uint32_t x = 0; x < dstSize; ++x) {
+			for (uint32_t c = 0; c < 4; ++c) {
+				uint32_t const s =
+						src[((((y * 2) + 0) * srcSize) + (x * 2) + 0) * 4 + c] +
+						src[((((y * 2) + 0) * srcSize) + (x * 2) + 1) * 4 + c] +
+						src[((((y * 2) + 1) * srcSize) + (x * 2) + 0) * 4 + c] +
+						src[((((y * 2) + 1) * srcSize) + (x * 2) + 1) * 4 + c];
+				dst[((y * dstSize) + x) * 4 + c] = (uint8_t) ((s + 2) / 4);
+			}
+		}
+	}
+}
+
+void BuildCellsTask(uint32_t start, uint32_t end, uint32_t threadnum, void *args) {
+	auto buildArgs = (BuildArgs *) args;
+
+	for (uint32_t cell = start; cell < end; ++cell) {
+		if (buildArgs->cancel.load(std::memory_order_relaxed)) {
+			return;
+		}
+		uint8_t *top = CellDataOf(buildArgs->atlasData, buildArgs->count, cell, 0);
+
+		Image_ImageHeader const *source = buildArgs->sources[cell];
+		buildArgs->sources[cell] = nullptr;
+		Image_ImageHeader const *decodable = source ? DecodableOf(source) : nullptr;
+		if (decodable) {
+			DownsampleIntoCell(decodable, top);
+			Image_Destroy(decodable);
+		}
+
+		for (uint32_t level = 1; level < CELL_MIP_COUNT; ++level) {
+			BuildMipOfCell(CellDataOf(buildArgs->atlasData, buildArgs->count, cell, level - 1),
+										 CellDataOf(buildArgs->atlasData, buildArgs->count, cell, level),
+										 CELL_SIZE >> level);
+		}
+		buildArgs->cellsDone.fetch_add(1, std::memory_order_release);
+	}
+}
+
+// a new atlas from the cells landed so far, the one in flight is retired
+bool UploadAtlas(ContactSheet *ctx) {
+	FramesInFlight_DestroyTexture(ctx->renderer, ctx->atlas);
+	Render_TextureCreateDesc const createGPUDesc{
+			TinyImageFormat_R8G8B8A8_UNORM,
+			Render_TUF_SHADER_READ,
+			CELL_SIZE,
+			CELL_SIZE,
+			1,
+			ctx->build.count,
+			CELL_MIP_COUNT,
+			0,
+			0,
+			ctx->build.atlasData,
+			"Contact Sheet"
+	};
+	ctx->atlas = Render_TextureSyncCreate(ctx->renderer, &createGPUDesc);
+	ctx->lastUploadUs = Os_GetUSec();
+	return Render_TextureHandleIsValid(ctx->atlas);
+}
+
+// cancels and waits for any build then frees what it had
+void EndBuild(ContactSheet *ctx) {
+	if (ctx->buildTask) {
+		ctx->build.cancel.store(true);
+		enkiWaitForTaskSet(ctx->taskScheduler, ctx->buildTask);
+		enkiDeleteTaskSet(ctx->buildTask);
+		ctx->buildTask = nullptr;
+	}
+	if (ctx->build.sources) {
+		for (uint32_t i = 0; i < ctx->build.count; ++i) {
+			if (ctx->build.sources[i]) {
+				Image_Destroy(ctx->build.sources[i]);
+			}
+		}
+		MEMORY_FREE(ctx->build.sources);
+		ctx->build.sources = nullptr;
+	}
+	MEMORY_FREE(ctx->build.atlasData);
+	ctx->build.atlasData = nullptr;
+}
+
+// one draw for every cell, the cell index rides in the vertex colour red and green
+void ImCallback(ImDrawList const *list, ImDrawCmd const *imcmd) {
+	auto ctx = (ContactSheet *) imcmd->UserCallbackData;
+	if (ctx->cellCount == 0 || !Render_TextureHandleIsValid(ctx->atlas)) {
+		return;
+	}
+
+	ImDrawData *drawData = ImGui::GetDrawData();
+	ImVec2 displayPos = drawData->DisplayPos;
+	displayPos.x *= drawData->FramebufferScale.x;
+	displayPos.y *= drawData->FramebufferScale.y;
+
+	Render_GraphicsEncoderBindPipeline(ctx->currentEncoder, ctx->quad.pipeline);
+
+	Render_DescriptorDesc params[2];
+	params[0].name = "atlasTexture";
+	params[0].type = Render_DT_TEXTURE;
+	params[0].texture = ctx->atlas;
+	params[1].name = "uniformBlock";
+	params[1].type = Render_DT_BUFFER;
+	params[1].buffer = ctx->uniformBuffer;
+	params[1].offset = 0;
+	params[1].size = UNIFORM_BUFFER_SIZE_PER_FRAME;
+
+	Render_DescriptorUpdate(ctx->descriptorSet, 0, 2, params);
+	Render_GraphicsEncoderBindDescriptorSet(ctx->currentEncoder, ctx->descriptorSet, 0);
+
+	float const clipX = imcmd->ClipRect.x * drawData->FramebufferScale.x;
+	float const clipY = imcmd->ClipRect.y * drawData->FramebufferScale.y;
+	float const clipZ = imcmd->ClipRect.z * drawData->FramebufferScale.x;
+	float const clipW = imcmd->ClipRect.w * drawData->FramebufferScale.y;
+
+	Render_GraphicsEncoderSetScissor(ctx->currentEncoder,
+																	 {
+																			 (uint32_t) (clipX - displayPos.x),
+																			 (uint32_t) (clipY - displayPos.y),
+																			 (uint32_t) (clipZ - clipX),
+																			 (uint32_t) (clipW - clipY)
+																	 });
+
+	Render_GraphicsEncoderDrawIndexed(ctx->currentEncoder, 6 * ctx->cellCount, imcmd->IdxOffset, imcmd->VtxOffset);
+}
+
+// a rebuild or close can come whilst frames in flight still sample the atlas, so retire it
+void ReleaseCells(ContactSheet *ctx) {
+	EndBuild(ctx);
+	FramesInFlight_DestroyTexture(ctx->renderer, ctx->atlas);
+	ctx->atlas = {};
+	MEMORY_FREE(ctx->names);
+	ctx->names = nullptr;
+	MEMORY_FREE(ctx->cellStates);
+	ctx->cellStates = nullptr;
+	ctx->cellCount = 0;
+}
+
+} // end anon namespace
+
+ContactSheetHandle ContactSheet_Create(Render_RendererHandle renderer,
+																			 Render_FrameBufferHandle frameBuffer,
+																			 enkiTaskSchedulerHandle taskScheduler) {
+
+	auto ctx = (ContactSheet *) MEMORY_CALLOC(1, sizeof(ContactSheet));
+	if (!ctx) {
+		return nullptr;
+	}
+
+	ctx->renderer = renderer;
+	ctx->frameBuffer = frameBuffer;
+	ctx->taskScheduler = taskScheduler;
+
+	Render_SamplerHandle samplers[]{
+			Render_GetStockSampler(renderer, Render_SST_LINEAR),
+	};
+	char const *staticSamplerNames[]{"bilinearSampler"};
+	QuadPipeline_Desc const quadDesc{
+			"contactsheet_vertex.hlsl",
+			"contactsheet_fragment.hlsl",
+			1,
+			samplers,
+			staticSamplerNames
+	};
+	if (!QuadPipeline_Create(renderer, frameBuffer, &quadDesc, &ctx->quad)) {
+		MEMORY_FREE(ctx);
+		return nullptr;
+	}
+
+	Render_DescriptorSetDesc const setDesc = {
+			ctx->quad.rootSignature,
+			Render_DUF_PER_FRAME,
+			1
+	};
+
+	ctx->descriptorSet = Render_DescriptorSetCreate(ctx->renderer, &setDesc);
+	if (!Render_DescriptorSetHandleIsValid(ctx->descriptorSet)) {
+		ContactSheet_Destroy(ctx);
+		return nullptr;
+	}
+
+	static Render_BufferUniformDesc const ubDesc{
+			UNIFORM_BUFFER_SIZE_PER_FRAME,
+			true
+	};
+
+	ctx->uniformBuffer = Render_BufferCreateUniform(ctx->renderer, &ubDesc);
+	if (!Render_BufferHandleIsValid(ctx->uniformBuffer)) {
+		ContactSheet_Destroy(ctx);
+		return nullptr;
+	}
+
+	// defaults
+	ctx->colourChannelEnable[0] = true;
+	ctx->colourChannelEnable[1] = true;
+	ctx->colourChannelEnable[2] = true;
+	ctx->colourChannelEnable[3] = false;
+	ctx->cellDisplaySize = 128.0f;
+
+	return ctx;
+}
+
+void ContactSheet_Destroy(ContactSheetHandle handle) {
+	auto ctx = (ContactSheet *) handle;
+	if (!ctx) {
+		return;
+	}
+
+	ReleaseCells(ctx);
+
+	Render_BufferDestroy(ctx->renderer, ctx->uniformBuffer);
+	Render_DescriptorSetDestroy(ctx->renderer, ctx->descriptorSet);
+	QuadPipeline_Destroy(ctx->renderer, &ctx->quad);
+
+	MEMORY_FREE(ctx);
+}
+
+bool ContactSheet_Build(ContactSheetHandle handle,
+												uint32_t count,
+												Image_ImageHeader const *const *images,
+												char const *const *names) {
+	auto ctx = (ContactSheet *) handle;
+	if (!ctx) {
+		return false;
+	}
+
+	ReleaseCells(ctx);
+
+	if (count > MAX_CONTACT_SHEET_CELLS) {
+		LOGINFO("Contact sheet only shows the first %u of %u textures", MAX_CONTACT_SHEET_CELLS, count);
+		count = MAX_CONTACT_SHEET_CELLS;
+	}
+	if (count == 0) {
+		return true;
+	}
+
+	uint64_t atlasSize = 0;
+	for (uint32_t level = 0; level < CELL_MIP_COUNT; ++level) {
+		atlasSize += CellByteCountOf(level) * count;
+	}
+
+	// cells not landed yet show black
+	ctx->build.atlasData = (uint8_t *) MEMORY_CALLOC(1, atlasSize);
+	ctx->build.sources = (Image_ImageHeader const **) MEMORY_CALLOC(count, sizeof(Image_ImageHeader const *));
+	ctx->build.count = count;
+	ctx->build.atlasSize = atlasSize;
+	ctx->build.cellsDone.store(0);
+	ctx->build.cancel.store(false);
+	ctx->names = (char (*)[CELL_NAME_LENGTH]) MEMORY_CALLOC(count, CELL_NAME_LENGTH);
+	ctx->cellStates = (CellState *) MEMORY_CALLOC(count, sizeof(CellState));
+	ctx->buildTask = enkiCreateTaskSet(ctx->taskScheduler, &BuildCellsTask);
+	if (!ctx->build.atlasData || !ctx->build.sources || !ctx->names || !ctx->cellStates || !ctx->buildTask) {
+		ReleaseCells(ctx);
+		return false;
+	}
+
+	// only the level each cell starts from is copied, the workers do the rest
+	for (uint32_t i = 0; i < count; ++i) {
+		ctx->build.sources[i] = images[i] ? CellSourceOf(images[i]) : nullptr;
+	}
+	ctx->uploadedCells = 0;
+	ctx->lastUploadUs = Os_GetUSec();
+	enkiAddTaskSetToPipe(ctx->taskScheduler, ctx->buildTask, &ctx->build, count);
+
+	for (uint32_t i = 0; i < count; ++i) {
+		strncpy(ctx->names[i], names[i] ? names[i] : "", CELL_NAME_LENGTH - 1);
+		memcpy(ctx->cellStates[i].colourChannelEnable, ctx->colourChannelEnable, sizeof(bool) * 4);
+		ctx->cellStates[i].mipLevel = ctx->mipLevel;
+	}
+	ctx->cellCount = count;
+
+	return true;
+}
+
+void ContactSheet_MemoryUsage(ContactSheetHandle handle, uint64_t *cpuBytes, uint64_t *gpuBytes) {
+	auto ctx = (ContactSheet *) handle;
+	*cpuBytes = 0;
+	*gpuBytes = 0;
+	if (!ctx) {
+		return;
+	}
+
+	*cpuBytes = sizeof(ContactSheet) + (ctx->cellCount * (CELL_NAME_LENGTH + sizeof(CellState)));
+	if (ctx->build.atlasData) {
+		*cpuBytes += ctx->build.atlasSize;
+	}
+	*gpuBytes = UNIFORM_BUFFER_SIZE_PER_FRAME * FRAMES_IN_FLIGHT;
+	if (Render_TextureHandleIsValid(ctx->atlas)) {
+		for (uint32_t level = 0; level < CELL_MIP_COUNT; ++level) {
+			*gpuBytes += CellByteCountOf(level) * ctx->cellCount;
+		}
+	}
+}
+
+bool ContactSheet_Update(ContactSheetHandle handle) {
+	auto ctx = (ContactSheet *) handle;
+	if (!ctx || !ctx->buildTask) {
+		return false;
+	}
+
+	bool const complete = enkiIsTaskSetComplete(ctx->taskScheduler, ctx->buildTask);
+	uint32_t const cellsDone = ctx->build.cellsDone.load(std::memory_order_acquire);
+	int64_t const period = ATLAS_UPLOAD_PERIOD_US + ATLAS_UPLOAD_US_PER_MB * (int64_t) (ctx->build.atlasSize >> 20);
+	bool const due = Os_GetUSec() - ctx->lastUploadUs >= period;
+	if (!complete && (cellsDone == ctx->uploadedCells || !due)) {
+		return false;
+	}
+
+	// a cell still being written may upload half done, the next upload fixes it
+	bool uploaded = false;
+	if (cellsDone != ctx->uploadedCells) {
+		uploaded = UploadAtlas(ctx);
+		ctx->uploadedCells = cellsDone;
+		if (!uploaded) {
+			LOGWARNING("Contact sheet atlas upload failed");
+		}
+	}
+	if (complete) {
+		EndBuild(ctx);
+	}
+	return uploaded;
+}
+
+bool ContactSheet_DrawUI(ContactSheetHandle handle) {
+	auto ctx = (ContactSheet *) handle;
+	if (!ctx) {
+		return false;
+	}
+
+	bool open = true;
+	ImGui::SetNextWindowSize(ImVec2(900, 700), ImGuiCond_FirstUseEver);
+	ImGui::Begin("Contact Sheet", &open, 0);
+	if (open == false) {
+		ImGui::End();
+		return false;
+	}
+
+	// global controls apply to every cell, right click a cell to change just that one
+	bool changed = false;
+	changed |= ImGui::Checkbox("R", ctx->colourChannelEnable + 0);
+	ImGui::SameLine();
+	changed |= ImGui::Checkbox("G", ctx->colourChannelEnable + 1);
+	ImGui::SameLine();
+	changed |= ImGui::Checkbox("B", ctx->colourChannelEnable + 2);
+	ImGui::SameLine();
+	changed |= ImGui::Checkbox("A", ctx->colourChannelEnable + 3);
+	ImGui::SameLine();
+	ImGui::PushItemWidth(100.0f);
+	changed |= ImGui::SliderInt("Mip", &ctx->mipLevel, 0, CELL_MIP_COUNT - 1);
+	ImGui::SameLine();
+	ImGui::SliderFloat("Cell size", &ctx->cellDisplaySize, 32.0f, 512.0f, "%.0f");
+	ImGui::PopItemWidth();
+	if (changed) {
+		for (uint32_t i = 0; i < ctx->cellCount; ++i) {
+			memcpy(ctx->cellStates[i].colourChannelEnable, ctx->colourChannelEnable, sizeof(bool) * 4);
+			ctx->cellStates[i].mipLevel = ctx->mipLevel;
+		}
+	}
+
+	ImGui::BeginChild("cells", ImVec2(0, 0), false, 0);
+	ImGuiWindow *window = ImGui::GetCurrentWindow();
+	if (window->SkipItems || ctx->cellCount == 0) {
+		ImGui::EndChild();
+		ImGui::End();
+		return true;
+	}
+
+	ImDrawList *drawList = ImGui::GetWindowDrawList();
+	float const spacing = ImGui::GetStyle().ItemSpacing.x;
+	float const labelHeight = ImGui::GetTextLineHeightWithSpacing();
+	float const cellSize = ctx->cellDisplaySize;
+	float const pitchX = cellSize + spacing;
+	float const pitchY = cellSize + labelHeight + spacing;
+	uint32_t columns = (uint32_t) ((ImGui::GetContentRegionAvail().x + spacing) / pitchX);
+	columns = columns ? columns : 1;
+	uint32_t const rows = (ctx->cellCount + columns - 1) / columns;
+	ImVec2 const origin = window->DC.CursorPos;
+
+	// every cell quad in one batch followed by a single callback that draws them all
+	drawList->PushTextureID(ctx);
+	drawList->PrimReserve(6 * ctx->cellCount, 4 * ctx->cellCount);
+	for (uint32_t i = 0; i < ctx->cellCount; ++i) {
+		ImVec2 const min{origin.x + (float) (i % columns) * pitchX, origin.y + (float) (i / columns) * pitchY};
+		ImVec2 const max{min.x + cellSize, min.y + cellSize};
+		drawList->PrimRectUV(min, max, {0, 0}, {1, 1}, IM_COL32(i & 0xFF, (i >> 8) & 0xFF, 0, 0xFF));
+	}
+	drawList->CmdBuffer.back().ElemCount = 0; // stop the rects rendering instead do a callback
+	drawList->AddCallback(&ImCallback, handle);
+	drawList->PopTextureID();
+
+	for (uint32_t i = 0; i < ctx->cellCount; ++i) {
+		ImVec2 const min{origin.x + (float) (i % columns) * pitchX, origin.y + (float) (i / columns) * pitchY};
+		ImGui::SetCursorScreenPos(min);
+		ImGui::PushID((int) i);
+		ImGui::InvisibleButton("cell", ImVec2(cellSize, cellSize));
+		if (ImGui::BeginPopupContextItem("cell settings")) {
+			CellState *cellState = ctx->cellStates + i;
+			ImGui::Text("%s", ctx->names[i]);
+			ImGui::Checkbox("R", cellState->colourChannelEnable + 0);
+			ImGui::SameLine();
+			ImGui::Checkbox("G", cellState->colourChannelEnable + 1);
+			ImGui::SameLine();
+			ImGui::Checkbox("B", cellState->colourChannelEnable + 2);
+			ImGui::SameLine();
+			ImGui::Checkbox("A", cellState->colourChannelEnable + 3);
+			ImGui::SliderInt("Mip", &cellState->mipLevel, 0, CELL_MIP_COUNT - 1);
+			ImGui::EndPopup();
+		}
+		ImGui::PopID();
+		drawList->PushClipRect(min, ImVec2(min.x + cellSize, min.y + cellSize + labelHeight), true);
+		drawList->AddText(ImVec2(min.x, min.y + cellSize), 0xFFFFFFFF, ctx->names[i]);
+		drawList->PopClipRect();
+	}
+
+	ImGui::SetCursorScreenPos(origin);
+	ImGui::Dummy(ImVec2((float) columns * pitchX, (float) rows * pitchY));
+
+	ImGui::EndChild();
+	ImGui::End();
+	return true;
+}
+
+void ContactSheet_RenderSetup(ContactSheetHandle handle, Render_GraphicsEncoderHandle encoder) {
+	auto ctx = (ContactSheet *) handle;
+	if (!ctx) {
+		return;
+	}
+
+	memcpy(ctx->uniforms.scaleOffsetMatrix,
+				 Render_FrameBufferImguiScaleOffsetMatrix(ctx->frameBuffer),
+				 sizeof(float) * 16);
+
+	for (uint32_t i = 0; i < ctx->cellCount; ++i) {
+		CellState const *cellState = ctx->cellStates + i;
+		CellUniforms *cell = ctx->uniforms.cells + i;
+		for (uint32_t c = 0; c < 4; ++c) {
+			cell->colourMask[c] = cellState->colourChannelEnable[c] ? 1.0f : 0.0f;
+		}
+		cell->mipLevel = cellState->mipLevel;
+		cell->alphaReplicate = ((!cellState->colourChannelEnable[0]) &&
+				(!cellState->colourChannelEnable[1]) &&
+				(!cellState->colourChannelEnable[2]) &&
+				cellState->colourChannelEnable[3]) ? 1.0f : 0.0f;
+	}
+
+	ctx->currentEncoder = encoder;
+
+	if (memcmp(&ctx->uploadedUniforms, &ctx->uniforms, sizeof(SheetUniforms)) != 0) {
+		memcpy(&ctx->uploadedUniforms, &ctx->uniforms, sizeof(SheetUniforms));
+		ctx->dirtyFrames = UNIFORM_UPLOADS_PER_CHANGE;
+	}
+	if (ctx->dirtyFrames == 0) {
+		return;
+	}
+	ctx->dirtyFrames--;
+
+	Render_BufferUpdateDesc uniformUpdate = {
+			&ctx->uniforms,
+			0,
+			sizeof(SheetUniforms)
+	};
+	Render_BufferUpload(ctx->uniformBuffer, &uniformUpdate);
+}
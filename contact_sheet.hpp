@@ -0,0 +1,33 @@
+#pragma once
+#ifndef DEVON_CONTACT_SHEET_HPP
+#define DEVON_CONTACT_SHEET_HPP
+
+#include "render_basics/api.h"
+#include "al2o3_enki/TaskScheduler_c.h"
+
+typedef struct ContactSheet *ContactSheetHandle;
+struct Image_ImageHeader;
+
+ContactSheetHandle ContactSheet_Create(Render_RendererHandle renderer,
+																			 Render_FrameBufferHandle frameBuffer,
+																			 enkiTaskSchedulerHandle taskScheduler);
+void ContactSheet_Destroy(ContactSheetHandle handle);
+
+// downsamples each image into a cell of the shared atlas on the workers, cells show as they
+// land via ContactSheet_Update. Images are only read during the call
+bool ContactSheet_Build(ContactSheetHandle handle,
+												uint32_t count,
+												Image_ImageHeader const *const *images,
+												char const *const *names);
+
+// uploads the cells landed so far whilst a build is running, true when the atlas changed
+bool ContactSheet_Update(ContactSheetHandle handle);
+
+void ContactSheet_MemoryUsage(ContactSheetHandle handle, uint64_t *cpuBytes, uint64_t *gpuBytes);
+
+// false when the window has been closed
+bool ContactSheet_DrawUI(ContactSheetHandle handle);
+// must be called before Imguibinding render. Sets up things for the callbacks from imgui
+void ContactSheet_RenderSetup(ContactSheetHandle handle, Render_GraphicsEncoderHandle encoder);
+
+#endif //DEVON_CONTACT_SHEET_HPP
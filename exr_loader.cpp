@@ -0,0 +1,818 @@
+#include "al2o3_platform/platform.h"
+#include "al2o3_memory/memory.h"
+#include "al2o3_vfile/vfile.h"
+#include "gfx_image/image.h"
+#include "gfx_imgui/imgui.h"
+#include <atomic>
+#include <cstdio>
+
+#include "exr_loader.hpp"
+#include "inflate.hpp"
+#include "piz.hpp"
+
+static const uint32_t EXR_MAGIC = 20000630;
+static const uint32_t EXR_TILED_FLAG = 0x200;
+static const uint32_t EXR_LONG_NAMES_FLAG = 0x400;
+static const uint32_t EXR_DEEP_FLAG = 0x800;
+static const uint32_t EXR_MULTIPART_FLAG = 0x1000;
+static const uint32_t EXR_MAX_CHANNELS = 256;
+static const uint32_t EXR_MAX_NAME_LENGTH = 256;
+
+namespace {
+
+enum ExrCompression {
+	EC_NONE = 0,
+	EC_RLE = 1,
+	EC_ZIPS = 2,
+	EC_ZIP = 3,
+	EC_PIZ = 4,
+};
+
+enum ExrPixelType {
+	EPT_UINT = 0,
+	EPT_HALF = 1,
+	EPT_FLOAT = 2,
+};
+
+struct ExrChannel {
+	char name[EXR_MAX_NAME_LENGTH];
+	uint32_t pixelType;
+	uint32_t sampleBytes;
+	uint32_t offset; // bytes of the channels before this one in a pixel
+};
+
+struct Reader {
+	uint8_t const *p;
+	uint8_t const *end;
+};
+
+bool ReadBytes(Reader *r, void *out, size_t size) {
+	if ((size_t) (r->end - r->p) < size) {
+		return false;
+	}
+	memcpy(out, r->p, size);
+	r->p += size;
+	return true;
+}
+
+bool ReadString(Reader *r, char *out, size_t maxSize) {
+	for (size_t i = 0; i < maxSize; ++i) {
+		if (r->p >= r->end) {
+			return false;
+		}
+		out[i] = (char) *r->p++;
+		if (out[i] == 0) {
+			return true;
+		}
+	}
+	return false;
+}
+
+} // end anon namespace
+
+struct ExrLoader {
+	enkiTaskSchedulerHandle taskScheduler;
+	Memory_Allocator *allocator; // everything below comes from it
+
+	uint8_t *fileData;
+	size_t fileSize;
+
+	ExrChannel *channels;
+	uint32_t channelCount;
+	uint32_t pixelBytes;
+	uint8_t channelShorts[EXR_MAX_CHANNELS]; // 16 bit values per sample, how PIZ sees them
+
+	uint32_t compression;
+	int32_t xMin;
+	int32_t yMin;
+	uint32_t width;
+	uint32_t height;
+
+	bool tiled;
+	uint32_t tileWidth;
+	uint32_t tileHeight;
+	uint32_t tilesX;
+	uint32_t linesPerBlock;
+
+	uint32_t chunkCount;
+	uint64_t *offsets;
+
+	int32_t selection[4];
+	int32_t defaultSelection[4]; // what Open picked
+
+	// per decode
+	Image_ImageHeader *image;
+	bool halfOutput;
+	enkiTaskSetHandle task;
+	bool running;
+	std::atomic<uint32_t> chunksDone;
+	std::atomic<bool> cancel;
+	std::atomic<bool> reportedError;
+
+	// per worker thread, PIZ tables (if PIZ) then two buffers of scratchSize
+	uint32_t threadCount;
+	size_t scratchSize;
+	size_t pizScratchSize;
+	size_t threadScratchSize;
+	uint8_t *scratch;
+};
+
+namespace {
+
+float HalfToFloat(uint16_t h) {
+	uint32_t const sign = (uint32_t) (h & 0x8000) << 16;
+	uint32_t exponent = (h >> 10) & 0x1F;
+	uint32_t mantissa = h & 0x3FF;
+
+	uint32_t bits;
+	if (exponent == 0) {
+		if (mantissa == 0) {
+			bits = sign;
+		} else {
+			// denormal, renormalise
+			exponent = 127 - 14;
+			while (!(mantissa & 0x400)) {
+				mantissa <<= 1;
+				exponent--;
+			}
+			bits = sign | (exponent << 23) | ((mantissa & 0x3FF) << 13);
+		}
+	} else if (exponent == 31) {
+		bits = sign | 0x7F800000 | (mantissa << 13);
+	} else {
+		bits = sign | ((exponent + (127 - 15)) << 23) | (mantissa << 13);
+	}
+
+	float f;
+	memcpy(&f, &bits, sizeof(float));
+	return f;
+}
+
+bool ParseChannels(ExrLoader *loader, Reader r) {
+	uint32_t offset = 0;
+	for (;;) {
+		char name[EXR_MAX_NAME_LENGTH];
+		if (!ReadString(&r, name, EXR_MAX_NAME_LENGTH)) {
+			return false;
+		}
+		if (name[0] == 0) {
+			break;
+		}
+
+		int32_t pixelType;
+		uint8_t pLinearAndReserved[4];
+		int32_t xSampling, ySampling;
+		if (!ReadBytes(&r, &pixelType, 4) ||
+				!ReadBytes(&r, pLinearAndReserved, 4) ||
+				!ReadBytes(&r, &xSampling, 4) ||
+				!ReadBytes(&r, &ySampling, 4)) {
+			return false;
+		}
+		if (pixelType < EPT_UINT || pixelType > EPT_FLOAT) {
+			return false;
+		}
+		if (xSampling != 1 || ySampling != 1) {
+			LOGINFO("EXR channel %s is subsampled which isn't supported", name);
+			return false;
+		}
+		if (loader->channelCount >= EXR_MAX_CHANNELS) {
+			return false;
+		}
+
+		ExrChannel *channel = loader->channels + loader->channelCount++;
+		memcpy(channel->name, name, EXR_MAX_NAME_LENGTH);
+		channel->pixelType = (uint32_t) pixelType;
+		channel->sampleBytes = pixelType == EPT_HALF ? 2 : 4;
+		channel->offset = offset;
+		loader->channelShorts[loader->channelCount - 1] = (uint8_t) (channel->sampleBytes / 2);
+		offset += channel->sampleBytes;
+	}
+	loader->pixelBytes = offset;
+	return loader->channelCount > 0;
+}
+
+bool ParseHeader(ExrLoader *loader) {
+	Reader r{loader->fileData, loader->fileData + loader->fileSize};
+
+	uint32_t magic, version;
+	if (!ReadBytes(&r, &magic, 4) || !ReadBytes(&r, &version, 4) || magic != EXR_MAGIC) {
+		return false;
+	}
+	if ((version & 0xFF) != 2 || (version & (EXR_DEEP_FLAG | EXR_MULTIPART_FLAG))) {
+		LOGINFO("EXR version %x (deep or multipart) isn't supported", version);
+		return false;
+	}
+	loader->tiled = (version & EXR_TILED_FLAG) != 0;
+	size_t const maxNameSize = (version & EXR_LONG_NAMES_FLAG) ? EXR_MAX_NAME_LENGTH : 32;
+
+	bool haveChannels = false;
+	bool haveDataWindow = false;
+	bool haveTiles = false;
+	loader->compression = ~0u;
+	for (;;) {
+		char name[EXR_MAX_NAME_LENGTH];
+		char type[EXR_MAX_NAME_LENGTH];
+		int32_t size;
+		if (!ReadString(&r, name, maxNameSize)) {
+			return false;
+		}
+		if (name[0] == 0) {
+			break;
+		}
+		if (!ReadString(&r, type, maxNameSize) || !ReadBytes(&r, &size, 4) || size < 0 || (r.end - r.p) < size) {
+			return false;
+		}
+		Reader attr{r.p, r.p + size};
+		r.p += size;
+
+		if (strcmp(name, "channels") == 0 && strcmp(type, "chlist") == 0) {
+			haveChannels = ParseChannels(loader, attr);
+		} else if (strcmp(name, "compression") == 0) {
+			uint8_t compression;
+			if (!ReadBytes(&attr, &compression, 1)) {
+				return false;
+			}
+			loader->compression = compression;
+		} else if (strcmp(name, "dataWindow") == 0) {
+			int32_t box[4];
+			if (!ReadBytes(&attr, box, sizeof(box)) || box[2] < box[0] || box[3] < box[1]) {
+				return false;
+			}
+			loader->xMin = box[0];
+			loader->yMin = box[1];
+			loader->width = (uint32_t) (box[2] - box[0] + 1);
+			loader->height = (uint32_t) (box[3] - box[1] + 1);
+			haveDataWindow = true;
+		} else if (strcmp(name, "tiles") == 0) {
+			uint8_t mode;
+			if (!ReadBytes(&attr, &loader->tileWidth, 4) || !ReadBytes(&attr, &loader->tileHeight, 4) ||
+					!ReadBytes(&attr, &mode, 1)) {
+				return false;
+			}
+			if ((mode & 0xF) != 0) {
+				LOGINFO("EXR mip/rip mapped tiles aren't supported");
+				return false;
+			}
+			haveTiles = loader->tileWidth > 0 && loader->tileHeight > 0;
+		}
+	}
+
+	if (!haveChannels || !haveDataWindow || (loader->tiled && !haveTiles)) {
+		return false;
+	}
+	switch (loader->compression) {
+		case EC_NONE:
+		case EC_RLE:
+		case EC_ZIPS: loader->linesPerBlock = 1;
+			break;
+		case EC_ZIP: loader->linesPerBlock = 16;
+			break;
+		case EC_PIZ: loader->linesPerBlock = 32;
+			break;
+		default: LOGINFO("EXR compression %u isn't supported by the chunked loader", loader->compression);
+			return false;
+	}
+
+	if (loader->tiled) {
+		loader->tilesX = (loader->width + loader->tileWidth - 1) / loader->tileWidth;
+		uint32_t const tilesY = (loader->height + loader->tileHeight - 1) / loader->tileHeight;
+		loader->chunkCount = loader->tilesX * tilesY;
+	} else {
+		loader->chunkCount = (loader->height + loader->linesPerBlock - 1) / loader->linesPerBlock;
+	}
+
+	loader->offsets = (uint64_t *) MEMORY_ALLOCATOR_MALLOC(loader->allocator, sizeof(uint64_t) * loader->chunkCount);
+	if (!loader->offsets || !ReadBytes(&r, loader->offsets, sizeof(uint64_t) * loader->chunkCount)) {
+		return false;
+	}
+	for (uint32_t i = 0; i < loader->chunkCount; ++i) {
+		if (loader->offsets[i] >= loader->fileSize) {
+			LOGINFO("EXR offset table is damaged");
+			return false;
+		}
+	}
+	return true;
+}
+
+int32_t FindChannel(ExrLoader const *loader, char const *prefix, size_t prefixLen, char const *suffix) {
+	for (uint32_t i = 0; i < loader->channelCount; ++i) {
+		char const *name = loader->channels[i].name;
+		if (strncmp(name, prefix, prefixLen) == 0 && strcmp(name + prefixLen, suffix) == 0) {
+			return (int32_t) i;
+		}
+	}
+	return EXR_LOADER_NO_CHANNEL;
+}
+
+// layers are everything up to the last '.', including it
+size_t LayerPrefixLength(char const *name) {
+	char const *dot = strrchr(name, '.');
+	return dot ? (size_t) (dot - name) + 1 : 0;
+}
+
+void SelectLayer(ExrLoader *loader, char const *prefix, size_t prefixLen) {
+	static char const *const Suffixes[4] = {"R", "G", "B", "A"};
+	for (uint32_t i = 0; i < 4; ++i) {
+		loader->selection[i] = FindChannel(loader, prefix, prefixLen, Suffixes[i]);
+	}
+
+	// no colour in the layer (depth, ids etc.) so show its first channel as grey
+	if (loader->selection[0] == EXR_LOADER_NO_CHANNEL &&
+			loader->selection[1] == EXR_LOADER_NO_CHANNEL &&
+			loader->selection[2] == EXR_LOADER_NO_CHANNEL) {
+		for (uint32_t i = 0; i < loader->channelCount; ++i) {
+			if (strncmp(loader->channels[i].name, prefix, prefixLen) == 0 &&
+					LayerPrefixLength(loader->channels[i].name) == prefixLen) {
+				loader->selection[0] = loader->selection[1] = loader->selection[2] = (int32_t) i;
+				break;
+			}
+		}
+	}
+}
+
+// EXR RLE: negative count is a literal run, otherwise repeat the next byte count + 1 times
+bool RleDecode(uint8_t const *src, size_t srcSize, uint8_t *dst, size_t dstSize) {
+	size_t in = 0;
+	size_t out = 0;
+	while (in < srcSize) {
+		int32_t const count = (int8_t) src[in++];
+		if (count < 0) {
+			size_t const run = (size_t) -count;
+			if (in + run > srcSize || out + run > dstSize) {
+				return false;
+			}
+			memcpy(dst + out, src + in, run);
+			in += run;
+			out += run;
+		} else {
+			size_t const run = (size_t) count + 1;
+			if (in >= srcSize || out + run > dstSize) {
+				return false;
+			}
+			memset(dst + out, src[in++], run);
+			out += run;
+		}
+	}
+	return out == dstSize;
+}
+
+// undoes the byte delta predictor then re-interleaves the two halves the encoder split
+void Unpredict(uint8_t *tmp, size_t size, uint8_t *out) {
+	for (size_t i = 1; i < size; ++i) {
+		tmp[i] = (uint8_t) (tmp[i - 1] + tmp[i] - 128);
+	}
+
+	uint8_t const *t1 = tmp;
+	uint8_t const *t2 = tmp + (size + 1) / 2;
+	size_t const pairs = size / 2;
+	for (size_t i = 0; i < pairs; ++i) {
+		out[i * 2 + 0] = t1[i];
+		out[i * 2 + 1] = t2[i];
+	}
+	if (size & 1) {
+		out[size - 1] = t1[pairs];
+	}
+}
+
+void ScatterBlock(ExrLoader const *loader, uint8_t const *raw, uint32_t x0, uint32_t y0, uint32_t w, uint32_t h) {
+	uint8_t *dstBase = (uint8_t *) Image_RawDataPtr(loader->image);
+	size_t const dstPixelBytes = loader->halfOutput ? 8 : 16;
+	size_t const dstRowBytes = dstPixelBytes * loader->width;
+
+	for (uint32_t y = 0; y < h; ++y) {
+		uint8_t const *line = raw + ((size_t) y * w * loader->pixelBytes);
+		uint8_t *dstRow = dstBase + ((size_t) (y0 + y) * dstRowBytes) + ((size_t) x0 * dstPixelBytes);
+
+		for (uint32_t k = 0; k < 4; ++k) {
+			int32_t const c = loader->selection[k];
+			if (c == EXR_LOADER_NO_CHANNEL) {
+				continue;
+			}
+			ExrChannel const *channel = loader->channels + c;
+			uint8_t const *src = line + ((size_t) w * channel->offset);
+
+			if (loader->halfOutput) {
+				// every selected channel is half so this is a straight copy
+				auto dst = (uint16_t *) dstRow + k;
+				for (uint32_t x = 0; x < w; ++x) {
+					memcpy(dst + (x * 4), src + (x * 2), 2);
+				}
+				continue;
+			}
+
+			auto dst = (float *) dstRow + k;
+			for (uint32_t x = 0; x < w; ++x) {
+				switch (channel->pixelType) {
+					case EPT_HALF: {
+						uint16_t v;
+						memcpy(&v, src + (x * 2), 2);
+						dst[x * 4] = HalfToFloat(v);
+						break;
+					}
+					case EPT_FLOAT: memcpy(dst + (x * 4), src + (x * 4), 4);
+						break;
+					default: {
+						uint32_t v;
+						memcpy(&v, src + (x * 4), 4);
+						dst[x * 4] = (float) v;
+						break;
+					}
+				}
+			}
+		}
+	}
+}
+
+bool DecodeChunk(ExrLoader const *loader, uint32_t chunk, void *pizScratch, uint8_t *scratch0, uint8_t *scratch1) {
+	Reader r{loader->fileData + loader->offsets[chunk], loader->fileData + loader->fileSize};
+
+	uint32_t x0, y0, w, h;
+	if (loader->tiled) {
+		int32_t tileCoords[4];
+		if (!ReadBytes(&r, tileCoords, sizeof(tileCoords)) || tileCoords[0] < 0 || tileCoords[1] < 0) {
+			return false;
+		}
+		x0 = (uint32_t) tileCoords[0] * loader->tileWidth;
+		y0 = (uint32_t) tileCoords[1] * loader->tileHeight;
+		if (x0 >= loader->width || y0 >= loader->height) {
+			return false;
+		}
+		w = loader->width - x0 < loader->tileWidth ? loader->width - x0 : loader->tileWidth;
+		h = loader->height - y0 < loader->tileHeight ? loader->height - y0 : loader->tileHeight;
+	} else {
+		int32_t y;
+		if (!ReadBytes(&r, &y, 4) || y < loader->yMin || (uint32_t) (y - loader->yMin) >= loader->height) {
+			return false;
+		}
+		x0 = 0;
+		y0 = (uint32_t) (y - loader->yMin);
+		w = loader->width;
+		h = loader->height - y0 < loader->linesPerBlock ? loader->height - y0 : loader->linesPerBlock;
+	}
+
+	int32_t dataSize;
+	if (!ReadBytes(&r, &dataSize, 4) || dataSize < 0 || (r.end - r.p) < dataSize) {
+		return false;
+	}
+
+	size_t const rawSize = (size_t) w * h * loader->pixelBytes;
+	uint8_t const *raw = r.p;
+	// chunks that don't get smaller are stored as is whatever the compression
+	if (loader->compression != EC_NONE && (size_t) dataSize < rawSize) {
+		if (loader->compression == EC_PIZ) {
+			// PIZ has no predictor, it comes out in the final layout
+			if (!Piz_Decode(r.p, (size_t) dataSize, w, h, loader->channelShorts, loader->channelCount,
+											pizScratch, (uint16_t *) scratch0, scratch1, rawSize)) {
+				return false;
+			}
+			ScatterBlock(loader, scratch1, x0, y0, w, h);
+			return true;
+		}
+		if (loader->compression == EC_RLE) {
+			if (!RleDecode(r.p, (size_t) dataSize, scratch0, rawSize)) {
+				return false;
+			}
+		} else {
+			size_t outSize = 0;
+			if (!Inflate_Zlib(r.p, (size_t) dataSize, scratch0, rawSize, &outSize) || outSize != rawSize) {
+				return false;
+			}
+		}
+		Unpredict(scratch0, rawSize, scratch1);
+		raw = scratch1;
+	} else if ((size_t) dataSize < rawSize) {
+		return false;
+	}
+
+	ScatterBlock(loader, raw, x0, y0, w, h);
+	return true;
+}
+
+void DecodeChunksTask(uint32_t start, uint32_t end, uint32_t threadnum, void *args) {
+	auto loader = (ExrLoader *) args;
+	ASSERT(threadnum < loader->threadCount);
+	uint8_t *pizScratch = loader->scratch + (loader->threadScratchSize * threadnum);
+	uint8_t *scratch0 = pizScratch + loader->pizScratchSize;
+	uint8_t *scratch1 = scratch0 + loader->scratchSize;
+
+	for (uint32_t chunk = start; chunk < end; ++chunk) {
+		if (loader->cancel.load(std::memory_order_relaxed)) {
+			return;
+		}
+		// a damaged chunk leaves a hole rather than failing the whole image
+		if (!DecodeChunk(loader, chunk, pizScratch, scratch0, scratch1) && !loader->reportedError.exchange(true)) {
+			LOGINFO("EXR chunk %u is damaged", chunk);
+		}
+		loader->chunksDone.fetch_add(1, std::memory_order_release);
+	}
+}
+
+} // end anon namespace
+
+bool ExrLoader_IsExr(char const *fileName) {
+	VFile_Handle fh = VFile_FromFile(fileName, Os_FM_ReadBinary);
+	if (!fh) {
+		return false;
+	}
+	uint32_t magic = 0;
+	bool const isExr = VFile_Read(fh, &magic, sizeof(uint32_t)) == sizeof(uint32_t) && magic == EXR_MAGIC;
+	VFile_Close(fh);
+	return isExr;
+}
+
+ExrLoaderHandle ExrLoader_Open(char const *fileName,
+															 enkiTaskSchedulerHandle taskScheduler,
+															 Memory_Allocator *allocator) {
+	VFile_Handle fh = VFile_FromFile(fileName, Os_FM_ReadBinary);
+	if (!fh) {
+		return nullptr;
+	}
+
+	// cheap rejection of everything else before reading the whole file
+	uint32_t magic = 0;
+	size_t const fileSize = (size_t) VFile_Size(fh);
+	if (fileSize < sizeof(uint32_t) || VFile_Read(fh, &magic, sizeof(uint32_t)) != sizeof(uint32_t) ||
+			magic != EXR_MAGIC) {
+		VFile_Close(fh);
+		return nullptr;
+	}
+
+	auto loader = (ExrLoader *) MEMORY_ALLOCATOR_CALLOC(allocator, 1, sizeof(ExrLoader));
+	if (!loader) {
+		VFile_Close(fh);
+		return nullptr;
+	}
+	loader->taskScheduler = taskScheduler;
+	loader->allocator = allocator;
+	loader->fileSize = fileSize;
+	loader->fileData = (uint8_t *) MEMORY_ALLOCATOR_MALLOC(allocator, loader->fileSize);
+	loader->channels = (ExrChannel *) MEMORY_ALLOCATOR_CALLOC(allocator, EXR_MAX_CHANNELS, sizeof(ExrChannel));
+	if (loader->fileData) {
+		memcpy(loader->fileData, &magic, sizeof(uint32_t));
+	}
+	if (!loader->fileData || !loader->channels ||
+			VFile_Read(fh, loader->fileData + sizeof(uint32_t), fileSize - sizeof(uint32_t)) !=
+					fileSize - sizeof(uint32_t)) {
+		VFile_Close(fh);
+		ExrLoader_Destroy(loader);
+		return nullptr;
+	}
+	VFile_Close(fh);
+
+	if (!ParseHeader(loader)) {
+		ExrLoader_Destroy(loader);
+		return nullptr;
+	}
+
+	// unprefixed RGBA first, then the first layer with a red channel, then whatever comes first as grey
+	char const *layer = loader->channels[0].name;
+	size_t layerLen = LayerPrefixLength(layer);
+	if (FindChannel(loader, "", 0, "R") != EXR_LOADER_NO_CHANNEL) {
+		layerLen = 0;
+	} else {
+		for (uint32_t i = 0; i < loader->channelCount; ++i) {
+			char const *name = loader->channels[i].name;
+			size_t const prefixLen = LayerPrefixLength(name);
+			if (prefixLen && strcmp(name + prefixLen, "R") == 0) {
+				layer = name;
+				layerLen = prefixLen;
+				break;
+			}
+		}
+	}
+	SelectLayer(loader, layer, layerLen);
+	memcpy(loader->defaultSelection, loader->selection, sizeof(int32_t) * 4);
+
+	uint32_t const blockWidth = loader->tiled ? loader->tileWidth : loader->width;
+	uint32_t const blockHeight = loader->tiled ? loader->tileHeight : loader->linesPerBlock;
+	loader->scratchSize = (size_t) blockWidth * blockHeight * loader->pixelBytes;
+	loader->pizScratchSize = loader->compression == EC_PIZ ? (Piz_ScratchSize() + 15) & ~(size_t) 15 : 0;
+	loader->threadScratchSize = (loader->pizScratchSize + (loader->scratchSize * 2) + 15) & ~(size_t) 15;
+	loader->threadCount = enkiGetNumTaskThreads(taskScheduler);
+	loader->scratch = (uint8_t *) MEMORY_ALLOCATOR_MALLOC(allocator, loader->threadScratchSize * loader->threadCount);
+	if (!loader->scratch) {
+		ExrLoader_Destroy(loader);
+		return nullptr;
+	}
+
+	return loader;
+}
+
+void ExrLoader_Destroy(ExrLoaderHandle handle) {
+	auto loader = (ExrLoader *) handle;
+	if (!loader) {
+		return;
+	}
+
+	ExrLoader_Cancel(loader);
+	if (loader->task) {
+		enkiDeleteTaskSet(loader->task);
+	}
+	Memory_Allocator *allocator = loader->allocator;
+	MEMORY_ALLOCATOR_FREE(allocator, loader->scratch);
+	MEMORY_ALLOCATOR_FREE(allocator, loader->offsets);
+	MEMORY_ALLOCATOR_FREE(allocator, loader->channels);
+	MEMORY_ALLOCATOR_FREE(allocator, loader->fileData);
+	MEMORY_ALLOCATOR_FREE(allocator, loader);
+}
+
+uint32_t ExrLoader_ChannelCount(ExrLoaderHandle handle) {
+	auto loader = (ExrLoader *) handle;
+	return loader ? loader->channelCount : 0;
+}
+
+char const *ExrLoader_ChannelName(ExrLoaderHandle handle, uint32_t index) {
+	auto loader = (ExrLoader *) handle;
+	if (!loader || index >= loader->channelCount) {
+		return nullptr;
+	}
+	return loader->channels[index].name;
+}
+
+void ExrLoader_GetSelection(ExrLoaderHandle handle, int32_t selection[4]) {
+	auto loader = (ExrLoader *) handle;
+	if (!loader) {
+		return;
+	}
+	memcpy(selection, loader->selection, sizeof(int32_t) * 4);
+}
+
+void ExrLoader_SetSelection(ExrLoaderHandle handle, int32_t const selection[4]) {
+	auto loader = (ExrLoader *) handle;
+	if (!loader) {
+		return;
+	}
+	for (uint32_t i = 0; i < 4; ++i) {
+		bool const valid = selection[i] >= 0 && (uint32_t) selection[i] < loader->channelCount;
+		loader->selection[i] = valid ? selection[i] : EXR_LOADER_NO_CHANNEL;
+	}
+}
+
+Image_ImageHeader *ExrLoader_Start(ExrLoaderHandle handle) {
+	auto loader = (ExrLoader *) handle;
+	if (!loader) {
+		return nullptr;
+	}
+	ExrLoader_Cancel(loader);
+	// made here rather than Open so Open can run on a worker
+	if (!loader->task) {
+		loader->task = enkiCreateTaskSet(loader->taskScheduler, &DecodeChunksTask);
+		if (!loader->task) {
+			return nullptr;
+		}
+	}
+
+	loader->halfOutput = true;
+	for (uint32_t i = 0; i < 4; ++i) {
+		int32_t const c = loader->selection[i];
+		if (c != EXR_LOADER_NO_CHANNEL && loader->channels[c].pixelType != EPT_HALF) {
+			loader->halfOutput = false;
+		}
+	}
+
+	TinyImageFormat const format = loader->halfOutput ?
+																 TinyImageFormat_R16G16B16A16_SFLOAT :
+																 TinyImageFormat_R32G32B32A32_SFLOAT;
+	loader->image = Image_Create(loader->width, loader->height, 1, 1, format);
+	if (!loader->image) {
+		return nullptr;
+	}
+
+	// unselected channels read as 0 except alpha which is opaque
+	size_t const pixelCount = (size_t) loader->width * loader->height;
+	memset(Image_RawDataPtr(loader->image), 0, pixelCount * (loader->halfOutput ? 8 : 16));
+	if (loader->selection[3] == EXR_LOADER_NO_CHANNEL) {
+		if (loader->halfOutput) {
+			auto pixels = (uint16_t *) Image_RawDataPtr(loader->image);
+			for (size_t i = 0; i < pixelCount; ++i) {
+				pixels[i * 4 + 3] = 0x3C00;
+			}
+		} else {
+			auto pixels = (float *) Image_RawDataPtr(loader->image);
+			for (size_t i = 0; i < pixelCount; ++i) {
+				pixels[i * 4 + 3] = 1.0f;
+			}
+		}
+	}
+
+	loader->chunksDone.store(0);
+	loader->cancel.store(false);
+	loader->reportedError.store(false);
+	loader->running = true;
+	enkiAddTaskSetToPipe(loader->taskScheduler, loader->task, loader, loader->chunkCount);
+
+	return loader->image;
+}
+
+void ExrLoader_Cancel(ExrLoaderHandle handle) {
+	auto loader = (ExrLoader *) handle;
+	if (!loader || !loader->running) {
+		return;
+	}
+	loader->cancel.store(true);
+	enkiWaitForTaskSet(loader->taskScheduler, loader->task);
+	loader->running = false;
+	loader->image = nullptr;
+}
+
+uint32_t ExrLoader_ChunksDone(ExrLoaderHandle handle) {
+	auto loader = (ExrLoader *) handle;
+	return loader ? loader->chunksDone.load(std::memory_order_acquire) : 0;
+}
+
+uint32_t ExrLoader_ChunkCount(ExrLoaderHandle handle) {
+	auto loader = (ExrLoader *) handle;
+	return loader ? loader->chunkCount : 0;
+}
+
+bool ExrLoader_IsComplete(ExrLoaderHandle handle) {
+	auto loader = (ExrLoader *) handle;
+	return loader && loader->running && ExrLoader_ChunksDone(handle) == loader->chunkCount;
+}
+
+bool ExrLoader_IsDefaultSelection(ExrLoaderHandle handle) {
+	auto loader = (ExrLoader *) handle;
+	return loader && memcmp(loader->selection, loader->defaultSelection, sizeof(int32_t) * 4) == 0;
+}
+
+uint64_t ExrLoader_FileSize(ExrLoaderHandle handle) {
+	auto loader = (ExrLoader *) handle;
+	return loader ? loader->fileSize : 0;
+}
+
+uint64_t ExrLoader_MemoryUsage(ExrLoaderHandle handle) {
+	auto loader = (ExrLoader *) handle;
+	if (!loader) {
+		return 0;
+	}
+	return sizeof(ExrLoader) +
+			loader->fileSize +
+			(sizeof(ExrChannel) * EXR_MAX_CHANNELS) +
+			(sizeof(uint64_t) * loader->chunkCount) +
+			(loader->threadScratchSize * loader->threadCount);
+}
+
+bool ExrLoader_DrawChannelUI(ExrLoaderHandle handle) {
+	auto loader = (ExrLoader *) handle;
+	if (!loader) {
+		return false;
+	}
+
+	bool changed = false;
+	if (ImGui::BeginCombo("Layer", "Pick a layer")) {
+		// channels are sorted by name so a layer's channels are next to each other
+		size_t lastPrefixLen = ~(size_t) 0;
+		char const *lastName = nullptr;
+		for (uint32_t i = 0; i < loader->channelCount; ++i) {
+			char const *name = loader->channels[i].name;
+			size_t const prefixLen = LayerPrefixLength(name);
+			if (lastName && prefixLen == lastPrefixLen && strncmp(name, lastName, prefixLen) == 0) {
+				continue;
+			}
+			lastName = name;
+			lastPrefixLen = prefixLen;
+
+			char label[EXR_MAX_NAME_LENGTH];
+			snprintf(label, sizeof(label), "%.*s##%u", prefixLen ? (int) prefixLen - 1 : 0, name, i);
+			if (prefixLen == 0) {
+				snprintf(label, sizeof(label), "(default)##%u", i);
+			}
+			if (ImGui::Selectable(label)) {
+				SelectLayer(loader, name, prefixLen);
+				changed = true;
+			}
+		}
+		ImGui::EndCombo();
+	}
+
+	static char const *const Labels[4] = {"R from", "G from", "B from", "A from"};
+	for (uint32_t k = 0; k < 4; ++k) {
+		int32_t const current = loader->selection[k];
+		char const *preview = current == EXR_LOADER_NO_CHANNEL ? "(none)" : loader->channels[current].name;
+		ImGui::PushItemWidth(160.0f);
+		if (ImGui::BeginCombo(Labels[k], preview)) {
+			if (ImGui::Selectable("(none)", current == EXR_LOADER_NO_CHANNEL)) {
+				changed |= current != EXR_LOADER_NO_CHANNEL;
+				loader->selection[k] = EXR_LOADER_NO_CHANNEL;
+			}
+			for (uint32_t i = 0; i < loader->channelCount; ++i) {
+				if (ImGui::Selectable(loader->channels[i].name, current == (int32_t) i)) {
+					changed |= current != (int32_t) i;
+					loader->selection[k] = (int32_t) i;
+				}
+			}
+			ImGui::EndCombo();
+		}
+		ImGui::PopItemWidth();
+		if (k != 3) {
+			ImGui::SameLine();
+		}
+	}
+
+	if (loader->running) {
+		uint32_t const done = ExrLoader_ChunksDone(loader);
+		ImGui::ProgressBar((float) done / (float) loader->chunkCount, ImVec2(-1.0f, 0.0f),
+											 done == loader->chunkCount ? "Decoded" : "Decoding");
+	}
+	return changed;
+}
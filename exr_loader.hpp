@@ -0,0 +1,59 @@
+#pragma once
+#ifndef DEVON_EXR_LOADER_HPP
+#define DEVON_EXR_LOADER_HPP
+
+#include "al2o3_enki/TaskScheduler_c.h"
+#include "al2o3_memory/memory.h"
+
+// Chunked OpenEXR decoder. Scanline blocks and tiles decode in parallel on the
+// task scheduler straight into the output image, so it can be displayed whilst
+// it fills in. Handles single part, single level files with NONE, RLE, ZIPS, ZIP
+// and PIZ compression and no subsampling, anything else returns null from Open so
+// the caller can fall back to Image_Load.
+typedef struct ExrLoader *ExrLoaderHandle;
+struct Image_ImageHeader;
+
+static const int32_t EXR_LOADER_NO_CHANNEL = -1;
+
+// just checks the magic number, true doesn't mean Open will take it
+bool ExrLoader_IsExr(char const *fileName);
+// reads the whole file and parses the header, decoding doesn't start until Start.
+// The file, chunk table and decode scratch come from allocator, which must outlive
+// the loader. Safe to call from worker threads
+ExrLoaderHandle ExrLoader_Open(char const *fileName,
+															 enkiTaskSchedulerHandle taskScheduler,
+															 Memory_Allocator *allocator);
+void ExrLoader_Destroy(ExrLoaderHandle handle);
+
+uint32_t ExrLoader_ChannelCount(ExrLoaderHandle handle);
+char const *ExrLoader_ChannelName(ExrLoaderHandle handle, uint32_t index);
+// which file channel ends up in the output R, G, B and A, EXR_LOADER_NO_CHANNEL for none.
+// Unselected channels aren't converted, defaults to R G B A (or the first layer)
+void ExrLoader_GetSelection(ExrLoaderHandle handle, int32_t selection[4]);
+void ExrLoader_SetSelection(ExrLoaderHandle handle, int32_t const selection[4]);
+
+// cancels any decode in flight then starts decoding the current selection into a new
+// RGBA half (or float if any selected channel is float/uint) image. The caller owns
+// the image but mustn't destroy it until after Cancel, a following Start or Destroy,
+// unless it's complete, then nothing of the loader's touches it any more
+Image_ImageHeader *ExrLoader_Start(ExrLoaderHandle handle);
+// waits for in flight chunks to finish
+void ExrLoader_Cancel(ExrLoaderHandle handle);
+
+// chunks written into the image so far, safe to call whilst decoding
+uint32_t ExrLoader_ChunksDone(ExrLoaderHandle handle);
+uint32_t ExrLoader_ChunkCount(ExrLoaderHandle handle);
+bool ExrLoader_IsComplete(ExrLoaderHandle handle);
+
+// true whilst the selection is still what Open picked
+bool ExrLoader_IsDefaultSelection(ExrLoaderHandle handle);
+
+uint64_t ExrLoader_FileSize(ExrLoaderHandle handle);
+
+// file contents and decode scratch
+uint64_t ExrLoader_MemoryUsage(ExrLoaderHandle handle);
+
+// channel pickers, true if the selection changed (it needs a Start to take effect)
+bool ExrLoader_DrawChannelUI(ExrLoaderHandle handle);
+
+#endif //DEVON_EXR_LOADER_HPP
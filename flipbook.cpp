@@ -0,0 +1,578 @@
+#include "al2o3_platform/platform.h"
+#include "al2o3_memory/memory.h"
+#include "al2o3_vfile/vfile.h"
+#include "al2o3_os/time.h"
+#include "gfx_image/image.h"
+#include "gfx_imgui/imgui.h"
+#include "render_basics/texture.h"
+#include <atomic>
+#include <cstdio>
+#include <cmath>
+
+#include "flipbook.hpp"
+#include "texture_load.hpp"
+#include "texture_bytes.hpp"
+#include "frames_in_flight.hpp"
+#include "scratch_arena.hpp"
+#include "memory_panel.hpp"
+
+static const uint32_t MAX_FLIPBOOK_FRAMES = 100000;
+static const uint32_t MAX_FLIPBOOK_PATH_LENGTH = 2048;
+static const uint32_t MAX_FLIPBOOK_SUFFIX_LENGTH = 64;
+// running averages are exponential, this much weight on each new sample
+static const double TIMING_SMOOTHING = 0.1;
+// the first frame grows its slots arena to the file size, later frames reuse that
+static const size_t FRAME_ARENA_BLOCK_SIZE = 64 * 1024;
+
+namespace {
+
+enum SlotState {
+	SS_FREE,
+	SS_DECODING,	// worker owns the slot
+	SS_DECODED,		// image is ready (or null if the frame failed)
+};
+
+struct FrameSlot {
+	Flipbook *flipbook;
+	std::atomic<uint32_t> state;
+	uint32_t frame;
+	Image_ImageHeader const *image;
+	enkiTaskSetHandle task;
+	ScratchArenaHandle arena; // the file contents whilst decoding, reset after each frame
+	bool timingsCounted;
+
+	// written by the worker before state goes to SS_DECODED
+	int64_t requestUs;
+	int64_t readUs;
+	int64_t decodeUs;
+	int64_t readyUs;
+};
+
+struct Timing {
+	double averageMs;
+	double maxMs;
+};
+
+void AddTiming(Timing *timing, int64_t us) {
+	double const ms = (double) us / 1000.0;
+	timing->averageMs = timing->averageMs == 0.0 ? ms :
+											timing->averageMs + ((ms - timing->averageMs) * TIMING_SMOOTHING);
+	timing->maxMs = ms > timing->maxMs ? ms : timing->maxMs;
+}
+
+} // end anon namespace
+
+struct Flipbook {
+	Render_RendererHandle renderer;
+	enkiTaskSchedulerHandle taskScheduler;
+	uint32_t workerCount;
+
+	char pathPrefix[MAX_FLIPBOOK_PATH_LENGTH];
+	char pathSuffix[MAX_FLIPBOOK_SUFFIX_LENGTH];
+	uint32_t padding; // 0 if the numbers aren't zero padded
+	uint32_t firstNumber;
+	uint32_t frameCount;
+
+	uint32_t ringSize;
+	FrameSlot *slots;
+
+	bool playing;
+	bool loop;
+	float fps;
+	double playheadMs;
+	uint32_t dueFrame;
+
+	// the shown frame's slot is pinned so the viewers cpu image stays valid
+	FrameSlot *shownSlot;
+	uint32_t shownFrame;
+	uint32_t lastLateFrame;
+
+	// each shown frame gets a new texture, the old one is retired until the frames
+	// in flight that drew with it are done
+	Render_TextureHandle texture;
+	uint64_t textureBytes;
+
+	uint64_t shownCount;
+	uint64_t droppedCount;
+	uint64_t lateCount;
+	uint64_t failedCount;
+	Timing read;
+	Timing decode;
+	Timing latency;
+	Timing upload;
+};
+
+namespace {
+
+void FramePath(Flipbook const *flipbook, uint32_t frame, char *out, size_t outSize) {
+	snprintf(out, outSize, "%s%0*u%s",
+					 flipbook->pathPrefix,
+					 (int) flipbook->padding,
+					 flipbook->firstNumber + frame,
+					 flipbook->pathSuffix);
+}
+
+bool FrameExists(Flipbook const *flipbook, uint32_t number) {
+	char path[MAX_FLIPBOOK_PATH_LENGTH];
+	snprintf(path, sizeof(path), "%s%0*u%s",
+					 flipbook->pathPrefix,
+					 (int) flipbook->padding,
+					 number,
+					 flipbook->pathSuffix);
+	VFile_Handle fh = VFile_FromFile(path, Os_FM_ReadBinary);
+	if (!fh) {
+		return false;
+	}
+	VFile_Close(fh);
+	return true;
+}
+
+// splits at the last run of digits in the file name (not the folder or extension)
+bool ParseSequenceName(Flipbook *flipbook, char const *fileName, uint32_t *number) {
+	char const *nameStart = fileName;
+	for (char const *c = fileName; *c; ++c) {
+		if (*c == '/' || *c == '\\') {
+			nameStart = c + 1;
+		}
+	}
+
+	char const *digitsEnd = nullptr;
+	for (char const *c = fileName + strlen(fileName); c > nameStart; --c) {
+		if (c[-1] >= '0' && c[-1] <= '9') {
+			digitsEnd = c;
+			break;
+		}
+	}
+	if (!digitsEnd) {
+		return false;
+	}
+	char const *digitsStart = digitsEnd;
+	while (digitsStart > nameStart && digitsStart[-1] >= '0' && digitsStart[-1] <= '9') {
+		digitsStart--;
+	}
+
+	size_t const prefixLen = (size_t) (digitsStart - fileName);
+	size_t const suffixLen = strlen(digitsEnd);
+	size_t const digitCount = (size_t) (digitsEnd - digitsStart);
+	if (prefixLen >= MAX_FLIPBOOK_PATH_LENGTH || suffixLen >= MAX_FLIPBOOK_SUFFIX_LENGTH || digitCount > 9) {
+		return false;
+	}
+
+	memcpy(flipbook->pathPrefix, fileName, prefixLen);
+	flipbook->pathPrefix[prefixLen] = 0;
+	memcpy(flipbook->pathSuffix, digitsEnd, suffixLen + 1);
+	flipbook->padding = (digitsStart[0] == '0' && digitCount > 1) ? (uint32_t) digitCount : 0;
+
+	*number = 0;
+	for (char const *c = digitsStart; c < digitsEnd; ++c) {
+		*number = (*number * 10) + (uint32_t) (*c - '0');
+	}
+	return true;
+}
+
+void DecodeFrame(FrameSlot *slot) {
+	Flipbook const *flipbook = slot->flipbook;
+	char path[MAX_FLIPBOOK_PATH_LENGTH];
+	FramePath(flipbook, slot->frame, path, sizeof(path));
+
+	// read and decode are timed separately so the UI can say which is the bottleneck
+	int64_t const startUs = Os_GetUSec();
+	slot->image = nullptr;
+	Memory_Allocator *allocator = ScratchArena_Allocator(slot->arena);
+	uint8_t *fileData = nullptr;
+	size_t fileSize = 0;
+	VFile_Handle fh = VFile_FromFile(path, Os_FM_ReadBinary);
+	if (fh) {
+		fileSize = (size_t) VFile_Size(fh);
+		fileData = (uint8_t *) MEMORY_ALLOCATOR_MALLOC(allocator, fileSize);
+		if (fileData && VFile_Read(fh, fileData, fileSize) != fileSize) {
+			MEMORY_ALLOCATOR_FREE(allocator, fileData);
+			fileData = nullptr;
+		}
+		VFile_Close(fh);
+	}
+	int64_t const readUs = Os_GetUSec();
+
+	if (fileData) {
+		VFile_Handle memFile = VFile_FromMemory(fileData, fileSize, false);
+		if (memFile) {
+			TinyImageFormat originalFormat;
+			bool gpuNative;
+			Image_ImageHeader const *image = TextureLoad_Decode(flipbook->renderer, flipbook->taskScheduler, memFile, path,
+																													nullptr, &originalFormat, &gpuNative, nullptr);
+			VFile_Close(memFile);
+			if (image) {
+				slot->image = TextureLoad_PackMipmaps(image, nullptr);
+			}
+		}
+		MEMORY_ALLOCATOR_FREE(allocator, fileData);
+	}
+	ScratchArena_Reset(slot->arena);
+	int64_t const endUs = Os_GetUSec();
+
+	slot->readUs = readUs - startUs;
+	slot->decodeUs = endUs - readUs;
+	slot->readyUs = endUs;
+}
+
+void DecodeFrameTask(uint32_t start, uint32_t end, uint32_t threadnum, void *args) {
+	auto slot = (FrameSlot *) args;
+	DecodeFrame(slot);
+	slot->state.store(SS_DECODED, std::memory_order_release);
+}
+
+FrameSlot *FindSlot(Flipbook *flipbook, uint32_t frame) {
+	for (uint32_t i = 0; i < flipbook->ringSize; ++i) {
+		FrameSlot *slot = flipbook->slots + i;
+		if (slot->state.load(std::memory_order_acquire) != SS_FREE && slot->frame == frame) {
+			return slot;
+		}
+	}
+	return nullptr;
+}
+
+// how far ahead of the playhead a frame is, wrapping when looping
+uint32_t DistanceAhead(Flipbook const *flipbook, uint32_t frame) {
+	if (frame >= flipbook->dueFrame) {
+		return frame - flipbook->dueFrame;
+	}
+	return flipbook->loop ? (frame + flipbook->frameCount) - flipbook->dueFrame : ~0u;
+}
+
+// free slots first, then the decoded frame furthest from being needed
+FrameSlot *FindVictim(Flipbook *flipbook, uint32_t distance) {
+	FrameSlot *victim = nullptr;
+	uint32_t victimDistance = distance;
+	for (uint32_t i = 0; i < flipbook->ringSize; ++i) {
+		FrameSlot *slot = flipbook->slots + i;
+		uint32_t const state = slot->state.load(std::memory_order_acquire);
+		if (state == SS_FREE) {
+			return slot;
+		}
+		if (state == SS_DECODING || slot == flipbook->shownSlot) {
+			continue;
+		}
+		uint32_t const slotDistance = DistanceAhead(flipbook, slot->frame);
+		if (slotDistance > victimDistance) {
+			victim = slot;
+			victimDistance = slotDistance;
+		}
+	}
+	return victim;
+}
+
+void ReleaseSlot(FrameSlot *slot) {
+	ASSERT(slot->state.load() != SS_DECODING);
+	if (slot->image) {
+		Image_Destroy(slot->image);
+		slot->image = nullptr;
+	}
+	slot->state.store(SS_FREE);
+}
+
+void RequestFrame(Flipbook *flipbook, uint32_t frame) {
+	if (FindSlot(flipbook, frame)) {
+		return;
+	}
+	FrameSlot *slot = FindVictim(flipbook, DistanceAhead(flipbook, frame));
+	if (!slot) {
+		return;
+	}
+	ReleaseSlot(slot);
+
+	slot->frame = frame;
+	slot->timingsCounted = false;
+	slot->requestUs = Os_GetUSec();
+	slot->state.store(SS_DECODING, std::memory_order_release);
+	enkiAddTaskSetToPipe(flipbook->taskScheduler, slot->task, slot, 1);
+}
+
+// everything but the pinned shown slot looks ahead of the playhead
+void Schedule(Flipbook *flipbook) {
+	uint32_t const ahead = flipbook->ringSize - 1;
+	for (uint32_t i = 0; i < ahead; ++i) {
+		uint32_t frame = flipbook->dueFrame + i;
+		if (frame >= flipbook->frameCount) {
+			if (!flipbook->loop) {
+				break;
+			}
+			frame -= flipbook->frameCount;
+		}
+		RequestFrame(flipbook, frame);
+	}
+}
+
+void CountTimings(Flipbook *flipbook) {
+	for (uint32_t i = 0; i < flipbook->ringSize; ++i) {
+		FrameSlot *slot = flipbook->slots + i;
+		if (slot->timingsCounted || slot->state.load(std::memory_order_acquire) != SS_DECODED) {
+			continue;
+		}
+		slot->timingsCounted = true;
+		AddTiming(&flipbook->read, slot->readUs);
+		AddTiming(&flipbook->decode, slot->decodeUs);
+		AddTiming(&flipbook->latency, slot->readyUs - slot->requestUs);
+	}
+}
+
+void Show(Flipbook *flipbook, FrameSlot *slot, TextureViewer_Texture *texture) {
+	flipbook->shownFrame = slot->frame;
+	if (!slot->image) {
+		// keep the previous frame (and its pin) on screen
+		flipbook->failedCount++;
+		return;
+	}
+	flipbook->shownSlot = slot;
+
+	int64_t const startUs = Os_GetUSec();
+	FramesInFlight_DestroyTexture(flipbook->renderer, flipbook->texture);
+	flipbook->texture = TextureLoad_CreateGpu(flipbook->renderer, slot->image, "Flipbook");
+	flipbook->textureBytes = TextureBytes_OfImage(slot->image);
+	AddTiming(&flipbook->upload, Os_GetUSec() - startUs);
+	flipbook->shownCount++;
+
+	texture->cpu = slot->image;
+	texture->gpu = flipbook->texture;
+}
+
+void SetPlayhead(Flipbook *flipbook, uint32_t frame) {
+	flipbook->playheadMs = (double) frame * 1000.0 / flipbook->fps;
+	flipbook->dueFrame = frame;
+}
+
+} // end anon namespace
+
+FlipbookHandle Flipbook_Create(Render_RendererHandle renderer,
+															 enkiTaskSchedulerHandle taskScheduler,
+															 char const *fileName,
+															 uint32_t ringSize) {
+	ASSERT(ringSize >= 2);
+	auto flipbook = (Flipbook *) MEMORY_CALLOC(1, sizeof(Flipbook));
+	if (!flipbook) {
+		return nullptr;
+	}
+	flipbook->renderer = renderer;
+	flipbook->taskScheduler = taskScheduler;
+	flipbook->workerCount = enkiGetNumTaskThreads(taskScheduler);
+	flipbook->fps = 24.0f;
+	flipbook->loop = true;
+
+	uint32_t number;
+	if (!ParseSequenceName(flipbook, fileName, &number)) {
+		MEMORY_FREE(flipbook);
+		return nullptr;
+	}
+
+	// probe outwards from the picked frame, the sequence ends at the first gap
+	uint32_t first = number;
+	while (first > 0 && (number - first) < MAX_FLIPBOOK_FRAMES && FrameExists(flipbook, first - 1)) {
+		first--;
+	}
+	uint32_t last = number;
+	while ((last - first + 1) < MAX_FLIPBOOK_FRAMES && FrameExists(flipbook, last + 1)) {
+		last++;
+	}
+	if (last == first) {
+		MEMORY_FREE(flipbook);
+		return nullptr;
+	}
+	flipbook->firstNumber = first;
+	flipbook->frameCount = last - first + 1;
+
+	flipbook->ringSize = ringSize;
+	flipbook->slots = (FrameSlot *) MEMORY_CALLOC(ringSize, sizeof(FrameSlot));
+	if (!flipbook->slots) {
+		MEMORY_FREE(flipbook);
+		return nullptr;
+	}
+	for (uint32_t i = 0; i < ringSize; ++i) {
+		FrameSlot *slot = flipbook->slots + i;
+		slot->flipbook = flipbook;
+		slot->state.store(SS_FREE);
+		slot->task = enkiCreateTaskSet(taskScheduler, &DecodeFrameTask);
+		if (!slot->task) {
+			Flipbook_Destroy(flipbook);
+			return nullptr;
+		}
+		// without one (all in use) the file comes from the heap as before
+		slot->arena = ScratchArena_Create(MemoryPanel_LoadAllocator(), FRAME_ARENA_BLOCK_SIZE);
+	}
+
+	// the picked frame is decoded here so the window has something to size itself with
+	SetPlayhead(flipbook, number - first);
+	FrameSlot *slot = flipbook->slots;
+	slot->frame = flipbook->dueFrame;
+	slot->requestUs = Os_GetUSec();
+	DecodeFrame(slot);
+	slot->state.store(SS_DECODED);
+	if (!slot->image) {
+		Flipbook_Destroy(flipbook);
+		return nullptr;
+	}
+	flipbook->shownFrame = ~0u;
+
+	return flipbook;
+}
+
+void Flipbook_Destroy(FlipbookHandle handle) {
+	auto flipbook = (Flipbook *) handle;
+	if (!flipbook) {
+		return;
+	}
+
+	if (flipbook->slots) {
+		for (uint32_t i = 0; i < flipbook->ringSize; ++i) {
+			FrameSlot *slot = flipbook->slots + i;
+			if (!slot->task) {
+				continue;
+			}
+			if (slot->state.load() == SS_DECODING) {
+				enkiWaitForTaskSet(flipbook->taskScheduler, slot->task);
+			}
+			enkiDeleteTaskSet(slot->task);
+			ScratchArena_Destroy(slot->arena);
+			if (slot->image) {
+				Image_Destroy(slot->image);
+			}
+		}
+		MEMORY_FREE(flipbook->slots);
+	}
+	FramesInFlight_DestroyTexture(flipbook->renderer, flipbook->texture);
+	MEMORY_FREE(flipbook);
+}
+
+bool Flipbook_Update(FlipbookHandle handle, double deltaMS, TextureViewer_Texture *texture) {
+	auto flipbook = (Flipbook *) handle;
+	if (!flipbook) {
+		return false;
+	}
+
+	if (flipbook->playing) {
+		flipbook->playheadMs += deltaMS;
+		double const lengthMs = (double) flipbook->frameCount * 1000.0 / flipbook->fps;
+		if (flipbook->playheadMs >= lengthMs) {
+			if (flipbook->loop) {
+				flipbook->playheadMs = fmod(flipbook->playheadMs, lengthMs);
+			} else {
+				flipbook->playheadMs = lengthMs - (1000.0 / flipbook->fps);
+				flipbook->playing = false;
+			}
+		}
+		flipbook->dueFrame = (uint32_t) (flipbook->playheadMs * flipbook->fps / 1000.0);
+		if (flipbook->dueFrame >= flipbook->frameCount) {
+			flipbook->dueFrame = flipbook->frameCount - 1;
+		}
+	}
+
+	Schedule(flipbook);
+	CountTimings(flipbook);
+
+	if (flipbook->dueFrame == flipbook->shownFrame) {
+		return false;
+	}
+
+	FrameSlot *slot = FindSlot(flipbook, flipbook->dueFrame);
+	if (!slot || slot->state.load(std::memory_order_acquire) != SS_DECODED) {
+		// its due but not here, keep showing the old one and count it once
+		if (flipbook->playing && flipbook->lastLateFrame != flipbook->dueFrame) {
+			flipbook->lateCount++;
+			flipbook->lastLateFrame = flipbook->dueFrame;
+		}
+		return false;
+	}
+
+	// frames the playhead passed whilst waiting were never shown
+	if (flipbook->playing && flipbook->shownFrame != ~0u) {
+		uint32_t const step = (flipbook->dueFrame + flipbook->frameCount - flipbook->shownFrame) % flipbook->frameCount;
+		flipbook->droppedCount += step > 1 ? step - 1 : 0;
+	}
+	Show(flipbook, slot, texture);
+	return true;
+}
+
+uint32_t Flipbook_FrameCount(FlipbookHandle handle) {
+	auto flipbook = (Flipbook *) handle;
+	return flipbook ? flipbook->frameCount : 0;
+}
+
+void Flipbook_MemoryUsage(FlipbookHandle handle, uint64_t *cpuBytes, uint64_t *gpuBytes) {
+	auto flipbook = (Flipbook *) handle;
+	*cpuBytes = 0;
+	*gpuBytes = 0;
+	if (!flipbook) {
+		return;
+	}
+
+	*cpuBytes = sizeof(Flipbook) + (sizeof(FrameSlot) * flipbook->ringSize);
+	for (uint32_t i = 0; i < flipbook->ringSize; ++i) {
+		FrameSlot *slot = flipbook->slots + i;
+		uint32_t const state = slot->state.load(std::memory_order_acquire);
+		if (state == SS_DECODED) {
+			*cpuBytes += TextureBytes_OfImage(slot->image);
+		}
+		// decoding slots arenas are the workers to touch
+		if (state != SS_DECODING) {
+			ScratchArena_Stats stats{};
+			ScratchArena_GetStats(slot->arena, &stats);
+			*cpuBytes += stats.reservedBytes;
+		}
+	}
+	*gpuBytes = flipbook->textureBytes;
+}
+
+void Flipbook_DrawUI(FlipbookHandle handle) {
+	auto flipbook = (Flipbook *) handle;
+	if (!flipbook) {
+		return;
+	}
+
+	if (ImGui::Button(flipbook->playing ? "Pause" : "Play")) {
+		flipbook->playing = !flipbook->playing;
+		SetPlayhead(flipbook, flipbook->dueFrame);
+	}
+	ImGui::SameLine();
+	ImGui::Checkbox("Loop", &flipbook->loop);
+	ImGui::SameLine();
+	ImGui::PushItemWidth(120.0f);
+	float fps = flipbook->fps;
+	if (ImGui::SliderFloat("FPS", &fps, 1.0f, 120.0f, "%.1f")) {
+		flipbook->fps = fps;
+		SetPlayhead(flipbook, flipbook->dueFrame);
+	}
+	ImGui::PopItemWidth();
+
+	int frame = (int) flipbook->dueFrame;
+	if (ImGui::SliderInt("Frame", &frame, 0, (int) flipbook->frameCount - 1)) {
+		SetPlayhead(flipbook, (uint32_t) frame);
+	}
+
+	uint32_t ready = 0;
+	for (uint32_t i = 0; i < flipbook->ringSize; ++i) {
+		if (flipbook->slots[i].state.load(std::memory_order_relaxed) == SS_DECODED) {
+			ready++;
+		}
+	}
+	ImGui::Text("Shown %llu  Dropped %llu  Late %llu  Failed %llu  Ring %u/%u ready",
+							(unsigned long long) flipbook->shownCount,
+							(unsigned long long) flipbook->droppedCount,
+							(unsigned long long) flipbook->lateCount,
+							(unsigned long long) flipbook->failedCount,
+							ready, flipbook->ringSize);
+	ImGui::Text("Read %.1fms  Decode %.1fms  Latency %.1fms (max %.1f)  Upload %.1fms",
+							flipbook->read.averageMs,
+							flipbook->decode.averageMs,
+							flipbook->latency.averageMs,
+							flipbook->latency.maxMs,
+							flipbook->upload.averageMs);
+
+	// workers read and decode in parallel, uploads are one at a time on this thread
+	double const budgetMs = 1000.0 / flipbook->fps;
+	double const workers = flipbook->workerCount ? (double) flipbook->workerCount : 1.0;
+	char const *limit = "Keeping up";
+	if (flipbook->upload.averageMs > budgetMs) {
+		limit = "Limited by upload";
+	} else if ((flipbook->read.averageMs + flipbook->decode.averageMs) / workers > budgetMs) {
+		limit = flipbook->read.averageMs > flipbook->decode.averageMs ? "Limited by disk" : "Limited by decode";
+	}
+	ImGui::Text("%s (%.1fms per frame)", limit, budgetMs);
+}
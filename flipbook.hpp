@@ -0,0 +1,34 @@
+#pragma once
+#ifndef DEVON_FLIPBOOK_HPP
+#define DEVON_FLIPBOOK_HPP
+
+#include "render_basics/api.h"
+#include "al2o3_enki/TaskScheduler_c.h"
+#include "texture_viewer.hpp"
+
+// Plays a numbered image sequence (frame.0001.exr, frame.0002.exr...) at a target
+// fps. Frames ahead of the playhead are read and decoded into a small ring on the
+// task scheduler, the main thread uploads the one that's due into a new texture and
+// retires the old one until the frames in flight are done with it.
+typedef struct Flipbook *FlipbookHandle;
+
+// fileName is any frame of the sequence, playback starts there. The first frame is
+// decoded before returning. Null if it isn't part of a sequence of 2 or more frames
+FlipbookHandle Flipbook_Create(Render_RendererHandle renderer,
+															 enkiTaskSchedulerHandle taskScheduler,
+															 char const *fileName,
+															 uint32_t ringSize);
+void Flipbook_Destroy(FlipbookHandle handle);
+
+// main thread once per frame, advances the playhead, queues decodes and shows the
+// due frame if its ready. texture is pointed at the frame on show (the flipbook owns it)
+// returns true if the texture changed
+bool Flipbook_Update(FlipbookHandle handle, double deltaMS, TextureViewer_Texture *texture);
+
+uint32_t Flipbook_FrameCount(FlipbookHandle handle);
+void Flipbook_MemoryUsage(FlipbookHandle handle, uint64_t *cpuBytes, uint64_t *gpuBytes);
+
+// transport controls plus dropped frame and read/decode/upload timings
+void Flipbook_DrawUI(FlipbookHandle handle);
+
+#endif //DEVON_FLIPBOOK_HPP
@@ -0,0 +1,535 @@
+#include "al2o3_platform/platform.h"
+#include "al2o3_memory/memory.h"
+#include "al2o3_cadt/vector.h"
+#include "al2o3_os/filesystem.h"
+#include "gfx_image/image.h"
+#include "render_basics/texture.h"
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+
+#if AL2O3_PLATFORM == AL2O3_PLATFORM_WINDOWS
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <sys/stat.h>
+#endif
+
+#include "folder_browser.hpp"
+#include "texture_bytes.hpp"
+
+// how far ahead of the viewed file to decode, the budget may stop it short
+static const uint32_t MAX_PREFETCH = 4;
+static const size_t MAX_PATH_LENGTH = 1024;
+// what the open dialog offers. EXRs are listed but stream in when opened so aren't prefetched
+static char const *const ViewableExtensions[] = {
+		"ktx", "dds", "exr", "hdr", "jpg", "jpeg", "png", "tga", "bmp", "psd", "gif", "pic", "pnm", "ppm", "basis"
+};
+
+enum SlotState {
+	SS_FREE,
+	SS_DECODING,
+	SS_DECODED,
+	SS_READY, // uploaded (or paged, which has nothing to upload)
+};
+
+struct FolderBrowser;
+
+struct PrefetchSlot {
+	FolderBrowser *browser;
+	enkiTaskSetHandle task;
+
+	SlotState state;
+	bool wanted; // cleared when stepped away from, released once the decode lands
+	uint32_t distance; // where in the wanted list, 0 is the next file
+	bool decodedOk;
+	char path[MAX_PATH_LENGTH];
+	TextureLoad_Decoded decoded;
+};
+
+struct FolderBrowser {
+	Render_RendererHandle renderer;
+	enkiTaskSchedulerHandle taskScheduler;
+	uint64_t budgetBytes;
+
+	char folder[MAX_PATH_LENGTH]; // including the trailing separator
+	CADT_VectorHandle names; // char *, sorted
+	char stepped[MAX_PATH_LENGTH];
+
+	// ahead of the viewed file nearest first, cut short when the budget evicts
+	char wanted[MAX_PREFETCH][MAX_PATH_LENGTH];
+	uint32_t wantedCount;
+	// the biggest decode to land, what one still decoding is guessed to need
+	uint64_t largestBytes;
+
+	PrefetchSlot slots[MAX_PREFETCH];
+};
+
+namespace {
+
+bool EndsWithIgnoreCase(char const *name, size_t len, char const *ext) {
+	size_t const extLen = strlen(ext);
+	if (len <= extLen + 1 || name[len - extLen - 1] != '.') {
+		return false;
+	}
+	for (size_t i = 0; i < extLen; ++i) {
+		if (tolower((unsigned char) name[len - extLen + i]) != ext[i]) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool IsViewable(char const *name) {
+	size_t const len = strlen(name);
+	for (auto const ext : ViewableExtensions) {
+		if (EndsWithIgnoreCase(name, len, ext)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+bool IsExr(char const *name) {
+	return EndsWithIgnoreCase(name, strlen(name), "exr");
+}
+
+int CompareNames(void const *a, void const *b) {
+	return strcmp(*(char const *const *) a, *(char const *const *) b);
+}
+
+void ClearNames(FolderBrowser *browser) {
+	for (size_t i = 0; i < CADT_VectorSize(browser->names); ++i) {
+		MEMORY_FREE(*(char **) CADT_VectorAt(browser->names, i));
+	}
+	CADT_VectorResize(browser->names, 0);
+	browser->folder[0] = 0;
+}
+
+void AddName(FolderBrowser *browser, char const *name) {
+	if (!IsViewable(name)) {
+		return;
+	}
+	size_t const len = strlen(name);
+	auto copy = (char *) MEMORY_CALLOC(len + 1, 1);
+	if (!copy) {
+		return;
+	}
+	memcpy(copy, name, len);
+	CADT_VectorPushElement(browser->names, &copy);
+}
+
+#if AL2O3_PLATFORM == AL2O3_PLATFORM_WINDOWS
+void EnumerateFolder(FolderBrowser *browser, char const *folder) {
+	char pattern[MAX_PATH_LENGTH + 2];
+	snprintf(pattern, sizeof(pattern), "%s*", folder);
+	WIN32_FIND_DATAA findData;
+	HANDLE const find = FindFirstFileA(pattern, &findData);
+	if (find == INVALID_HANDLE_VALUE) {
+		return;
+	}
+	do {
+		if (!(findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)) {
+			AddName(browser, findData.cFileName);
+		}
+	} while (FindNextFileA(find, &findData));
+	FindClose(find);
+}
+#else
+void EnumerateFolder(FolderBrowser *browser, char const *folder) {
+	DIR *dir = opendir(folder[0] ? folder : ".");
+	if (!dir) {
+		return;
+	}
+	while (dirent const *entry = readdir(dir)) {
+		if (entry->d_name[0] == '.') {
+			continue;
+		}
+		// d_type isn't filled in by every filesystem
+		bool isFile = entry->d_type == DT_REG;
+		if (entry->d_type == DT_UNKNOWN || entry->d_type == DT_LNK) {
+			char path[MAX_PATH_LENGTH * 2];
+			struct stat st;
+			snprintf(path, sizeof(path), "%s%s", folder, entry->d_name);
+			isFile = stat(path, &st) == 0 && S_ISREG(st.st_mode);
+		}
+		if (isFile) {
+			AddName(browser, entry->d_name);
+		}
+	}
+	closedir(dir);
+}
+#endif
+
+// -1 if not in the listing
+int IndexOf(FolderBrowser *browser, char const *name) {
+	auto const count = (size_t) CADT_VectorSize(browser->names);
+	if (count == 0) {
+		return -1;
+	}
+	auto const first = (char const **) CADT_VectorAt(browser->names, 0);
+	auto const found = (char const **) bsearch(&name, first, count, sizeof(char *), &CompareNames);
+	return found ? (int) (found - first) : -1;
+}
+
+// lists fileName's folder if its not the one we have or fileName is new to it, returns fileName's index
+int Locate(FolderBrowser *browser, char const *fileName) {
+	size_t startOfFileName = 0;
+	size_t startOfFileNameExt = 0;
+	Os_SplitPath(fileName, &startOfFileName, &startOfFileNameExt);
+	if (startOfFileName >= MAX_PATH_LENGTH) {
+		return -1;
+	}
+	char const *name = fileName + startOfFileName;
+
+	bool const sameFolder = strncmp(browser->folder, fileName, startOfFileName) == 0 &&
+			browser->folder[startOfFileName] == 0;
+	if (sameFolder) {
+		int const index = IndexOf(browser, name);
+		if (index >= 0) {
+			return index;
+		}
+	}
+
+	ClearNames(browser);
+	memcpy(browser->folder, fileName, startOfFileName);
+	browser->folder[startOfFileName] = 0;
+	EnumerateFolder(browser, browser->folder);
+	if (!CADT_VectorIsEmpty(browser->names)) {
+		qsort(CADT_VectorAt(browser->names, 0), CADT_VectorSize(browser->names), sizeof(char *), &CompareNames);
+	}
+	return IndexOf(browser, name);
+}
+
+char const *NameAt(FolderBrowser *browser, int index) {
+	return *(char const **) CADT_VectorAt(browser->names, (size_t) index);
+}
+
+uint64_t CpuBytesOf(PrefetchSlot const *slot) {
+	return TextureBytes_OfImage(slot->decoded.image) + TextureBytes_OfImage(slot->decoded.source);
+}
+
+uint64_t GpuBytesOf(PrefetchSlot const *slot) {
+	return Render_TextureHandleIsValid(slot->decoded.gpu) ? TextureBytes_OfImage(slot->decoded.image) : 0;
+}
+
+// a decode still running is guessed at the biggest seen, or the whole budget before any has landed
+uint64_t BytesOf(FolderBrowser *browser, PrefetchSlot const *slot) {
+	if (slot->state == SS_DECODING) {
+		return browser->largestBytes ? browser->largestBytes : browser->budgetBytes;
+	}
+	return CpuBytesOf(slot) + (slot->decoded.paged ? 0 : TextureBytes_OfImage(slot->decoded.image));
+}
+
+// what wanted files hold or will once decoded and uploaded. Unwanted decodes are dropped as they land
+uint64_t BytesHeld(FolderBrowser *browser) {
+	uint64_t total = 0;
+	for (auto &slot : browser->slots) {
+		if (slot.state != SS_FREE && slot.wanted) {
+			total += BytesOf(browser, &slot);
+		}
+	}
+	return total;
+}
+
+void ReleaseSlot(FolderBrowser *browser, PrefetchSlot *slot) {
+	ASSERT(slot->state != SS_DECODING);
+	TextureLoad_ReleaseDecoded(browser->renderer, &slot->decoded);
+	slot->state = SS_FREE;
+	slot->wanted = false;
+	slot->decodedOk = false;
+	slot->path[0] = 0;
+}
+
+PrefetchSlot *FindSlot(FolderBrowser *browser, char const *path) {
+	for (auto &slot : browser->slots) {
+		if (slot.state != SS_FREE && strcmp(slot.path, path) == 0) {
+			return &slot;
+		}
+	}
+	return nullptr;
+}
+
+void DecodeSlotTask(uint32_t start, uint32_t end, uint32_t threadnum, void *args) {
+	auto slot = (PrefetchSlot *) args;
+	FolderBrowser *browser = slot->browser;
+	slot->decodedOk = TextureLoad_DecodeFile(browser->renderer, browser->taskScheduler, slot->path,
+																					 nullptr, &slot->decoded);
+}
+
+void StartSlot(FolderBrowser *browser, PrefetchSlot *slot, char const *path, uint32_t distance) {
+	size_t const len = strlen(path);
+	memcpy(slot->path, path, len + 1);
+	memset(&slot->decoded, 0, sizeof(TextureLoad_Decoded));
+	slot->decodedOk = false;
+	slot->wanted = true;
+	slot->distance = distance;
+	slot->state = SS_DECODING;
+	enkiAddTaskSetToPipe(browser->taskScheduler, slot->task, slot, 1);
+}
+
+// moves a decode that has landed on, dropping it if its no longer wanted or failed
+void LandSlot(FolderBrowser *browser, PrefetchSlot *slot) {
+	slot->state = SS_DECODED;
+	if (!slot->decodedOk || !slot->wanted) {
+		ReleaseSlot(browser, slot);
+		return;
+	}
+	uint64_t const mine = BytesOf(browser, slot);
+	if (mine > browser->largestBytes) {
+		browser->largestBytes = mine;
+	}
+
+	// over budget the furthest ahead go first, landed or not. The nearest is always
+	// kept so the next step is quick, and nothing from the furthest on is refetched
+	// until the next step
+	while (BytesHeld(browser) > browser->budgetBytes) {
+		PrefetchSlot *furthest = nullptr;
+		PrefetchSlot *nearest = nullptr;
+		for (auto &other : browser->slots) {
+			if (other.state == SS_FREE || !other.wanted) {
+				continue;
+			}
+			if (!furthest || other.distance > furthest->distance) {
+				furthest = &other;
+			}
+			if (!nearest || other.distance < nearest->distance) {
+				nearest = &other;
+			}
+		}
+		if (furthest == nearest) {
+			break;
+		}
+		browser->wantedCount = furthest->distance;
+		if (furthest->state == SS_DECODING) {
+			furthest->wanted = false;
+		} else {
+			ReleaseSlot(browser, furthest);
+		}
+	}
+}
+
+// starts decodes for the wanted files nearest first whilst the budget and free slots allow
+void StartWanted(FolderBrowser *browser) {
+	for (uint32_t i = 0; i < browser->wantedCount; ++i) {
+		if (FindSlot(browser, browser->wanted[i])) {
+			continue;
+		}
+		if (BytesHeld(browser) >= browser->budgetBytes) {
+			break;
+		}
+		PrefetchSlot *freeSlot = nullptr;
+		for (auto &slot : browser->slots) {
+			if (slot.state == SS_FREE) {
+				freeSlot = &slot;
+				break;
+			}
+		}
+		// the rest are still busy, some with files we've stepped past
+		if (!freeSlot) {
+			break;
+		}
+		StartSlot(browser, freeSlot, browser->wanted[i], i);
+	}
+}
+
+} // end anon namespace
+
+FolderBrowserHandle FolderBrowser_Create(Render_RendererHandle renderer,
+																				 enkiTaskSchedulerHandle taskScheduler,
+																				 uint64_t budgetBytes) {
+	auto browser = (FolderBrowser *) MEMORY_CALLOC(1, sizeof(FolderBrowser));
+	if (!browser) {
+		return nullptr;
+	}
+	browser->renderer = renderer;
+	browser->taskScheduler = taskScheduler;
+	browser->budgetBytes = budgetBytes;
+
+	browser->names = CADT_VectorCreate(sizeof(char *));
+	if (!browser->names) {
+		MEMORY_FREE(browser);
+		return nullptr;
+	}
+
+	for (auto &slot : browser->slots) {
+		slot.browser = browser;
+		slot.task = enkiCreateTaskSet(taskScheduler, &DecodeSlotTask);
+		if (!slot.task) {
+			FolderBrowser_Destroy(browser);
+			return nullptr;
+		}
+	}
+	return browser;
+}
+
+void FolderBrowser_Destroy(FolderBrowserHandle handle) {
+	auto browser = (FolderBrowser *) handle;
+	if (!browser) {
+		return;
+	}
+
+	for (auto &slot : browser->slots) {
+		if (!slot.task) {
+			continue;
+		}
+		if (slot.state == SS_DECODING) {
+			enkiWaitForTaskSet(browser->taskScheduler, slot.task);
+			slot.state = SS_DECODED;
+		}
+		if (slot.state != SS_FREE) {
+			ReleaseSlot(browser, &slot);
+		}
+		enkiDeleteTaskSet(slot.task);
+	}
+
+	ClearNames(browser);
+	CADT_VectorDestroy(browser->names);
+	MEMORY_FREE(browser);
+}
+
+char const *FolderBrowser_Step(FolderBrowserHandle handle, char const *fileName, int step) {
+	auto browser = (FolderBrowser *) handle;
+	if (!browser || !fileName) {
+		return nullptr;
+	}
+
+	int const index = Locate(browser, fileName);
+	auto const count = (int) CADT_VectorSize(browser->names);
+	if (index < 0 || count < 2) {
+		return nullptr;
+	}
+
+	int next = (index + step) % count;
+	if (next < 0) {
+		next += count;
+	}
+	snprintf(browser->stepped, MAX_PATH_LENGTH, "%s%s", browser->folder, NameAt(browser, next));
+	return browser->stepped;
+}
+
+bool FolderBrowser_Take(FolderBrowserHandle handle, char const *fileName, TextureLoad_Decoded *decoded) {
+	auto browser = (FolderBrowser *) handle;
+	if (!browser || !fileName) {
+		return false;
+	}
+
+	PrefetchSlot *slot = FindSlot(browser, fileName);
+	if (!slot) {
+		return false;
+	}
+	// its already on its way, starting again would only be slower
+	if (slot->state == SS_DECODING) {
+		enkiWaitForTaskSet(browser->taskScheduler, slot->task);
+		slot->state = SS_DECODED;
+	}
+	if (!slot->decodedOk) {
+		ReleaseSlot(browser, slot);
+		return false;
+	}
+
+	*decoded = slot->decoded;
+	memset(&slot->decoded, 0, sizeof(TextureLoad_Decoded));
+	ReleaseSlot(browser, slot);
+	return true;
+}
+
+void FolderBrowser_Prefetch(FolderBrowserHandle handle, char const *fileName, int direction) {
+	auto browser = (FolderBrowser *) handle;
+	if (!browser || !fileName) {
+		return;
+	}
+
+	int const index = Locate(browser, fileName);
+	auto const count = (int) CADT_VectorSize(browser->names);
+	if (index < 0) {
+		return;
+	}
+	direction = direction < 0 ? -1 : 1;
+
+	// nearest first, stopping short of wrapping back round to the viewed file
+	uint32_t wantedCount = 0;
+	for (int k = 1; k < count && wantedCount < MAX_PREFETCH; ++k) {
+		int next = (index + (direction * k)) % count;
+		if (next < 0) {
+			next += count;
+		}
+		char const *name = NameAt(browser, next);
+		if (IsExr(name)) {
+			continue;
+		}
+		snprintf(browser->wanted[wantedCount++], MAX_PATH_LENGTH, "%s%s", browser->folder, name);
+	}
+	browser->wantedCount = wantedCount;
+
+	for (auto &slot : browser->slots) {
+		if (slot.state == SS_FREE) {
+			continue;
+		}
+		slot.wanted = false;
+		for (uint32_t i = 0; i < wantedCount; ++i) {
+			if (strcmp(slot.path, browser->wanted[i]) == 0) {
+				slot.wanted = true;
+				slot.distance = i;
+				break;
+			}
+		}
+		if (!slot.wanted && slot.state != SS_DECODING) {
+			ReleaseSlot(browser, &slot);
+		}
+	}
+
+	StartWanted(browser);
+}
+
+bool FolderBrowser_Update(FolderBrowserHandle handle) {
+	auto browser = (FolderBrowser *) handle;
+	if (!browser) {
+		return false;
+	}
+
+	bool changed = false;
+	for (auto &slot : browser->slots) {
+		if (slot.state == SS_DECODING && enkiIsTaskSetComplete(browser->taskScheduler, slot.task)) {
+			LandSlot(browser, &slot);
+			changed = true;
+		}
+	}
+	// landing firms up the guess for what is still decoding, so more may fit now
+	if (changed) {
+		StartWanted(browser);
+	}
+
+	// an upload a frame, big ones can take a while
+	for (auto &slot : browser->slots) {
+		if (slot.state != SS_DECODED) {
+			continue;
+		}
+		if (!slot.decoded.paged) {
+			size_t startOfFileName = 0;
+			size_t startOfFileNameExt = 0;
+			Os_SplitPath(slot.path, &startOfFileName, &startOfFileNameExt);
+			slot.decoded.gpu = TextureLoad_CreateGpu(browser->renderer, slot.decoded.image, slot.path + startOfFileName);
+		}
+		slot.state = SS_READY;
+		changed = true;
+		break;
+	}
+	return changed;
+}
+
+void FolderBrowser_MemoryUsage(FolderBrowserHandle handle, uint64_t *cpuBytes, uint64_t *gpuBytes) {
+	auto browser = (FolderBrowser *) handle;
+	*cpuBytes = 0;
+	*gpuBytes = 0;
+	if (!browser) {
+		return;
+	}
+
+	for (auto &slot : browser->slots) {
+		if (slot.state == SS_DECODED || slot.state == SS_READY) {
+			*cpuBytes += CpuBytesOf(&slot);
+			*gpuBytes += GpuBytesOf(&slot);
+		}
+	}
+}
@@ -0,0 +1,37 @@
+#pragma once
+#ifndef DEVON_FOLDER_BROWSER_HPP
+#define DEVON_FOLDER_BROWSER_HPP
+
+#include "render_basics/api.h"
+#include "al2o3_enki/TaskScheduler_c.h"
+#include "texture_load.hpp"
+
+// Steps through the viewable files of a folder in name order. Files ahead in the
+// direction of travel are decoded on the task scheduler and uploaded on the main
+// thread, up to a memory budget, so stepping usually finds the next one ready.
+typedef struct FolderBrowser *FolderBrowserHandle;
+
+FolderBrowserHandle FolderBrowser_Create(Render_RendererHandle renderer,
+																				 enkiTaskSchedulerHandle taskScheduler,
+																				 uint64_t budgetBytes);
+void FolderBrowser_Destroy(FolderBrowserHandle handle);
+
+// the file step places away from fileName in its folder, wrapping at the ends.
+// The folder is (re)listed if it isn't the last one or fileName isn't in it.
+// Null if there is nothing else there, valid until the next call
+char const *FolderBrowser_Step(FolderBrowserHandle handle, char const *fileName, int step);
+
+// hands over fileName if its been prefetched (waiting if its still decoding),
+// the caller then owns the decoded images and gpu texture
+bool FolderBrowser_Take(FolderBrowserHandle handle, char const *fileName, TextureLoad_Decoded *decoded);
+
+// fileName is now being viewed having stepped in direction (+1 or -1), drops what
+// isn't ahead of it and starts decoding what is
+void FolderBrowser_Prefetch(FolderBrowserHandle handle, char const *fileName, int direction);
+
+// main thread once per frame, uploads a landed decode. true if anything changed
+bool FolderBrowser_Update(FolderBrowserHandle handle);
+
+void FolderBrowser_MemoryUsage(FolderBrowserHandle handle, uint64_t *cpuBytes, uint64_t *gpuBytes);
+
+#endif //DEVON_FOLDER_BROWSER_HPP
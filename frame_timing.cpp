@@ -0,0 +1,141 @@
+#include "al2o3_platform/platform.h"
+#include "al2o3_cadt/vector.h"
+#include "al2o3_os/time.h"
+#include "gfx_imgui/imgui.h"
+#include <cfloat>
+#include <cstdio>
+
+#include "frame_timing.hpp"
+
+static const uint32_t HISTORY_LENGTH = 240;
+
+namespace {
+
+struct Row {
+	char const *name;
+	int64_t encodeUs;
+	uint64_t screenPixels;
+};
+
+CADT_VectorHandle rows;
+int64_t rowsEncodeUs;
+uint64_t rowsScreenPixels;
+
+int64_t frameStartUs;
+int64_t lastCpuUs;
+int64_t lastGpuUs = -1;
+bool measureGpu = false;
+
+float cpuHistory[HISTORY_LENGTH];
+float gpuHistory[HISTORY_LENGTH];
+uint32_t historyHead;
+
+bool panelOpen = false;
+
+float ToMs(int64_t us) {
+	return (float) us / 1000.0f;
+}
+
+} // end anon namespace
+
+void FrameTiming_BeginFrame() {
+	frameStartUs = Os_GetUSec();
+}
+
+void FrameTiming_EndFrame(Render_QueueHandle queue) {
+	int64_t const submittedUs = Os_GetUSec();
+	lastCpuUs = submittedUs - frameStartUs;
+	if (measureGpu) {
+		Render_QueueWaitIdle(queue);
+		lastGpuUs = Os_GetUSec() - submittedUs;
+	} else {
+		lastGpuUs = -1;
+	}
+
+	cpuHistory[historyHead] = ToMs(lastCpuUs);
+	gpuHistory[historyHead] = lastGpuUs >= 0 ? ToMs(lastGpuUs) : 0.0f;
+	historyHead = (historyHead + 1) % HISTORY_LENGTH;
+}
+
+void FrameTiming_SetMeasureGpu(bool measure) {
+	measureGpu = measure;
+}
+
+int64_t FrameTiming_LastCpuUs() {
+	return lastCpuUs;
+}
+
+int64_t FrameTiming_LastGpuUs() {
+	return lastGpuUs;
+}
+
+void FrameTiming_BeginSample() {
+	if (!rows) {
+		rows = CADT_VectorCreate(sizeof(Row));
+	}
+	CADT_VectorResize(rows, 0);
+	rowsEncodeUs = 0;
+	rowsScreenPixels = 0;
+}
+
+void FrameTiming_AddRow(char const *name, int64_t encodeUs, uint64_t screenPixels) {
+	Row const row{name, encodeUs, screenPixels};
+	CADT_VectorPushElement(rows, (void *) &row);
+	rowsEncodeUs += encodeUs;
+	rowsScreenPixels += screenPixels;
+}
+
+void FrameTiming_Open() {
+	panelOpen = true;
+}
+
+void FrameTiming_Display() {
+	if (!panelOpen) {
+		return;
+	}
+
+	ImGui::SetNextWindowSize(ImVec2(560, 420), ImGuiCond_FirstUseEver);
+	if (!ImGui::Begin("Frame timing", &panelOpen, 0)) {
+		ImGui::End();
+		return;
+	}
+
+	ImGui::Checkbox("Measure GPU (waits for the GPU every frame)", &measureGpu);
+	ImGui::Text("CPU %.2f ms", ToMs(lastCpuUs));
+	ImGui::PlotLines("CPU ms", cpuHistory, HISTORY_LENGTH, historyHead, nullptr, 0.0f, FLT_MAX, ImVec2(0, 60));
+	if (lastGpuUs >= 0) {
+		ImGui::Text("GPU %.2f ms", ToMs(lastGpuUs));
+		ImGui::PlotLines("GPU ms", gpuHistory, HISTORY_LENGTH, historyHead, nullptr, 0.0f, FLT_MAX, ImVec2(0, 60));
+	}
+
+	ImGui::Separator();
+	ImGui::Columns(3, "timing rows");
+	ImGui::Text("Viewer");
+	ImGui::NextColumn();
+	ImGui::Text("Encode us");
+	ImGui::NextColumn();
+	ImGui::Text("Screen Kpixels");
+	ImGui::NextColumn();
+	ImGui::Separator();
+	if (rows) {
+		for (size_t i = 0; i < CADT_VectorSize(rows); ++i) {
+			auto row = (Row const *) CADT_VectorAt(rows, i);
+			ImGui::Text("%s", row->name);
+			ImGui::NextColumn();
+			ImGui::Text("%lld", (long long) row->encodeUs);
+			ImGui::NextColumn();
+			ImGui::Text("%.1f", (double) row->screenPixels / 1000.0);
+			ImGui::NextColumn();
+		}
+	}
+	ImGui::Separator();
+	ImGui::Text("Total");
+	ImGui::NextColumn();
+	ImGui::Text("%lld", (long long) rowsEncodeUs);
+	ImGui::NextColumn();
+	ImGui::Text("%.1f", (double) rowsScreenPixels / 1000.0);
+	ImGui::NextColumn();
+	ImGui::Columns(1);
+
+	ImGui::End();
+}
@@ -0,0 +1,28 @@
+#pragma once
+#ifndef DEVON_FRAME_TIMING_HPP
+#define DEVON_FRAME_TIMING_HPP
+
+#include "render_basics/api.h"
+
+// CPU and GPU frame times plus what each viewer cost last frame. render_basics has
+// no timestamp queries so GPU time is how long the queue takes to drain after
+// present. That wait stops the CPU running ahead, so it's only done whilst asked for.
+
+// top of each update
+void FrameTiming_BeginFrame();
+// after present, waits for the queue to go idle when measuring the GPU
+void FrameTiming_EndFrame(Render_QueueHandle queue);
+
+void FrameTiming_SetMeasureGpu(bool measure);
+int64_t FrameTiming_LastCpuUs();
+// -1 if the GPU wasn't measured
+int64_t FrameTiming_LastGpuUs();
+
+// each sample lists the viewers drawn that frame, rows are only read until the next sample
+void FrameTiming_BeginSample();
+void FrameTiming_AddRow(char const *name, int64_t encodeUs, uint64_t screenPixels);
+
+void FrameTiming_Open();
+void FrameTiming_Display();
+
+#endif //DEVON_FRAME_TIMING_HPP
@@ -0,0 +1,66 @@
+#include "al2o3_platform/platform.h"
+#include "al2o3_cadt/vector.h"
+#include "render_basics/texture.h"
+
+#include "frames_in_flight.hpp"
+
+namespace {
+
+struct Retired {
+	Render_RendererHandle renderer;
+	Render_TextureHandle texture;
+	uint64_t frame; // presented frames when it was retired
+};
+
+CADT_VectorHandle retired;
+uint64_t presentedFrames;
+
+} // end anon namespace
+
+void FramesInFlight_DestroyTexture(Render_RendererHandle renderer, Render_TextureHandle texture) {
+	if (!Render_TextureHandleIsValid(texture)) {
+		return;
+	}
+	if (!retired) {
+		retired = CADT_VectorCreate(sizeof(Retired));
+	}
+	if (!retired) {
+		// nowhere to keep it so it has to go now
+		LOGWARNING("Unable to retire a texture, destroying it now");
+		Render_TextureDestroy(renderer, texture);
+		return;
+	}
+
+	Retired const entry{renderer, texture, presentedFrames};
+	CADT_VectorPushElement(retired, (void *) &entry);
+}
+
+void FramesInFlight_EndFrame() {
+	presentedFrames++;
+	if (!retired) {
+		return;
+	}
+
+	size_t kept = 0;
+	for (size_t i = 0; i < CADT_VectorSize(retired); ++i) {
+		auto entry = (Retired *) CADT_VectorAt(retired, i);
+		if (presentedFrames - entry->frame >= FRAMES_IN_FLIGHT) {
+			Render_TextureDestroy(entry->renderer, entry->texture);
+		} else {
+			*(Retired *) CADT_VectorAt(retired, kept++) = *entry;
+		}
+	}
+	CADT_VectorResize(retired, kept);
+}
+
+void FramesInFlight_Flush() {
+	if (!retired) {
+		return;
+	}
+	for (size_t i = 0; i < CADT_VectorSize(retired); ++i) {
+		auto entry = (Retired const *) CADT_VectorAt(retired, i);
+		Render_TextureDestroy(entry->renderer, entry->texture);
+	}
+	CADT_VectorDestroy(retired);
+	retired = nullptr;
+}
@@ -0,0 +1,22 @@
+#pragma once
+#ifndef DEVON_FRAMES_IN_FLIGHT_HPP
+#define DEVON_FRAMES_IN_FLIGHT_HPP
+
+#include "al2o3_platform/platform.h"
+#include "render_basics/api.h"
+
+// how many frames the CPU can be ahead of the GPU. Per frame buffers have a copy
+// for each and anything a frame draws with has to outlive it by this many frames
+static const uint32_t FRAMES_IN_FLIGHT = 3;
+// after a change keep uploading long enough for every frame in flight to see it
+static const uint32_t UNIFORM_UPLOADS_PER_CHANGE = FRAMES_IN_FLIGHT;
+
+// Textures swapped out whilst a frame that drew with them may still be on the GPU are
+// retired here and destroyed FRAMES_IN_FLIGHT presented frames later. Main thread only.
+void FramesInFlight_DestroyTexture(Render_RendererHandle renderer, Render_TextureHandle texture);
+// after each present
+void FramesInFlight_EndFrame();
+// destroys everything still retired, the GPU must be idle
+void FramesInFlight_Flush();
+
+#endif //DEVON_FRAMES_IN_FLIGHT_HPP
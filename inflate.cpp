@@ -0,0 +1,362 @@
+#include "al2o3_platform/platform.h"
+
+#include "inflate.hpp"
+
+// codes up to this length decode with a single table lookup, longer ones walk the canonical code
+static const uint32_t FAST_BITS = 9;
+static const uint32_t MAX_CODE_BITS = 15;
+static const uint32_t MAX_LITLEN_SYMBOLS = 288;
+static const uint32_t MAX_DIST_SYMBOLS = 32;
+
+namespace {
+
+uint16_t const LengthBase[29] = {
+		3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+		35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+uint8_t const LengthExtra[29] = {
+		0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+		3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+uint16_t const DistBase[30] = {
+		1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+		257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+uint8_t const DistExtra[30] = {
+		0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+		7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+uint8_t const CodeLengthOrder[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+
+struct Huffman {
+	uint16_t counts[MAX_CODE_BITS + 1];
+	uint16_t symbols[MAX_LITLEN_SYMBOLS];
+	// (length << 9) | symbol, 0 when the code is longer than FAST_BITS
+	uint16_t fast[1 << FAST_BITS];
+};
+
+struct BitReader {
+	uint8_t const *src;
+	size_t srcSize;
+	size_t pos;
+	uint64_t bits; // next bit is bit 0
+	uint32_t count;
+};
+
+void Refill(BitReader *br) {
+	while (br->count <= 56 && br->pos < br->srcSize) {
+		br->bits |= ((uint64_t) br->src[br->pos++]) << br->count;
+		br->count += 8;
+	}
+}
+
+bool GetBits(BitReader *br, uint32_t n, uint32_t *out) {
+	if (br->count < n) {
+		Refill(br);
+		if (br->count < n) {
+			return false;
+		}
+	}
+	*out = (uint32_t) (br->bits & ((1ull << n) - 1));
+	br->bits >>= n;
+	br->count -= n;
+	return true;
+}
+
+bool Build(Huffman *h, uint8_t const *lengths, uint32_t n) {
+	memset(h, 0, sizeof(Huffman));
+	for (uint32_t i = 0; i < n; ++i) {
+		h->counts[lengths[i]]++;
+	}
+	h->counts[0] = 0;
+
+	// reject over subscribed codes, incomplete ones are legal (e.g. a single distance code)
+	int32_t left = 1;
+	for (uint32_t len = 1; len <= MAX_CODE_BITS; ++len) {
+		left = (left << 1) - h->counts[len];
+		if (left < 0) {
+			return false;
+		}
+	}
+
+	uint16_t offsets[MAX_CODE_BITS + 2];
+	uint16_t nextCode[MAX_CODE_BITS + 2];
+	offsets[1] = 0;
+	nextCode[1] = 0;
+	for (uint32_t len = 1; len <= MAX_CODE_BITS; ++len) {
+		offsets[len + 1] = offsets[len] + h->counts[len];
+		nextCode[len + 1] = (uint16_t) ((nextCode[len] + h->counts[len]) << 1);
+	}
+
+	for (uint32_t sym = 0; sym < n; ++sym) {
+		uint32_t const len = lengths[sym];
+		if (len == 0) {
+			continue;
+		}
+		h->symbols[offsets[len]++] = (uint16_t) sym;
+
+		uint32_t const code = nextCode[len]++;
+		if (len <= FAST_BITS) {
+			// deflate sends codes msb first into an lsb first stream so the table is indexed reversed
+			uint32_t reversed = 0;
+			for (uint32_t i = 0; i < len; ++i) {
+				reversed |= ((code >> i) & 1) << (len - 1 - i);
+			}
+			for (uint32_t i = reversed; i < (1u << FAST_BITS); i += (1u << len)) {
+				h->fast[i] = (uint16_t) ((len << 9) | sym);
+			}
+		}
+	}
+	return true;
+}
+
+bool Decode(BitReader *br, Huffman const *h, uint32_t *sym) {
+	if (br->count < 16) {
+		Refill(br);
+	}
+
+	// near the end of the stream the missing bits read as zero, the length check catches overruns
+	uint16_t const entry = h->fast[br->bits & ((1u << FAST_BITS) - 1)];
+	if (entry) {
+		uint32_t const len = entry >> 9;
+		if (len > br->count) {
+			return false;
+		}
+		br->bits >>= len;
+		br->count -= len;
+		*sym = entry & 0x1FF;
+		return true;
+	}
+
+	int32_t code = 0;
+	int32_t first = 0;
+	int32_t index = 0;
+	for (uint32_t len = 1; len <= MAX_CODE_BITS; ++len) {
+		uint32_t bit;
+		if (!GetBits(br, 1, &bit)) {
+			return false;
+		}
+		code |= (int32_t) bit;
+		int32_t const count = h->counts[len];
+		if (code - first < count) {
+			*sym = h->symbols[index + (code - first)];
+			return true;
+		}
+		index += count;
+		first = (first + count) << 1;
+		code <<= 1;
+	}
+	return false;
+}
+
+bool Stored(BitReader *br, uint8_t *dst, size_t dstSize, size_t *outPos) {
+	// drop to a byte boundary, whole bytes still in the bit buffer are part of the header
+	uint32_t unused;
+	GetBits(br, br->count & 7, &unused);
+
+	uint32_t len, nlen;
+	if (!GetBits(br, 16, &len) || !GetBits(br, 16, &nlen) || (len != (~nlen & 0xFFFF))) {
+		return false;
+	}
+	if (*outPos + len > dstSize) {
+		return false;
+	}
+	while (len && br->count >= 8) {
+		dst[(*outPos)++] = (uint8_t) (br->bits & 0xFF);
+		br->bits >>= 8;
+		br->count -= 8;
+		len--;
+	}
+	if (br->pos + len > br->srcSize) {
+		return false;
+	}
+	memcpy(dst + *outPos, br->src + br->pos, len);
+	br->pos += len;
+	*outPos += len;
+	return true;
+}
+
+bool Codes(BitReader *br, Huffman const *litLen, Huffman const *dist, uint8_t *dst, size_t dstSize, size_t *outPos) {
+	size_t pos = *outPos;
+	for (;;) {
+		uint32_t sym;
+		if (!Decode(br, litLen, &sym)) {
+			return false;
+		}
+		if (sym < 256) {
+			if (pos >= dstSize) {
+				return false;
+			}
+			dst[pos++] = (uint8_t) sym;
+			continue;
+		}
+		if (sym == 256) {
+			break;
+		}
+
+		sym -= 257;
+		if (sym >= 29) {
+			return false;
+		}
+		uint32_t extra;
+		if (!GetBits(br, LengthExtra[sym], &extra)) {
+			return false;
+		}
+		uint32_t const len = LengthBase[sym] + extra;
+
+		if (!Decode(br, dist, &sym) || sym >= 30) {
+			return false;
+		}
+		if (!GetBits(br, DistExtra[sym], &extra)) {
+			return false;
+		}
+		uint32_t const distance = DistBase[sym] + extra;
+
+		if (distance > pos || pos + len > dstSize) {
+			return false;
+		}
+		// overlapping copies are how deflate encodes runs so byte at a time
+		uint8_t const *from = dst + pos - distance;
+		for (uint32_t i = 0; i < len; ++i) {
+			dst[pos + i] = from[i];
+		}
+		pos += len;
+	}
+	*outPos = pos;
+	return true;
+}
+
+struct FixedTables {
+	Huffman litLen;
+	Huffman dist;
+
+	FixedTables() {
+		uint8_t lengths[MAX_LITLEN_SYMBOLS];
+		memset(lengths + 0, 8, 144);
+		memset(lengths + 144, 9, 112);
+		memset(lengths + 256, 7, 24);
+		memset(lengths + 280, 8, 8);
+		Build(&litLen, lengths, MAX_LITLEN_SYMBOLS);
+		memset(lengths, 5, 30);
+		Build(&dist, lengths, 30);
+	}
+};
+
+bool Fixed(BitReader *br, uint8_t *dst, size_t dstSize, size_t *outPos) {
+	// function statics are initialised once even with several decoding threads
+	static FixedTables const tables;
+	return Codes(br, &tables.litLen, &tables.dist, dst, dstSize, outPos);
+}
+
+bool Dynamic(BitReader *br, uint8_t *dst, size_t dstSize, size_t *outPos) {
+	uint32_t hlit, hdist, hclen;
+	if (!GetBits(br, 5, &hlit) || !GetBits(br, 5, &hdist) || !GetBits(br, 4, &hclen)) {
+		return false;
+	}
+	hlit += 257;
+	hdist += 1;
+	hclen += 4;
+	if (hlit > 286 || hdist > 30) {
+		return false;
+	}
+
+	uint8_t lengths[MAX_LITLEN_SYMBOLS + MAX_DIST_SYMBOLS];
+	memset(lengths, 0, 19);
+	for (uint32_t i = 0; i < hclen; ++i) {
+		uint32_t len;
+		if (!GetBits(br, 3, &len)) {
+			return false;
+		}
+		lengths[CodeLengthOrder[i]] = (uint8_t) len;
+	}
+
+	Huffman litLen;
+	Huffman dist;
+	if (!Build(&litLen, lengths, 19)) {
+		return false;
+	}
+
+	uint32_t index = 0;
+	while (index < hlit + hdist) {
+		uint32_t sym;
+		if (!Decode(br, &litLen, &sym)) {
+			return false;
+		}
+		if (sym < 16) {
+			lengths[index++] = (uint8_t) sym;
+			continue;
+		}
+
+		uint8_t repeatLen = 0;
+		uint32_t repeat;
+		if (sym == 16) {
+			if (index == 0 || !GetBits(br, 2, &repeat)) {
+				return false;
+			}
+			repeatLen = lengths[index - 1];
+			repeat += 3;
+		} else if (sym == 17) {
+			if (!GetBits(br, 3, &repeat)) {
+				return false;
+			}
+			repeat += 3;
+		} else {
+			if (!GetBits(br, 7, &repeat)) {
+				return false;
+			}
+			repeat += 11;
+		}
+		if (index + repeat > hlit + hdist) {
+			return false;
+		}
+		memset(lengths + index, repeatLen, repeat);
+		index += repeat;
+	}
+
+	if (lengths[256] == 0) {
+		return false;
+	}
+	if (!Build(&litLen, lengths, hlit) || !Build(&dist, lengths + hlit, hdist)) {
+		return false;
+	}
+	return Codes(br, &litLen, &dist, dst, dstSize, outPos);
+}
+
+} // end anon namespace
+
+bool Inflate_Zlib(uint8_t const *src, size_t srcSize, uint8_t *dst, size_t dstSize, size_t *outSize) {
+	if (srcSize < 2) {
+		return false;
+	}
+	uint32_t const cmf = src[0];
+	uint32_t const flg = src[1];
+	if ((cmf & 0xF) != 8 || ((cmf << 8) | flg) % 31 != 0 || (flg & 0x20)) {
+		return false;
+	}
+
+	BitReader br{src, srcSize, 2, 0, 0};
+	size_t pos = 0;
+	uint32_t final = 0;
+	while (!final) {
+		uint32_t type;
+		if (!GetBits(&br, 1, &final) || !GetBits(&br, 2, &type)) {
+			return false;
+		}
+
+		bool ok;
+		switch (type) {
+			case 0: ok = Stored(&br, dst, dstSize, &pos);
+				break;
+			case 1: ok = Fixed(&br, dst, dstSize, &pos);
+				break;
+			case 2: ok = Dynamic(&br, dst, dstSize, &pos);
+				break;
+			default: ok = false;
+				break;
+		}
+		if (!ok) {
+			return false;
+		}
+	}
+
+	if (outSize) {
+		*outSize = pos;
+	}
+	return true;
+}
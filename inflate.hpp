@@ -0,0 +1,12 @@
+#pragma once
+#ifndef DEVON_INFLATE_HPP
+#define DEVON_INFLATE_HPP
+
+#include "al2o3_platform/platform.h"
+
+// Decompresses a zlib wrapped deflate stream into a caller supplied buffer.
+// Thread safe, no allocations. Returns false on corrupt input or if dst is too small,
+// the adler checksum isn't checked.
+bool Inflate_Zlib(uint8_t const *src, size_t srcSize, uint8_t *dst, size_t dstSize, size_t *outSize);
+
+#endif //DEVON_INFLATE_HPP
@@ -5,13 +5,12 @@
 #include "al2o3_cadt/freelist.h"
 #include "al2o3_cadt/vector.h"
 
-#include "gfx_imageio/io.h"
-#include "gfx_image/utils.h"
-#include "gfx_imagedecompress/imagedecompress.h"
+#include "gfx_image/image.h"
 #include "utils_gameappshell/gameappshell.h"
 #include "utils_simple_logmanager/logmanager.h"
 #include "al2o3_vfile/vfile.h"
 #include "al2o3_os/filesystem.h"
+#include "al2o3_os/time.h"
 #include "input_basic/input.h"
 
 #include "render_basics/api.h"
@@ -20,9 +19,26 @@
 
 #include "gfx_imgui/imgui.h"
 #include "utils_nativefiledialogs/dialogs.h"
-#include <cstdio> // for sprintf
+#include <cstdio> // for snprintf
+#include <cstdlib> // for atoi
 
 #include "texture_viewer.hpp"
+#include "texture_bytes.hpp"
+#include "texture_load.hpp"
+#include "texture_registry.hpp"
+#include "memory_panel.hpp"
+#include "contact_sheet.hpp"
+#include "exr_loader.hpp"
+#include "flipbook.hpp"
+#include "single_instance.hpp"
+#include "bc6h.hpp"
+#include "startup_profile.hpp"
+#include "folder_browser.hpp"
+#include "frame_timing.hpp"
+#include "frames_in_flight.hpp"
+#include "benchmark.hpp"
+#include "redraw.hpp"
+#include "scratch_arena.hpp"
 #include "about.h"
 
 static SimpleLogManager_Handle g_logger;
@@ -43,18 +59,101 @@ enum AppKey {
 	AppKey_Quit
 };
 
-static const int MAX_TEXTURE_WINDOWS = 100;
+static const int MAX_TEXTURE_WINDOWS = 4096;
 static const int MAX_INPUT_PATH_LENGTH = 1024;
+static const uint32_t SLICE_PAGER_RING_SIZE = 16;
+// each load bumps its hash buffer and EXR file contents through its own arena
+static const size_t LOAD_ARENA_BLOCK_SIZE = 64 * 1024;
+// whilst an EXR is decoding a point sampled preview of it no bigger than this is
+// refreshed this often, the full size texture is only made once it completes
+static const int64_t EXR_UPLOAD_PERIOD_US = 100000;
+static const uint32_t EXR_PREVIEW_SIZE = 1024;
+static const uint32_t FLIPBOOK_RING_SIZE = 8;
+// cpu and gpu copies of a few 4K RGBA8 textures with mips
+static const uint64_t FOLDER_PREFETCH_BUDGET = 768ull * 1024 * 1024;
+// a run of unloadable files in a folder is skipped over, up to a point
+static const int MAX_FOLDER_STEP_TRIES = 16;
+static char const SINGLE_INSTANCE_ARG[] = "--single-instance";
+static char const BC6H_BENCHMARK_ARG[] = "--bc6h-benchmark";
+static char const STARTUP_REPORT_ARG[] = "--startup-report";
+// keeps converted textures originals for the texel readout
+static char const EXACT_READOUT_ARG[] = "--exact-readout";
+// --benchmark or --benchmark=<texture count>
+static char const BENCHMARK_ARG[] = "--benchmark";
+static const uint32_t BENCHMARK_DEFAULT_TEXTURES = 16;
+static const uint32_t BENCHMARK_FRAMES = 600;
+static char const BENCHMARK_RESULTS_FILE[] = "devon_benchmark.json";
 
 struct TextureWindow {
 	TextureViewerHandle textureViewer;
 	TextureViewer_Texture textureToView;
+	char *filePath;
+	uint32_t registryIndex; // where in textureWindows this lives
+	int windowId; // imgui id, kept when the texture changes so the window stays put
+
+	// progressive EXR decode, cpu fills in behind the loaders back and the gpu shows the
+	// preview until its done. Once the default channels are complete they go to the
+	// registry as the files content and the loader is dropped, its only opened again to
+	// pick other channels
+	ExrLoaderHandle exr;
+	ScratchArenaHandle exrArena; // the loaders memory, goes with it
+	Image_ImageHeader *exrPreview; // null once complete or if the image is small already
+	uint32_t exrUploadedChunks;
+	int64_t exrLastUploadUs;
+	bool exrRestart;
+	uint64_t exrContentHash;
+
+	// sequence playback, the flipbook owns the textureToView cpu and gpu
+	FlipbookHandle flipbook;
+
+	// files are shared with other windows showing the same content, the registry
+	// owns the textureToView cpu and gpu
+	TextureRegistry_EntryHandle sharedTexture;
+
+	// which of the benchmarks textures this shows, -1 for everything else
+	int32_t benchmarkIndex;
+};
+
+enum PendingLoadStage {
+	PLS_READING, // hashing the file
+	PLS_DECODING, // nothing open had the same content
+};
+
+// a load running on a worker, its window joins textureWindows once it lands
+struct PendingLoad {
+	TextureWindow *textureWindow;
+	enkiTaskSetHandle task; // null if it was run inline
+	PendingLoadStage stage;
+	TextureLoad_File file;
+	bool readOk;
+	bool exrFile;
+	ExrLoaderHandle exr; // opened instead of decoding if the chunked loader takes the file
+	ScratchArenaHandle arena; // goes to the window with exr
+	TextureLoad_Stats stats;
+	TextureLoad_Decoded decoded;
+	bool decodedOk;
+	TextureRegistry_EntryHandle shared; // what decoded went to or the same content already open
 };
 
 void LoadTexture(char const *fileName);
+void LoadSequence(char const *fileName);
 CADT_FreeListHandle textureWindowFreeList;
 CADT_VectorHandle textureWindows;
 CADT_VectorHandle fileToOpenQueue;
+CADT_VectorHandle pendingLoads;
+ContactSheetHandle contactSheet;
+
+// made on the first step through a folder
+FolderBrowserHandle folderBrowser;
+// last focused texture window and a step through its folder to apply next update
+TextureWindow *navWindow;
+int navStep;
+
+bool singleInstance;
+bool bc6hBenchmark;
+uint32_t benchmarkTextures; // 0 unless benchmarking
+BenchmarkHandle benchmark;
+
 
 static void *EnkiAlloc(void *userData, size_t size) {
 	return MEMORY_ALLOCATOR_MALLOC((Memory_Allocator *) userData, size);
@@ -63,14 +162,255 @@ static void EnkiFree(void *userData, void *ptr) {
 	MEMORY_ALLOCATOR_FREE((Memory_Allocator *) userData, ptr);
 }
 
-static void LoadTextureToView(char const *fileName, TextureWindow *tw) {
+static void DestroyExrLoader(TextureWindow *tw) {
+	ExrLoader_Destroy(tw->exr);
+	tw->exr = nullptr;
+	ScratchArena_Destroy(tw->exrArena);
+	tw->exrArena = nullptr;
+}
+
+static void ReleaseTextureToView(TextureWindow *tw) {
+	tw->benchmarkIndex = -1;
+
+	if (tw->flipbook) {
+		Flipbook_Destroy(tw->flipbook);
+		tw->flipbook = nullptr;
+		tw->textureToView.cpu = nullptr;
+		tw->textureToView.gpu = {};
+	}
+
+	// pager, fetcher and exr loader use the cpu image so must go first
+	TexelFetch_Destroy(tw->textureToView.fetcher);
+	tw->textureToView.fetcher = nullptr;
+	SlicePager_Destroy(tw->textureToView.pager);
+	tw->textureToView.pager = nullptr;
+	DestroyExrLoader(tw);
+	if (tw->exrPreview) {
+		Image_Destroy(tw->exrPreview);
+		tw->exrPreview = nullptr;
+	}
+
+	if (tw->sharedTexture) {
+		TextureRegistry_Release(renderer, tw->sharedTexture);
+		tw->sharedTexture = nullptr;
+		tw->textureToView.cpu = nullptr;
+		tw->textureToView.gpu = {};
+	}
+
 	if (tw->textureToView.cpu != nullptr) {
 		Image_Destroy(tw->textureToView.cpu);
 		tw->textureToView.cpu = nullptr;
 	}
 
-	Render_TextureDestroy(renderer, tw->textureToView.gpu);
+	FramesInFlight_DestroyTexture(renderer, tw->textureToView.gpu);
+	tw->textureToView.gpu = {};
+}
+
+// culled windows give back what they can, today thats paged slices
+static void TextureResidencyCallback(void *userData, TextureViewer_Texture *texture, bool visible) {
+	if (visible) {
+		SlicePager_Resume(texture->pager);
+	} else {
+		SlicePager_Suspend(texture->pager);
+	}
+}
+
+// how many texels apart the preview samples, 1 if it isn't needed
+static uint32_t ExrPreviewStep(Image_ImageHeader const *image) {
+	uint32_t const longSide = image->width > image->height ? image->width : image->height;
+	return (longSide + EXR_PREVIEW_SIZE - 1) / EXR_PREVIEW_SIZE;
+}
+
+// every step'th texel of the decode so far, the viewer samples with normalised
+// coordinates so the smaller texture covers the same area
+static void SampleExrPreview(TextureWindow *tw) {
+	Image_ImageHeader const *cpu = tw->textureToView.cpu;
+	Image_ImageHeader *preview = tw->exrPreview;
+	uint32_t const step = ExrPreviewStep(cpu);
+	size_t const texelBytes = TinyImageFormat_BitSizeOfBlock(cpu->format) / 8;
+	auto src = (uint8_t const *) Image_RawDataPtr(cpu);
+	auto dst = (uint8_t *) Image_RawDataPtr(preview);
+	for (uint32_t y = 0; y < preview->height; ++y) {
+		uint8_t const *srcLine = src + ((size_t) y * step * cpu->width * texelBytes);
+		for (uint32_t x = 0; x < preview->width; ++x) {
+			memcpy(dst, srcLine + ((size_t) x * step * texelBytes), texelBytes);
+			dst += texelBytes;
+		}
+	}
+}
+
+// a new texture each time, the one the last frame drew with is retired not destroyed
+static void UploadExr(TextureWindow *tw) {
+	FramesInFlight_DestroyTexture(renderer, tw->textureToView.gpu);
+
+	Image_ImageHeader const *image = tw->textureToView.cpu;
+	if (tw->exrPreview) {
+		SampleExrPreview(tw);
+		image = tw->exrPreview;
+	}
+	Render_TextureCreateDesc createGPUDesc{
+			image->format,
+			Render_TUF_SHADER_READ,
+			image->width,
+			image->height,
+			1,
+			1,
+			1,
+			0,
+			0,
+			(unsigned char *) Image_RawDataPtr(image),
+	};
+	// chunks still landing may tear the odd block, the next upload fixes it
+	tw->textureToView.gpu = Render_TextureSyncCreate(renderer, &createGPUDesc);
+}
+
+// (re)starts decoding with the loaders current channel selection
+static bool StartExrDecode(TextureWindow *tw) {
+	ExrLoader_Cancel(tw->exr);
+	TexelFetch_Destroy(tw->textureToView.fetcher);
+	tw->textureToView.fetcher = nullptr;
+	// only the default channels are shared, any other pick is this windows own
+	if (tw->sharedTexture) {
+		TextureRegistry_Release(renderer, tw->sharedTexture);
+		tw->sharedTexture = nullptr;
+		tw->textureToView.cpu = nullptr;
+		tw->textureToView.gpu = {};
+	}
+	FramesInFlight_DestroyTexture(renderer, tw->textureToView.gpu);
+	tw->textureToView.gpu = {};
+	if (tw->textureToView.cpu) {
+		Image_Destroy(tw->textureToView.cpu);
+	}
+	if (tw->exrPreview) {
+		Image_Destroy(tw->exrPreview);
+		tw->exrPreview = nullptr;
+	}
+
+	tw->textureToView.cpu = ExrLoader_Start(tw->exr);
+	if (!tw->textureToView.cpu) {
+		return false;
+	}
+	if (!Render_RendererCanShaderReadFrom(renderer, tw->textureToView.cpu->format)) {
+		ExrLoader_Cancel(tw->exr);
+		Image_Destroy(tw->textureToView.cpu);
+		tw->textureToView.cpu = nullptr;
+		return false;
+	}
+
+	// the decoded halfs/floats are the stored values, chunks still to land read as zero
+	tw->textureToView.fetcher = TexelFetch_Create(tw->textureToView.cpu, false);
+	uint32_t const step = ExrPreviewStep(tw->textureToView.cpu);
+	if (step > 1) {
+		tw->exrPreview = Image_Create((tw->textureToView.cpu->width + step - 1) / step,
+																	(tw->textureToView.cpu->height + step - 1) / step,
+																	1,
+																	1,
+																	tw->textureToView.cpu->format);
+	}
+	tw->exrUploadedChunks = 0;
+	tw->exrLastUploadUs = Os_GetUSec();
+	UploadExr(tw);
+	return true;
+}
+
+// shows content from the registry
+static void ShowSharedExr(TextureWindow *tw, TextureRegistry_EntryHandle entry) {
+	TextureLoad_Decoded *decoded = TextureRegistry_DecodedOf(entry);
+	tw->sharedTexture = entry;
+	if (!Render_TextureHandleIsValid(decoded->gpu)) {
+		decoded->gpu = TextureLoad_CreateGpu(renderer, decoded->image, tw->filePath);
+	}
+	tw->textureToView.cpu = decoded->image;
+	tw->textureToView.gpu = decoded->gpu;
+	tw->textureToView.fetcher = TexelFetch_Create(decoded->image, false);
+}
+
+// the default channels have all landed, so they are the files content as far as
+// the registry cares and later opens of the same bytes skip the decode
+static void PublishExr(TextureWindow *tw) {
+	TextureLoad_Decoded decoded{};
+	decoded.contentHash = tw->exrContentHash;
+	decoded.contentSize = ExrLoader_FileSize(tw->exr);
+	decoded.image = tw->textureToView.cpu;
+	decoded.originalFormat = tw->textureToView.cpu->format;
+	decoded.gpuNative = true;
+	decoded.gpu = tw->textureToView.gpu;
+
+	TexelFetch_Destroy(tw->textureToView.fetcher);
+	tw->textureToView.fetcher = nullptr;
+	tw->textureToView.cpu = nullptr;
+	tw->textureToView.gpu = {};
+
+	// if the same content was published whilst this decoded, ours is dropped for it
+	TextureRegistry_EntryHandle entry = TextureRegistry_Add(renderer, &decoded);
+	if (!entry) {
+		LOGERROR("TextureRegistry_Add failed for %s", tw->filePath);
+		return;
+	}
+	ShowSharedExr(tw, entry);
+	DestroyExrLoader(tw);
+}
+
+// true if the texture changed
+static bool UpdateExrDecode(TextureWindow *tw) {
+	if (!tw->exr) {
+		return false;
+	}
+	if (tw->exrRestart) {
+		tw->exrRestart = false;
+		StartExrDecode(tw);
+		return true;
+	}
+
+	// complete is read first so if its set every chunk is in the upload
+	bool const complete = ExrLoader_IsComplete(tw->exr);
+	uint32_t const done = ExrLoader_ChunksDone(tw->exr);
+	if (done == tw->exrUploadedChunks) {
+		return false;
+	}
+	int64_t const now = Os_GetUSec();
+	if (!complete && now - tw->exrLastUploadUs < EXR_UPLOAD_PERIOD_US) {
+		return false;
+	}
+
+	tw->exrUploadedChunks = done;
+	tw->exrLastUploadUs = now;
+	if (complete && tw->exrPreview) {
+		Image_Destroy(tw->exrPreview);
+		tw->exrPreview = nullptr;
+	}
+	UploadExr(tw);
+	if (complete && ExrLoader_IsDefaultSelection(tw->exr)) {
+		PublishExr(tw);
+	}
+	return true;
+}
 
+static void ExrChannelUI(void *userData, TextureViewer_Texture *texture) {
+	auto tw = (TextureWindow *) userData;
+	// windows showing the registrys copy read the file again only if asked to
+	if (!tw->exr) {
+		if (ImGui::Button("Pick channels")) {
+			tw->exrArena = ScratchArena_Create(MemoryPanel_LoadAllocator(), LOAD_ARENA_BLOCK_SIZE);
+			tw->exr = ExrLoader_Open(tw->filePath, taskScheduler, ScratchArena_Allocator(tw->exrArena));
+			if (!tw->exr) {
+				DestroyExrLoader(tw);
+				LOGINFO("%s isn't an EXR the chunked loader takes, no channels to pick", tw->filePath);
+				TextureViewer_SetExtraUICallback(tw->textureViewer, nullptr, nullptr);
+			}
+		}
+		return;
+	}
+	if (ExrLoader_DrawChannelUI(tw->exr)) {
+		tw->exrRestart = true;
+	}
+}
+
+static int uniqueHiddenNumber = 0;
+static const size_t WindowNameSize = 2048;
+
+// returns where the file name starts
+static size_t RememberPath(char const *fileName, TextureWindow *tw) {
 	size_t startOfFileName = 0;
 	size_t startOfFileNameExt = 0;
 
@@ -80,93 +420,230 @@ static void LoadTextureToView(char const *fileName, TextureWindow *tw) {
 	lastFolder = (char *) MEMORY_CALLOC(startOfFileName + 1, 1);
 	memcpy(lastFolder, fileName, startOfFileName);
 
-	VFile_Handle fh = VFile_FromFile(fileName, Os_FM_ReadBinary);
-	if (!fh) {
-		LOGINFO("Load From File failed for %s", fileName);
-		return;
+	MEMORY_FREE(tw->filePath);
+	tw->filePath = (char *) MEMORY_CALLOC(strlen(fileName) + 1, 1);
+	memcpy(tw->filePath, fileName, strlen(fileName));
+
+	return startOfFileName;
+}
+
+// decodes progressively with the loader, which the window takes along with the arena
+// its memory came from. False (and both destroyed) if the gpu can't sample what it makes
+static bool ShowExr(TextureWindow *tw,
+										ExrLoaderHandle exr,
+										ScratchArenaHandle arena,
+										TextureLoad_File const *file,
+										TextureLoad_Stats *stats) {
+	tw->exr = exr;
+	tw->exrArena = arena;
+	tw->exrContentHash = file->contentHash;
+	if (!StartExrDecode(tw)) {
+		DestroyExrLoader(tw);
+		return false;
 	}
+	TextureLoad_StatsImageCreated(stats, tw->textureToView.cpu);
+	TextureViewer_SetExtraUICallback(tw->textureViewer, &ExrChannelUI, tw);
 
-	tw->textureToView.cpu = Image_Load(fh);
-	VFile_Close(fh);
-	if (!tw->textureToView.cpu) {
-		LOGINFO("Image_Load failed for %s", fileName);
+	size_t startOfFileName = 0;
+	size_t startOfFileNameExt = 0;
+	Os_SplitPath(tw->filePath, &startOfFileName, &startOfFileNameExt);
+	char tmpbuffer[WindowNameSize];
+	snprintf(tmpbuffer, WindowNameSize, "%s - %ix%i - %s - EXR ###%i", tw->filePath + startOfFileName,
+					 tw->textureToView.cpu->width,
+					 tw->textureToView.cpu->height,
+					 TinyImageFormat_Name(tw->textureToView.cpu->format),
+					 tw->windowId
+	);
+	TextureViewer_SetWindowName(tw->textureViewer, tmpbuffer);
+	TextureViewer_SetZoom(tw->textureViewer, 768.0f / tw->textureToView.cpu->width);
+	return true;
+}
+
+// takes the windows reference to entry, uploads if no other window has yet
+static void ShowSharedTexture(char const *fileName,
+															size_t startOfFileName,
+															TextureWindow *tw,
+															TextureRegistry_EntryHandle entry) {
+	TextureLoad_Decoded *decoded = TextureRegistry_DecodedOf(entry);
+	tw->sharedTexture = entry;
+	tw->textureToView.cpu = decoded->image;
+
+	// converted images that kept their original (block compressed, or any with
+	// --exact-readout) read that, otherwise the converted cpu copy
+	tw->textureToView.fetcher = TexelFetch_Create(decoded->source ? decoded->source : decoded->image, false);
+
+	char tmpbuffer[WindowNameSize];
+	snprintf(tmpbuffer, WindowNameSize, "%s - %ix%i - %s - %s ###%i", fileName + startOfFileName,
+					tw->textureToView.cpu->width,
+					tw->textureToView.cpu->height,
+					TinyImageFormat_Name(decoded->originalFormat),
+					decoded->paged ? "PAGED" : (decoded->gpuNative ? "GPU" : "CPU"),
+					tw->windowId
+	);
+
+	TextureViewer_SetWindowName(tw->textureViewer, tmpbuffer);
+	TextureViewer_SetZoom(tw->textureViewer, 768.0f / tw->textureToView.cpu->width);
+
+	// each window pages its own slices, they follow that windows view
+	if (decoded->paged) {
+		tw->textureToView.pager = SlicePager_Create(renderer,
+																								taskScheduler,
+																								tw->textureToView.cpu,
+																								SLICE_PAGER_RING_SIZE);
+		if (!tw->textureToView.pager) {
+			LOGINFO("SlicePager_Create failed for %s", fileName);
+			ReleaseTextureToView(tw);
+		}
 		return;
 	}
 
-	TinyImageFormat originalFormat = tw->textureToView.cpu->format;
-	bool supported = Render_RendererCanShaderReadFrom(renderer, tw->textureToView.cpu->format);
+	if (!Render_TextureHandleIsValid(decoded->gpu)) {
+		decoded->gpu = TextureLoad_CreateGpu(renderer, decoded->image, fileName + startOfFileName);
+	}
+	tw->textureToView.gpu = decoded->gpu;
+}
 
-	// force CPU for testing
-	// supported = false;
+// shared EXRs keep the channel picker, it opens the file again if its used
+static void ShowSharedFile(char const *fileName,
+													 size_t startOfFileName,
+													 TextureWindow *tw,
+													 TextureRegistry_EntryHandle entry,
+													 TextureLoad_File const *file,
+													 bool exrFile) {
+	ShowSharedTexture(fileName, startOfFileName, tw, entry);
+	if (exrFile && tw->textureToView.cpu) {
+		tw->exrContentHash = file->contentHash;
+		TextureViewer_SetExtraUICallback(tw->textureViewer, &ExrChannelUI, tw);
+	}
+}
 
-	if (!supported) {
-		// convert to R8G8B8A8 for now
-		if (!TinyImageFormat_IsCompressed(tw->textureToView.cpu->format)) {
-			Image_ImageHeader const *converted = tw->textureToView.cpu;
-			if (TinyImageFormat_IsSigned(tw->textureToView.cpu->format)) {
-				converted = Image_FastConvert(tw->textureToView.cpu, TinyImageFormat_R8G8B8A8_SNORM, true);
-			} else {
-				converted = Image_FastConvert(tw->textureToView.cpu, TinyImageFormat_R8G8B8A8_UNORM, true);
-			}
-			if (converted != tw->textureToView.cpu) {
-				Image_Destroy(tw->textureToView.cpu);
-				tw->textureToView.cpu = converted;
-			}
-		} else {
-			Image_ImageHeader const *converted = tw->textureToView.cpu;
-			converted = Image_Decompress(tw->textureToView.cpu);
-			if (converted == nullptr || converted == tw->textureToView.cpu) {
-				LOGINFO("%s with format %s isn't supported by this GPU/backend and can't be converted",
-								fileName,
-								TinyImageFormat_Name(tw->textureToView.cpu->format));
-				Image_Destroy(tw->textureToView.cpu);
-				tw->textureToView.cpu = nullptr;
+static void RecordScratchStats(TextureLoad_Stats *stats, ScratchArenaHandle arena) {
+	ScratchArena_Stats arenaStats{};
+	ScratchArena_GetStats(arena, &arenaStats);
+	stats->scratchAllocations = arenaStats.allocationCount;
+	stats->peakScratchBytes = arenaStats.peakBytes;
+}
+
+// hashes the file then shares it if the content is already open, else EXRs the chunked
+// loader takes decode progressively and everything else decodes here
+static void LoadTextureToViewWithStats(char const *fileName, TextureWindow *tw, TextureLoad_Stats *stats) {
+	ReleaseTextureToView(tw);
+	TextureViewer_SetExtraUICallback(tw->textureViewer, nullptr, nullptr);
+	size_t const startOfFileName = RememberPath(fileName, tw);
+
+	ScratchArenaHandle arena = ScratchArena_Create(MemoryPanel_LoadAllocator(), LOAD_ARENA_BLOCK_SIZE);
+	TextureLoad_File file;
+	bool const readOk = TextureLoad_HashFile(fileName, ScratchArena_Allocator(arena), &file);
+	ScratchArena_Reset(arena);
+	RecordScratchStats(stats, arena);
+	if (!readOk) {
+		ScratchArena_Destroy(arena);
+		return;
+	}
+	bool const exrFile = ExrLoader_IsExr(fileName);
+	TextureRegistry_EntryHandle entry = TextureRegistry_Acquire(file.contentHash, file.size);
+	if (!entry && exrFile) {
+		ExrLoaderHandle exr = ExrLoader_Open(fileName, taskScheduler, ScratchArena_Allocator(arena));
+		RecordScratchStats(stats, arena);
+		if (exr) {
+			bool const shown = ShowExr(tw, exr, arena, &file, stats);
+			arena = nullptr;
+			if (shown) {
 				return;
-			} else {
-				Image_Destroy(tw->textureToView.cpu);
-				tw->textureToView.cpu = converted;
 			}
 		}
 	}
-
-	if (Image_MipMapCountOf(tw->textureToView.cpu) > 1) {
-		Image_ImageHeader const *packed = Image_PackMipmaps(tw->textureToView.cpu);
-		if (tw->textureToView.cpu != packed) {
-			Image_Destroy(tw->textureToView.cpu);
-			tw->textureToView.cpu = packed;
+	ScratchArena_Destroy(arena);
+	if (!entry) {
+		TextureLoad_Decoded decoded;
+		if (TextureLoad_DecodeHashedFile(renderer, taskScheduler, fileName, &file, stats, &decoded)) {
+			entry = TextureRegistry_Add(renderer, &decoded);
 		}
-		ASSERT(Image_HasPackedMipMaps(tw->textureToView.cpu));
 	}
+	if (entry) {
+		ShowSharedFile(fileName, startOfFileName, tw, entry, &file, exrFile);
+	}
+}
 
-	static int uniqueHiddenNumber = 0;
+static void LogLoadStats(char const *fileName, TextureLoad_Stats const *stats) {
+	LOGINFO("%s: %u image allocations peaking at %.2f MB, %llu scratch allocations peaking at %.2f MB",
+					fileName,
+					stats->imageAllocations,
+					(double) stats->peakImageBytes / (1024.0 * 1024.0),
+					(unsigned long long) stats->scratchAllocations,
+					(double) stats->peakScratchBytes / (1024.0 * 1024.0));
+}
 
-	char tmpbuffer[2048];
-	sprintf(tmpbuffer, "%s - %ix%i - %s - %s ##%i", fileName + startOfFileName,
-					tw->textureToView.cpu->width,
-					tw->textureToView.cpu->height,
-					TinyImageFormat_Name(originalFormat),
-					supported ? "GPU" : "CPU",
-					uniqueHiddenNumber++
-	);
+static void LoadTextureToView(char const *fileName, TextureWindow *tw) {
+	TextureLoad_Stats stats{};
+	LoadTextureToViewWithStats(fileName, tw, &stats);
+	LogLoadStats(fileName, &stats);
+}
+
+static void FlipbookUI(void *userData, TextureViewer_Texture *texture) {
+	auto tw = (TextureWindow *) userData;
+	Flipbook_DrawUI(tw->flipbook);
+}
 
+// false if the file isn't part of a numbered sequence
+static bool LoadSequenceToView(char const *fileName, TextureWindow *tw) {
+	ReleaseTextureToView(tw);
+	TextureViewer_SetExtraUICallback(tw->textureViewer, nullptr, nullptr);
+
+	tw->flipbook = Flipbook_Create(renderer, taskScheduler, fileName, FLIPBOOK_RING_SIZE);
+	if (!tw->flipbook) {
+		return false;
+	}
+	size_t const startOfFileName = RememberPath(fileName, tw);
+	Flipbook_Update(tw->flipbook, 0.0, &tw->textureToView);
+	TextureViewer_SetExtraUICallback(tw->textureViewer, &FlipbookUI, tw);
+
+	char tmpbuffer[WindowNameSize];
+	snprintf(tmpbuffer, WindowNameSize, "%s - %ix%i - SEQUENCE of %u ###%i", fileName + startOfFileName,
+					 tw->textureToView.cpu->width,
+					 tw->textureToView.cpu->height,
+					 Flipbook_FrameCount(tw->flipbook),
+					 tw->windowId
+	);
 	TextureViewer_SetWindowName(tw->textureViewer, tmpbuffer);
 	TextureViewer_SetZoom(tw->textureViewer, 768.0f / tw->textureToView.cpu->width);
+	return true;
+}
 
-	Render_TextureCreateDesc createGPUDesc{
-			tw->textureToView.cpu->format,
-			Render_TUF_SHADER_READ,
-			tw->textureToView.cpu->width,
-			tw->textureToView.cpu->height,
-			tw->textureToView.cpu->depth,
-			tw->textureToView.cpu->slices,
-			(uint32_t) Image_MipMapCountOf(tw->textureToView.cpu),
-			0,
-			0,
-			(unsigned char *) Image_RawDataPtr(tw->textureToView.cpu),
-			fileName + startOfFileName,
-	};
+static void OpenContactSheet() {
+	if (!contactSheet) {
+		contactSheet = ContactSheet_Create(renderer, frameBuffer, taskScheduler);
+		if (!contactSheet) {
+			LOGERROR("ContactSheet_Create failed");
+			return;
+		}
+	}
 
-	tw->textureToView.gpu = Render_TextureSyncCreate(renderer, &createGPUDesc);
+	uint32_t const count = (uint32_t) CADT_VectorSize(textureWindows);
+	auto images = (Image_ImageHeader const **) MEMORY_CALLOC(count, sizeof(Image_ImageHeader const *));
+	auto names = (char const **) MEMORY_CALLOC(count, sizeof(char const *));
+	if (!images || !names) {
+		MEMORY_FREE(names);
+		MEMORY_FREE(images);
+		return;
+	}
+
+	for (auto i = 0u; i < count; ++i) {
+		auto textureWindow = *(TextureWindow **) CADT_VectorAt(textureWindows, i);
+		size_t startOfFileName = 0;
+		size_t startOfFileNameExt = 0;
+		Os_SplitPath(textureWindow->filePath, &startOfFileName, &startOfFileNameExt);
+		images[i] = textureWindow->textureToView.cpu;
+		names[i] = textureWindow->filePath + startOfFileName;
+	}
+
+	if (!ContactSheet_Build(contactSheet, count, images, names)) {
+		LOGERROR("ContactSheet_Build failed");
+	}
+
+	MEMORY_FREE(names);
+	MEMORY_FREE(images);
+	Redraw_MarkDirty();
 }
 
 // Note that shortcuts are currently provided for display only (future version will add flags to BeginMenu to process shortcuts)
@@ -180,29 +657,310 @@ static void ShowMenuFile() {
 		}
 
 	}
+	if (ImGui::MenuItem("Open sequence")) {
+		char *fileName;
+		if (NativeFileDialogs_Load("ktx,dds,exr,hdr,jpg,jpeg,png,tga,bmp,psd,gif,pic,pnm,ppm,basis",
+															 lastFolder, &fileName)) {
+			LoadSequence(fileName);
+			MEMORY_FREE(fileName);
+		}
+	}
+	if (ImGui::MenuItem("Next in folder", "PgDn", false, navWindow != nullptr)) {
+		navStep = 1;
+	}
+	if (ImGui::MenuItem("Previous in folder", "PgUp", false, navWindow != nullptr)) {
+		navStep = -1;
+	}
+	if (ImGui::MenuItem("Contact sheet of open textures", nullptr, false, !CADT_VectorIsEmpty(textureWindows))) {
+		OpenContactSheet();
+	}
 	ImGui::Separator();
 	if (ImGui::MenuItem("Quit", "Alt+F4")) {
 		GameAppShell_Quit();
 	}
 }
 
+// swaps the last window into the hole so closing doesn't search or shuffle the registry
+static void RemoveTextureWindow(TextureWindow *textureWindow) {
+	ASSERT(textureWindow->registryIndex < CADT_VectorSize(textureWindows));
+
+	TextureWindow *lastWindow;
+	CADT_VectorPopElement(textureWindows, &lastWindow);
+	if (lastWindow != textureWindow) {
+		*(TextureWindow **) CADT_VectorAt(textureWindows, textureWindow->registryIndex) = lastWindow;
+		lastWindow->registryIndex = textureWindow->registryIndex;
+	}
+}
+
+static TextureWindow *CreateTextureWindow() {
+	auto textureWindow = (TextureWindow *) CADT_FreeListAlloc(textureWindowFreeList);
+	if (!textureWindow) {
+		return nullptr;
+	}
+	textureWindow->textureViewer = TextureViewer_Create(renderer, frameBuffer);
+	if (!textureWindow->textureViewer) {
+		CADT_FreeListRelease(textureWindowFreeList, textureWindow);
+		LOGERROR("TextureViewer_Create failed");
+		return nullptr;
+	}
+	memset(&textureWindow->textureToView, 0, sizeof(TextureViewer_Texture));
+	textureWindow->filePath = nullptr;
+	textureWindow->windowId = uniqueHiddenNumber++;
+	textureWindow->exr = nullptr;
+	textureWindow->exrArena = nullptr;
+	textureWindow->exrPreview = nullptr;
+	textureWindow->exrRestart = false;
+	textureWindow->exrContentHash = 0;
+	textureWindow->flipbook = nullptr;
+	textureWindow->sharedTexture = nullptr;
+	textureWindow->benchmarkIndex = -1;
+	TextureViewer_SetResidencyCallback(textureWindow->textureViewer, &TextureResidencyCallback, textureWindow);
+	return textureWindow;
+}
+
+static void AddTextureWindow(TextureWindow *textureWindow) {
+	textureWindow->registryIndex = (uint32_t) CADT_VectorSize(textureWindows);
+	CADT_VectorPushElement(textureWindows, &textureWindow);
+	Redraw_MarkDirty();
+}
+
+static void DestroyTextureWindow(TextureWindow *textureWindow) {
+	TextureViewer_Destroy(textureWindow->textureViewer);
+	textureWindow->textureViewer = nullptr;
+	ReleaseTextureToView(textureWindow);
+	MEMORY_FREE(textureWindow->filePath);
+	textureWindow->filePath = nullptr;
+	CADT_FreeListRelease(textureWindowFreeList, textureWindow);
+}
+
+static void PendingLoadTask(uint32_t start, uint32_t end, uint32_t threadnum, void *args) {
+	auto load = (PendingLoad *) args;
+	char const *fileName = load->textureWindow->filePath;
+	Memory_Allocator *allocator = ScratchArena_Allocator(load->arena);
+	if (load->stage == PLS_READING) {
+		load->readOk = TextureLoad_HashFile(fileName, allocator, &load->file);
+		load->exrFile = load->readOk && ExrLoader_IsExr(fileName);
+		ScratchArena_Reset(load->arena);
+		RecordScratchStats(&load->stats, load->arena);
+		Redraw_MarkDirty();
+		return;
+	}
+	// the chunked loader only reads the file here, decoding starts once its shown
+	if (load->exrFile) {
+		load->exr = ExrLoader_Open(fileName, taskScheduler, allocator);
+		RecordScratchStats(&load->stats, load->arena);
+		if (load->exr) {
+			Redraw_MarkDirty();
+			return;
+		}
+		ScratchArena_Reset(load->arena);
+	}
+	load->decodedOk = TextureLoad_DecodeHashedFile(renderer, taskScheduler, fileName, &load->file,
+																								 &load->stats, &load->decoded);
+	Redraw_MarkDirty();
+}
+
+static void RunPendingLoad(PendingLoad *load) {
+	if (load->task) {
+		enkiAddTaskSetToPipe(taskScheduler, load->task, load, 1);
+	} else {
+		PendingLoadTask(0, 1, 0, load);
+	}
+}
+
+static void StartPendingLoad(TextureWindow *textureWindow) {
+	auto load = (PendingLoad *) MEMORY_CALLOC(1, sizeof(PendingLoad));
+	if (!load) {
+		DestroyTextureWindow(textureWindow);
+		return;
+	}
+	load->textureWindow = textureWindow;
+	load->stage = PLS_READING;
+	load->arena = ScratchArena_Create(MemoryPanel_LoadAllocator(), LOAD_ARENA_BLOCK_SIZE);
+	load->task = enkiCreateTaskSet(taskScheduler, &PendingLoadTask);
+	RunPendingLoad(load);
+	CADT_VectorPushElement(pendingLoads, &load);
+}
+
+// true once the load has hashed its file and either found its content already open or
+// decoded it. Only the hash is paid for content thats already open
+static bool AdvancePendingLoad(PendingLoad *load) {
+	if (load->task && !enkiIsTaskSetComplete(taskScheduler, load->task)) {
+		return false;
+	}
+	if (load->stage == PLS_READING && load->readOk) {
+		load->shared = TextureRegistry_Acquire(load->file.contentHash, load->file.size);
+		if (!load->shared) {
+			load->stage = PLS_DECODING;
+			RunPendingLoad(load);
+			if (load->task) {
+				return false;
+			}
+		}
+	}
+	if (load->exr) {
+		ExrLoaderHandle exr = load->exr;
+		ScratchArenaHandle arena = load->arena;
+		load->exr = nullptr;
+		load->arena = nullptr;
+		if (!ShowExr(load->textureWindow, exr, arena, &load->file, &load->stats)) {
+			// the gpu can't sample the loaders output, convert it like any other file
+			load->exrFile = false;
+			RunPendingLoad(load);
+			if (load->task) {
+				return false;
+			}
+		}
+	}
+	if (load->decodedOk) {
+		load->decodedOk = false;
+		load->shared = TextureRegistry_Add(renderer, &load->decoded);
+	}
+	return true;
+}
+
+static void FinishPendingLoad(PendingLoad *load) {
+	TextureWindow *textureWindow = load->textureWindow;
+	char const *fileName = textureWindow->filePath;
+	size_t startOfFileName = 0;
+	size_t startOfFileNameExt = 0;
+	Os_SplitPath(fileName, &startOfFileName, &startOfFileNameExt);
+
+	if (load->shared) {
+		ShowSharedFile(fileName, startOfFileName, textureWindow, load->shared, &load->file, load->exrFile);
+		load->shared = nullptr;
+	}
+	LogLoadStats(fileName, &load->stats);
+
+	if (textureWindow->textureToView.cpu) {
+		AddTextureWindow(textureWindow);
+	} else {
+		DestroyTextureWindow(textureWindow);
+	}
+}
+
+// true if any load landed. Landed loads are shown in the order they were asked for
+static bool UpdatePendingLoads() {
+	bool landed = false;
+	while (!CADT_VectorIsEmpty(pendingLoads)) {
+		auto load = *(PendingLoad **) CADT_VectorAt(pendingLoads, 0);
+		if (!AdvancePendingLoad(load)) {
+			break;
+		}
+		if (load->task) {
+			enkiDeleteTaskSet(load->task);
+		}
+		CADT_VectorRemove(pendingLoads, 0);
+		FinishPendingLoad(load);
+		ScratchArena_Destroy(load->arena);
+		MEMORY_FREE(load);
+		landed = true;
+	}
+	return landed;
+}
+
+// hashes and decodes on a worker and the window shows up when its done, EXRs the
+// chunked loader takes show up once read and fill in as they decode
 void LoadTexture(char const *fileName) {
 	if (fileName == nullptr) {
 		return;
 	}
 	char normalisedPath[2048];
 	Os_GetNormalisedPathFromPlatformPath(fileName, normalisedPath, 2048);
-	auto textureWindow = (TextureWindow *) CADT_FreeListAlloc(textureWindowFreeList);
+	auto textureWindow = CreateTextureWindow();
+	if (!textureWindow) {
+		return;
+	}
+
+	RememberPath(normalisedPath, textureWindow);
+	StartPendingLoad(textureWindow);
+}
+
+// plays the numbered sequence fileName is part of, or opens it as a still if it isn't
+void LoadSequence(char const *fileName) {
+	if (fileName == nullptr) {
+		return;
+	}
+	char normalisedPath[2048];
+	Os_GetNormalisedPathFromPlatformPath(fileName, normalisedPath, 2048);
+	auto textureWindow = CreateTextureWindow();
 	if (textureWindow) {
-		textureWindow->textureViewer = TextureViewer_Create(renderer, frameBuffer);
-		if (!textureWindow->textureViewer) {
-			CADT_FreeListRelease(textureWindowFreeList, textureWindow);
-			LOGERROR("TextureViewer_Create failed");
+		if (!LoadSequenceToView(normalisedPath, textureWindow)) {
+			LOGINFO("%s isn't part of a numbered sequence, opening it on its own", normalisedPath);
+			LoadTextureToView(normalisedPath, textureWindow);
+		}
+		AddTextureWindow(textureWindow);
+	}
+}
+
+// puts fileName in the window, prefetched if the browser has it else loaded as any open is
+static bool SwapInFile(TextureWindow *tw, char const *fileName) {
+	TextureLoad_Stats stats{};
+	TextureLoad_Decoded decoded{};
+	bool const prefetched = FolderBrowser_Take(folderBrowser, fileName, &decoded);
+	if (prefetched) {
+		ReleaseTextureToView(tw);
+		TextureViewer_SetExtraUICallback(tw->textureViewer, nullptr, nullptr);
+		size_t const startOfFileName = RememberPath(fileName, tw);
+		// if its content is already open the prefetch is dropped and that shared instead
+		TextureRegistry_EntryHandle entry = TextureRegistry_Add(renderer, &decoded);
+		if (entry) {
+			ShowSharedTexture(fileName, startOfFileName, tw, entry);
+		}
+	} else {
+		LoadTextureToViewWithStats(fileName, tw, &stats);
+		LogLoadStats(fileName, &stats);
+	}
+	return tw->textureToView.cpu != nullptr;
+}
+
+// replaces the windows texture with the next (step 1) or previous (-1) viewable file
+// in its folder, skipping files that won't load, then prefetches further along
+static void StepInFolder(TextureWindow *tw, int step) {
+	if (!tw->filePath) {
+		return;
+	}
+	if (!folderBrowser) {
+		folderBrowser = FolderBrowser_Create(renderer, taskScheduler, FOLDER_PREFETCH_BUDGET);
+		if (!folderBrowser) {
+			LOGERROR("FolderBrowser_Create failed");
 			return;
 		}
-		memset(&textureWindow->textureToView, 0, sizeof(TextureViewer_Texture));
-		LoadTextureToView(normalisedPath, textureWindow);
-		CADT_VectorPushElement(textureWindows, &textureWindow);
+	}
+
+	char startPath[MAX_INPUT_PATH_LENGTH];
+	char path[MAX_INPUT_PATH_LENGTH];
+	snprintf(startPath, MAX_INPUT_PATH_LENGTH, "%s", tw->filePath);
+	snprintf(path, MAX_INPUT_PATH_LENGTH, "%s", tw->filePath);
+	for (int tries = 0; tries < MAX_FOLDER_STEP_TRIES; ++tries) {
+		char const *next = FolderBrowser_Step(folderBrowser, path, step);
+		// all the way round without finding anything else
+		if (!next || strcmp(next, startPath) == 0) {
+			return;
+		}
+		snprintf(path, MAX_INPUT_PATH_LENGTH, "%s", next);
+		if (SwapInFile(tw, path)) {
+			FolderBrowser_Prefetch(folderBrowser, path, step);
+			Redraw_MarkDirty();
+			return;
+		}
+		LOGINFO("%s won't load, skipping it", path);
+	}
+}
+
+static void ShowMenuView() {
+	bool onDemand = !Redraw_IsContinuous();
+	if (ImGui::MenuItem("Render on demand", nullptr, &onDemand)) {
+		Redraw_SetContinuous(!onDemand);
+	}
+	if (ImGui::MenuItem("Idle stats")) {
+		Redraw_OpenStats();
+	}
+	if (ImGui::MenuItem("Memory")) {
+		MemoryPanel_Open();
+	}
+	if (ImGui::MenuItem("Frame timing")) {
+		FrameTiming_Open();
 	}
 }
 
@@ -212,6 +970,10 @@ static void ShowAppMainMenuBar() {
 			ShowMenuFile();
 			ImGui::EndMenu();
 		}
+		if (ImGui::BeginMenu("View")) {
+			ShowMenuView();
+			ImGui::EndMenu();
+		}
 		if (ImGui::Button("About")) {
 			About_Open();
 		}
@@ -220,6 +982,90 @@ static void ShowAppMainMenuBar() {
 	}
 }
 
+static void StartBenchmark() {
+	benchmark = Benchmark_Create(renderer, benchmarkTextures, BENCHMARK_FRAMES);
+	if (!benchmark) {
+		LOGERROR("Benchmark_Create failed");
+		g_returnCode = 1;
+		GameAppShell_Quit();
+		return;
+	}
+
+	for (uint32_t i = 0; i < Benchmark_TextureCount(benchmark); ++i) {
+		Image_ImageHeader const *image = Benchmark_CreateImage(benchmark, i);
+		if (!image) {
+			continue;
+		}
+		auto textureWindow = CreateTextureWindow();
+		if (!textureWindow) {
+			Image_Destroy(image);
+			break;
+		}
+
+		char name[256];
+		snprintf(name, sizeof(name), "benchmark %u %s", i, TinyImageFormat_Name(image->format));
+		RememberPath(name, textureWindow);
+		textureWindow->textureToView.cpu = image;
+		textureWindow->textureToView.gpu = TextureLoad_CreateGpu(renderer, image, name);
+		textureWindow->benchmarkIndex = (int32_t) i;
+		snprintf(name, sizeof(name), "benchmark %u - %ix%ix%i - %s ###%i", i,
+						 image->width, image->height, image->slices,
+						 TinyImageFormat_Name(image->format),
+						 textureWindow->windowId);
+		TextureViewer_SetWindowName(textureWindow->textureViewer, name);
+		AddTextureWindow(textureWindow);
+	}
+
+	// every frame rendered and waited on so the GPU time is the frames own
+	Redraw_SetContinuous(true);
+	FrameTiming_SetMeasureGpu(true);
+}
+
+// windows are matched by benchmarkIndex, a skipped texture or a closed window moves the rest
+static void AnimateBenchmark() {
+	for (auto i = 0u; i < CADT_VectorSize(textureWindows); ++i) {
+		auto textureWindow = *(TextureWindow **) CADT_VectorAt(textureWindows, i);
+		if (textureWindow->benchmarkIndex < 0) {
+			continue;
+		}
+		Benchmark_View view;
+		Benchmark_Animate(benchmark, (uint32_t) textureWindow->benchmarkIndex, textureWindow->textureToView.cpu, &view);
+		TextureViewer_SetZoom(textureWindow->textureViewer, view.zoom);
+		if (view.autoMip) {
+			TextureViewer_SetAutoMip(textureWindow->textureViewer);
+		} else {
+			TextureViewer_SetMipLevel(textureWindow->textureViewer, view.mipLevel);
+		}
+		TextureViewer_SetSlice(textureWindow->textureViewer, view.slice);
+	}
+}
+
+// after present, true whilst the benchmark wants more frames
+static bool RecordFrameTiming() {
+	FrameTiming_EndFrame(graphicsQueue);
+
+	FrameTiming_BeginSample();
+	for (auto i = 0u; i < CADT_VectorSize(textureWindows); ++i) {
+		auto textureWindow = *(TextureWindow **) CADT_VectorAt(textureWindows, i);
+		int64_t encodeUs;
+		uint64_t screenPixels;
+		TextureViewer_GetTiming(textureWindow->textureViewer, &encodeUs, &screenPixels);
+
+		size_t startOfFileName = 0;
+		size_t startOfFileNameExt = 0;
+		Os_SplitPath(textureWindow->filePath, &startOfFileName, &startOfFileNameExt);
+		FrameTiming_AddRow(textureWindow->filePath + startOfFileName, encodeUs, screenPixels);
+		if (benchmark && textureWindow->benchmarkIndex >= 0) {
+			Benchmark_AddViewer(benchmark, (uint32_t) textureWindow->benchmarkIndex, encodeUs);
+		}
+	}
+
+	if (!benchmark) {
+		return true;
+	}
+	return Benchmark_AddFrame(benchmark, FrameTiming_LastCpuUs(), FrameTiming_LastGpuUs());
+}
+
 static bool Init() {
 
 #if AL2O3_PLATFORM == AL2O3_PLATFORM_APPLE_MAC
@@ -230,10 +1076,12 @@ static bool Init() {
 	LOGINFO(currentDir);
 #endif
 	// setup basic input and map quit key
+	StartupProfile_Phase("input");
 	input = InputBasic_Create();
 	uint32_t userIdBlk = InputBasic_AllocateUserIdBlock(input); // 1st 1000 id are the apps
 	ASSERT(userIdBlk == 0);
 
+	StartupProfile_Phase("renderer");
 	renderer = Render_RendererCreate(input);
 	if (!renderer) {
 		LOGERROR("Render_RendererCreate failed");
@@ -241,7 +1089,8 @@ static bool Init() {
 		return false;
 	}
 
-	taskScheduler = enkiNewTaskScheduler(&EnkiAlloc, &EnkiFree, &Memory_GlobalAllocator);
+	StartupProfile_Phase("task scheduler");
+	taskScheduler = enkiNewTaskScheduler(&EnkiAlloc, &EnkiFree, MemoryPanel_TrackingAllocator());
 
 	GameAppShell_WindowDesc windowDesc;
 	GameAppShell_WindowGetCurrentDesc(&windowDesc);
@@ -256,6 +1105,7 @@ static bool Init() {
 		InputBasic_MapToKey(input, AppKey_Quit, keyboard, InputBasic_Key_Escape);
 	}
 
+	StartupProfile_Phase("framebuffer");
 	Render_FrameBufferDesc fbDesc{};
 	fbDesc.platformHandle = GameAppShell_GetPlatformWindowPtr();
 	fbDesc.queue = graphicsQueue = Render_RendererGetPrimaryQueue(renderer, Render_QT_GRAPHICS);
@@ -266,24 +1116,121 @@ static bool Init() {
 	fbDesc.visualDebugTarget = true;
 	frameBuffer = Render_FrameBufferCreate(renderer, &fbDesc);
 
+	StartupProfile_Phase("app state");
 	static char const DefaultFolder[] = "";
 	lastFolder = (char *) MEMORY_CALLOC(strlen(DefaultFolder) + 1, 1);
 	memcpy(lastFolder, DefaultFolder, strlen(DefaultFolder));
 
 	textureWindowFreeList = CADT_FreeListCreate(sizeof(TextureWindow), MAX_TEXTURE_WINDOWS);
 	textureWindows = CADT_VectorCreate(sizeof(TextureWindow *));
+	pendingLoads = CADT_VectorCreate(sizeof(PendingLoad *));
 
-	while (!CADT_VectorIsEmpty(fileToOpenQueue)) {
-		char path[MAX_INPUT_PATH_LENGTH];
-		CADT_VectorPopElement(fileToOpenQueue, path);
-		LoadTexture(path);
+	// command line files are left queued, Update starts them after the first frame is up
+
+	// a wrong decode fails the run straight away so CI sees it in the exit code
+	if (bc6hBenchmark && !Bc6h_Benchmark(taskScheduler)) {
+		LOGERROR("BC6H known answer or scalar/SIMD check failed");
+		g_returnCode = 1;
+		GameAppShell_Quit();
+	}
+	if (benchmarkTextures) {
+		StartBenchmark();
+	}
+
+	if (singleInstance && !SingleInstance_Listen()) {
+		LOGINFO("Couldn't become the single instance, files opened elsewhere won't come here");
 	}
 
+	StartupProfile_Phase("first frame");
 	return true;
 }
 
+static void QueueFileToOpen(char const *path) {
+	// the queue holds fixed size elements, so copy into a full sized zeroed buffer
+	char element[MAX_INPUT_PATH_LENGTH] = {};
+	size_t const len = strlen(path);
+	if (len >= MAX_INPUT_PATH_LENGTH) {
+		LOGINFO("%s is too long a path to open", path);
+		return;
+	}
+	memcpy(element, path, len);
+	CADT_VectorPushElement(fileToOpenQueue, element);
+}
+
+static void ForwardedFileCallback(void *userData, char const *path) {
+	QueueFileToOpen(path);
+	Redraw_MarkDirty();
+}
+
+
+static void GatherMemoryUsage() {
+	MemoryPanel_BeginSample();
+
+	for (auto i = 0u; i < CADT_VectorSize(textureWindows); ++i) {
+		auto textureWindow = *(TextureWindow **) CADT_VectorAt(textureWindows, i);
+		TextureViewer_Texture const *texture = &textureWindow->textureToView;
+		if (!textureWindow->filePath) {
+			continue;
+		}
+
+		uint64_t cpuBytes = 0;
+		uint64_t gpuBytes = 0;
+		if (textureWindow->flipbook) {
+			Flipbook_MemoryUsage(textureWindow->flipbook, &cpuBytes, &gpuBytes);
+		} else if (textureWindow->sharedTexture) {
+			// each window showing the content is billed its share so the totals stay right
+			TextureLoad_Decoded const *decoded = TextureRegistry_DecodedOf(textureWindow->sharedTexture);
+			uint32_t const shares = TextureRegistry_RefCountOf(textureWindow->sharedTexture);
+			if (texture->pager) {
+				SlicePager_MemoryUsage(texture->pager, &cpuBytes, &gpuBytes);
+			} else if (Render_TextureHandleIsValid(texture->gpu)) {
+				gpuBytes = TextureBytes_OfImage(decoded->image) / shares;
+			}
+			cpuBytes += (TextureBytes_OfImage(decoded->image) + TextureBytes_OfImage(decoded->source)) / shares +
+					ExrLoader_MemoryUsage(textureWindow->exr) + TexelFetch_MemoryUsage(texture->fetcher);
+		} else if (texture->pager) {
+			SlicePager_MemoryUsage(texture->pager, &cpuBytes, &gpuBytes);
+			cpuBytes += TextureBytes_OfImage(texture->cpu) + TexelFetch_MemoryUsage(texture->fetcher);
+		} else if (textureWindow->exrPreview) {
+			gpuBytes = TextureBytes_OfImage(textureWindow->exrPreview);
+			cpuBytes = TextureBytes_OfImage(texture->cpu) + TextureBytes_OfImage(textureWindow->exrPreview) +
+					ExrLoader_MemoryUsage(textureWindow->exr) + TexelFetch_MemoryUsage(texture->fetcher);
+		} else if (Render_TextureHandleIsValid(texture->gpu)) {
+			// the gpu texture is created from the cpu image so has the same shape
+			gpuBytes = TextureBytes_OfImage(texture->cpu);
+			cpuBytes = TextureBytes_OfImage(texture->cpu) + ExrLoader_MemoryUsage(textureWindow->exr) +
+					TexelFetch_MemoryUsage(texture->fetcher);
+		}
+
+		size_t startOfFileName = 0;
+		size_t startOfFileNameExt = 0;
+		Os_SplitPath(textureWindow->filePath, &startOfFileName, &startOfFileNameExt);
+		MemoryPanel_AddRow(textureWindow->filePath + startOfFileName,
+											 cpuBytes,
+											 gpuBytes,
+											 TextureViewer_OverheadBytes(textureWindow->textureViewer));
+	}
+
+	if (contactSheet) {
+		uint64_t cpuBytes = 0;
+		uint64_t gpuBytes = 0;
+		ContactSheet_MemoryUsage(contactSheet, &cpuBytes, &gpuBytes);
+		MemoryPanel_AddRow("Contact sheet", 0, gpuBytes, cpuBytes);
+	}
+
+	if (folderBrowser) {
+		uint64_t cpuBytes = 0;
+		uint64_t gpuBytes = 0;
+		FolderBrowser_MemoryUsage(folderBrowser, &cpuBytes, &gpuBytes);
+		MemoryPanel_AddRow("Folder prefetch", cpuBytes, gpuBytes, 0);
+	}
+
+	MemoryPanel_EndSample();
+}
 
 static void Update(double deltaMS) {
+	FrameTiming_BeginFrame();
+
 	GameAppShell_WindowDesc windowDesc;
 	GameAppShell_WindowGetCurrentDesc(&windowDesc);
 
@@ -292,6 +1239,51 @@ static void Update(double deltaMS) {
 		GameAppShell_Quit();
 	}
 
+	// async work carries on whilst idle and wakes us when it lands
+	for (auto i = 0u; i < CADT_VectorSize(textureWindows); ++i) {
+		auto textureWindow = *(TextureWindow **) CADT_VectorAt(textureWindows, i);
+		if (SlicePager_Update(textureWindow->textureToView.pager)) {
+			Redraw_MarkDirty();
+		}
+		if (UpdateExrDecode(textureWindow)) {
+			Redraw_MarkDirty();
+		}
+		if (Flipbook_Update(textureWindow->flipbook, deltaMS, &textureWindow->textureToView)) {
+			Redraw_MarkDirty();
+		}
+	}
+
+	if (UpdatePendingLoads()) {
+		Redraw_MarkDirty();
+	}
+	if (ContactSheet_Update(contactSheet)) {
+		Redraw_MarkDirty();
+	}
+	FolderBrowser_Update(folderBrowser);
+
+	// textures change between frames, last frames draw may still point at the old one
+	if (navStep && navWindow) {
+		StepInFolder(navWindow, navStep);
+	}
+	navStep = 0;
+
+	// one queued file a frame so a big batch doesn't stall the UI, none until
+	// the first frame is up so startup isn't waiting on the command line
+	SingleInstance_Poll(&ForwardedFileCallback, nullptr);
+	if (StartupProfile_IsComplete() && !CADT_VectorIsEmpty(fileToOpenQueue)) {
+		char path[MAX_INPUT_PATH_LENGTH];
+		CADT_VectorPopElement(fileToOpenQueue, path);
+		LoadTexture(path);
+	}
+
+	if (MemoryPanel_SampleDue()) {
+		GatherMemoryUsage();
+	}
+
+	if (!Redraw_BeginFrame()) {
+		return;
+	}
+
 	Render_FrameBufferUpdate(frameBuffer,
 													 windowDesc.width, windowDesc.height,
 													 deltaMS);
@@ -299,10 +1291,22 @@ static void Update(double deltaMS) {
 	ImGui::NewFrame();
 
 	About_Display();
+	Redraw_DisplayStats();
+	MemoryPanel_Display();
+	FrameTiming_Display();
+
+	if (benchmark) {
+		AnimateBenchmark();
+	}
 
 	ShowAppMainMenuBar();
 
-	TextureWindow *toClose[MAX_TEXTURE_WINDOWS];
+	if (contactSheet && !ContactSheet_DrawUI(contactSheet)) {
+		ContactSheet_Destroy(contactSheet);
+		contactSheet = nullptr;
+	}
+
+	static TextureWindow *toClose[MAX_TEXTURE_WINDOWS];
 	uint32_t closeCount = 0;
 	for (auto i = 0u; i < CADT_VectorSize(textureWindows); ++i) {
 		auto textureWindow = *(TextureWindow **) CADT_VectorAt(textureWindows, i);
@@ -312,6 +1316,13 @@ static void Update(double deltaMS) {
 			bool keepOpen = TextureViewer_DrawUI(textureWindow->textureViewer, &textureWindow->textureToView);
 			if (!keepOpen) {
 				toClose[closeCount++] = textureWindow;
+			} else if (TextureViewer_IsFocused(textureWindow->textureViewer)) {
+				navWindow = textureWindow;
+				if (ImGui::IsKeyPressed(ImGui::GetKeyIndex(ImGuiKey_PageDown))) {
+					navStep = 1;
+				} else if (ImGui::IsKeyPressed(ImGui::GetKeyIndex(ImGuiKey_PageUp))) {
+					navStep = -1;
+				}
 			}
 		} else {
 			toClose[closeCount++] = textureWindow;
@@ -321,19 +1332,11 @@ static void Update(double deltaMS) {
 		auto textureWindow = (TextureWindow *) toClose[i];
 		ASSERT(textureWindow);
 
-		TextureViewer_Destroy(textureWindow->textureViewer);
-		textureWindow->textureViewer = nullptr;
-		if (textureWindow->textureToView.cpu) {
-			Image_Destroy(textureWindow->textureToView.cpu);
-			textureWindow->textureToView.cpu = nullptr;
+		if (navWindow == textureWindow) {
+			navWindow = nullptr;
 		}
-
-		Render_TextureDestroy(renderer, textureWindow->textureToView.gpu);
-
-		TextureViewer_Destroy(textureWindow->textureViewer);
-		textureWindow->textureViewer = nullptr;
-		CADT_VectorRemove(textureWindows, CADT_VectorFind(textureWindows, &textureWindow));
-		CADT_FreeListRelease(textureWindowFreeList, textureWindow);
+		RemoveTextureWindow(textureWindow);
+		DestroyTextureWindow(textureWindow);
 	}
 
 
@@ -346,6 +1349,9 @@ static void Update(double deltaMS) {
 }
 
 static void Draw(double deltaMS) {
+	if (!Redraw_IsFrameActive()) {
+		return;
+	}
 
 	Render_FrameBufferNewFrame(frameBuffer);
 
@@ -354,8 +1360,20 @@ static void Draw(double deltaMS) {
 		ASSERT(textureWindow);
 		TextureViewer_RenderSetup(textureWindow->textureViewer, Render_FrameBufferGraphicsEncoder(frameBuffer));
 	}
+	ContactSheet_RenderSetup(contactSheet, Render_FrameBufferGraphicsEncoder(frameBuffer));
 
 	Render_FrameBufferPresent(frameBuffer);
+	FramesInFlight_EndFrame();
+	StartupProfile_FirstFrame();
+
+	if (!RecordFrameTiming()) {
+		if (!Benchmark_WriteResults(benchmark, BENCHMARK_RESULTS_FILE)) {
+			g_returnCode = 1;
+		}
+		Benchmark_Destroy(benchmark);
+		benchmark = nullptr;
+		GameAppShell_Quit();
+	}
 }
 
 static void Resize() {
@@ -364,12 +1382,35 @@ static void Resize() {
 
 	Render_FrameBufferResize(frameBuffer, windowDesc.width, windowDesc.height);
 	InputBasic_SetWindowSize(input, windowDesc.width, windowDesc.height);
+
+	Redraw_MarkDirty();
 }
 
 
 static void Exit() {
 	LOGINFO("Exiting");
 
+	SingleInstance_Shutdown();
+
+	// loads still decoding have nowhere to go
+	while (!CADT_VectorIsEmpty(pendingLoads)) {
+		PendingLoad *load;
+		CADT_VectorPopElement(pendingLoads, &load);
+		if (load->task) {
+			enkiWaitForTaskSet(taskScheduler, load->task);
+			enkiDeleteTaskSet(load->task);
+		}
+		if (load->decodedOk) {
+			TextureLoad_ReleaseDecoded(renderer, &load->decoded);
+		}
+		TextureRegistry_Release(renderer, load->shared);
+		ExrLoader_Destroy(load->exr);
+		ScratchArena_Destroy(load->arena);
+		DestroyTextureWindow(load->textureWindow);
+		MEMORY_FREE(load);
+	}
+	CADT_VectorDestroy(pendingLoads);
+
 	Render_QueueWaitIdle(graphicsQueue);
 
 	About_Close();
@@ -381,19 +1422,25 @@ static void Exit() {
 		ASSERT(textureWindow);
 		TextureViewer_Destroy(textureWindow->textureViewer);
 		textureWindow->textureViewer = nullptr;
-		if (textureWindow->textureToView.cpu) {
-			Image_Destroy(textureWindow->textureToView.cpu);
-			textureWindow->textureToView.cpu = nullptr;
-		}
-		Render_TextureDestroy(renderer, textureWindow->textureToView.gpu);
-
-		TextureViewer_Destroy(textureWindow->textureViewer);
-		textureWindow->textureViewer = nullptr;
+		ReleaseTextureToView(textureWindow);
+		MEMORY_FREE(textureWindow->filePath);
+		textureWindow->filePath = nullptr;
 	}
+	ContactSheet_Destroy(contactSheet);
+	contactSheet = nullptr;
+	FolderBrowser_Destroy(folderBrowser);
+	folderBrowser = nullptr;
+	Benchmark_Destroy(benchmark);
+	benchmark = nullptr;
+	navWindow = nullptr;
+
 	// no need to pop each element as destroying
 	CADT_VectorDestroy(textureWindows);
 	CADT_FreeListDestroy(textureWindowFreeList);
 
+	// the queue went idle above, anything retired since can go straight away
+	FramesInFlight_Flush();
+
 	InputBasic_MouseDestroy(mouse);
 	InputBasic_KeyboardDestroy(keyboard);
 	InputBasic_Destroy(input);
@@ -420,9 +1467,35 @@ static void ProcessMsg(void *msg) {
 	if (input) {
 		InputBasic_PlatformProcessMsg(input, msg);
 	}
+	// any platform message (input, focus, expose...) may change what we'd draw
+	Redraw_MarkDirty();
 }
 
 int main(int argc, char const *argv[]) {
+	StartupProfile_Phase("arguments");
+	for (int i = 1; i < argc; ++i) {
+		if (strcmp(argv[i], SINGLE_INSTANCE_ARG) == 0) {
+			singleInstance = true;
+		} else if (strcmp(argv[i], BC6H_BENCHMARK_ARG) == 0) {
+			bc6hBenchmark = true;
+		} else if (strcmp(argv[i], STARTUP_REPORT_ARG) == 0) {
+			StartupProfile_EnableReport();
+		} else if (strcmp(argv[i], EXACT_READOUT_ARG) == 0) {
+			TextureLoad_SetKeepSource(true);
+		} else if (strcmp(argv[i], BENCHMARK_ARG) == 0) {
+			benchmarkTextures = BENCHMARK_DEFAULT_TEXTURES;
+		} else if (strncmp(argv[i], BENCHMARK_ARG, sizeof(BENCHMARK_ARG) - 1) == 0 &&
+				argv[i][sizeof(BENCHMARK_ARG) - 1] == '=') {
+			int const count = atoi(argv[i] + sizeof(BENCHMARK_ARG));
+			benchmarkTextures = count > 0 ? (uint32_t) count : BENCHMARK_DEFAULT_TEXTURES;
+		}
+	}
+	// hand the files to a devon that's already up and skip starting a renderer at all
+	if (singleInstance && SingleInstance_ForwardToRunning(argc, argv)) {
+		return 0;
+	}
+
+	StartupProfile_Phase("logger");
 	g_logger = SimpleLogManager_Alloc();
 
 	fileToOpenQueue = CADT_VectorCreate(MAX_INPUT_PATH_LENGTH);
@@ -432,10 +1505,14 @@ int main(int argc, char const *argv[]) {
 	}
 
 	CADT_VectorReserve(fileToOpenQueue, argc - 1);
-	for (auto i = 0u; i < argc - 1; ++i) {
-		CADT_VectorPushElement(fileToOpenQueue, (void *) argv[1 + i]);
+	for (int i = 1; i < argc; ++i) {
+		if (strncmp(argv[i], "--", 2) == 0) {
+			continue;
+		}
+		QueueFileToOpen(argv[i]);
 	}
 
+	StartupProfile_Phase("shell and window");
 	GameAppShell_Shell *shell = GameAppShell_Init();
 	shell->onInitCallback = &Init;
 	shell->onDisplayResizeCallback = &Resize;
@@ -0,0 +1,325 @@
+#include "al2o3_platform/platform.h"
+#include "al2o3_memory/memory.h"
+#include "al2o3_cadt/vector.h"
+#include "al2o3_vfile/vfile.h"
+#include "al2o3_os/time.h"
+#include "gfx_imgui/imgui.h"
+#include <atomic>
+#include <cfloat>
+#include <cstdio>
+
+#include "memory_panel.hpp"
+
+// one sample every 250ms, 240 of them is the last minute
+static const int64_t TIMELINE_PERIOD_US = 250000;
+static const uint32_t TIMELINE_LENGTH = 240;
+static const size_t TRACKING_HEADER_SIZE = 16;
+
+namespace {
+
+struct Row {
+	char const *name;
+	uint64_t cpuBytes;
+	uint64_t gpuBytes;
+	uint64_t overheadBytes;
+};
+
+struct Totals {
+	uint64_t cpuBytes;
+	uint64_t gpuBytes;
+	uint64_t overheadBytes;
+	uint64_t schedulerHeapBytes;
+	uint64_t loadHeapBytes; // already in the rows whilst a window holds it, not in the total
+};
+
+// each heap has its own allocator functions, Memory_Allocator carries no context
+enum TrackedHeap {
+	TH_SCHEDULER,
+	TH_LOADS,
+	TH_COUNT
+};
+
+std::atomic<int64_t> trackedBytes[TH_COUNT];
+std::atomic<uint64_t> trackedAllocations[TH_COUNT];
+
+CADT_VectorHandle rows;
+Totals current;
+Totals highWater;
+uint64_t highWaterTotal;
+
+float timeline[TIMELINE_LENGTH];
+uint32_t timelineHead;
+int64_t lastTimelineUs;
+
+bool panelOpen = false;
+uint32_t snapshotCount = 0;
+
+uint64_t TotalOf(Totals const &totals) {
+	return totals.cpuBytes + totals.gpuBytes + totals.overheadBytes + totals.schedulerHeapBytes;
+}
+
+double ToMB(uint64_t bytes) {
+	return (double) bytes / (1024.0 * 1024.0);
+}
+
+uint64_t TrackedBytesOf(TrackedHeap heap) {
+	int64_t const bytes = trackedBytes[heap].load(std::memory_order_relaxed);
+	return bytes > 0 ? (uint64_t) bytes : 0;
+}
+
+// the size rides in front of the allocation so free knows what to take off
+template<TrackedHeap Heap>
+void *TrackedAalloc(size_t size, size_t align) {
+	size_t const headerSize = align > TRACKING_HEADER_SIZE ? align : TRACKING_HEADER_SIZE;
+	auto base = (uint8_t *) MEMORY_ALLOCATOR_AALLOC(&Memory_GlobalAllocator, size + headerSize, headerSize);
+	if (!base) {
+		return nullptr;
+	}
+	uint8_t *memory = base + headerSize;
+	((size_t *) memory)[-1] = size;
+	((size_t *) memory)[-2] = headerSize;
+	trackedBytes[Heap].fetch_add((int64_t) size, std::memory_order_relaxed);
+	trackedAllocations[Heap].fetch_add(1, std::memory_order_relaxed);
+	return memory;
+}
+
+template<TrackedHeap Heap>
+void *TrackedMalloc(size_t size) {
+	return TrackedAalloc<Heap>(size, TRACKING_HEADER_SIZE);
+}
+
+template<TrackedHeap Heap>
+void *TrackedCalloc(size_t count, size_t size) {
+	void *memory = TrackedAalloc<Heap>(count * size, TRACKING_HEADER_SIZE);
+	if (memory) {
+		memset(memory, 0, count * size);
+	}
+	return memory;
+}
+
+template<TrackedHeap Heap>
+void TrackedFree(void *memory) {
+	if (!memory) {
+		return;
+	}
+	size_t const size = ((size_t *) memory)[-1];
+	size_t const headerSize = ((size_t *) memory)[-2];
+	trackedBytes[Heap].fetch_sub((int64_t) size, std::memory_order_relaxed);
+	MEMORY_ALLOCATOR_FREE(&Memory_GlobalAllocator, ((uint8_t *) memory) - headerSize);
+}
+
+template<TrackedHeap Heap>
+void *TrackedRealloc(void *memory, size_t size) {
+	if (!memory) {
+		return TrackedMalloc<Heap>(size);
+	}
+	size_t const oldSize = ((size_t *) memory)[-1];
+	void *newMemory = TrackedMalloc<Heap>(size);
+	if (newMemory) {
+		memcpy(newMemory, memory, oldSize < size ? oldSize : size);
+		TrackedFree<Heap>(memory);
+	}
+	return newMemory;
+}
+
+template<TrackedHeap Heap>
+Memory_Allocator MakeTrackingAllocator() {
+	return Memory_Allocator{
+			&TrackedMalloc<Heap>,
+			&TrackedAalloc<Heap>,
+			&TrackedCalloc<Heap>,
+			&TrackedRealloc<Heap>,
+			&TrackedFree<Heap>
+	};
+}
+
+Memory_Allocator trackingAllocators[TH_COUNT] = {
+		MakeTrackingAllocator<TH_SCHEDULER>(),
+		MakeTrackingAllocator<TH_LOADS>(),
+};
+
+// window names are file paths so backslashes and quotes need escaping
+void EscapeJsonString(char const *in, char *out, size_t outSize) {
+	size_t o = 0;
+	for (; *in && o + 2 < outSize; ++in) {
+		if (*in == '"' || *in == '\\') {
+			out[o++] = '\\';
+		}
+		out[o++] = *in;
+	}
+	out[o] = 0;
+}
+
+void DisplayRow(char const *name, uint64_t cpuBytes, uint64_t gpuBytes, uint64_t overheadBytes) {
+	ImGui::Text("%s", name);
+	ImGui::NextColumn();
+	ImGui::Text("%.2f", ToMB(cpuBytes));
+	ImGui::NextColumn();
+	ImGui::Text("%.2f", ToMB(gpuBytes));
+	ImGui::NextColumn();
+	ImGui::Text("%.3f", ToMB(overheadBytes));
+	ImGui::NextColumn();
+}
+
+} // end anon namespace
+
+Memory_Allocator *MemoryPanel_TrackingAllocator() {
+	return &trackingAllocators[TH_SCHEDULER];
+}
+
+Memory_Allocator *MemoryPanel_LoadAllocator() {
+	return &trackingAllocators[TH_LOADS];
+}
+
+bool MemoryPanel_SampleDue() {
+	return panelOpen || Os_GetUSec() - lastTimelineUs >= TIMELINE_PERIOD_US;
+}
+
+void MemoryPanel_BeginSample() {
+	if (!rows) {
+		rows = CADT_VectorCreate(sizeof(Row));
+	}
+	CADT_VectorResize(rows, 0);
+	memset(&current, 0, sizeof(Totals));
+}
+
+void MemoryPanel_AddRow(char const *name, uint64_t cpuBytes, uint64_t gpuBytes, uint64_t overheadBytes) {
+	Row const row{name, cpuBytes, gpuBytes, overheadBytes};
+	CADT_VectorPushElement(rows, (void *) &row);
+	current.cpuBytes += cpuBytes;
+	current.gpuBytes += gpuBytes;
+	current.overheadBytes += overheadBytes;
+}
+
+void MemoryPanel_EndSample() {
+	current.schedulerHeapBytes = TrackedBytesOf(TH_SCHEDULER);
+	current.loadHeapBytes = TrackedBytesOf(TH_LOADS);
+
+	highWater.cpuBytes = current.cpuBytes > highWater.cpuBytes ? current.cpuBytes : highWater.cpuBytes;
+	highWater.gpuBytes = current.gpuBytes > highWater.gpuBytes ? current.gpuBytes : highWater.gpuBytes;
+	highWater.overheadBytes = current.overheadBytes > highWater.overheadBytes ?
+														current.overheadBytes : highWater.overheadBytes;
+	highWater.schedulerHeapBytes = current.schedulerHeapBytes > highWater.schedulerHeapBytes ?
+																 current.schedulerHeapBytes : highWater.schedulerHeapBytes;
+	highWater.loadHeapBytes = current.loadHeapBytes > highWater.loadHeapBytes ?
+														current.loadHeapBytes : highWater.loadHeapBytes;
+	uint64_t const total = TotalOf(current);
+	highWaterTotal = total > highWaterTotal ? total : highWaterTotal;
+
+	int64_t const nowUs = Os_GetUSec();
+	if (nowUs - lastTimelineUs >= TIMELINE_PERIOD_US) {
+		lastTimelineUs = nowUs;
+		timeline[timelineHead] = (float) ToMB(total);
+		timelineHead = (timelineHead + 1) % TIMELINE_LENGTH;
+	}
+}
+
+void MemoryPanel_Open() {
+	panelOpen = true;
+}
+
+void MemoryPanel_Display() {
+	if (!panelOpen) {
+		return;
+	}
+
+	ImGui::SetNextWindowSize(ImVec2(640, 480), ImGuiCond_FirstUseEver);
+	if (!ImGui::Begin("Memory", &panelOpen, 0)) {
+		ImGui::End();
+		return;
+	}
+
+	uint64_t const total = TotalOf(current);
+	ImGui::Text("Total %.2f MB (high water %.2f MB)", ToMB(total), ToMB(highWaterTotal));
+	ImGui::Text("Task scheduler heap %.2f MB in %llu allocations so far",
+							ToMB(current.schedulerHeapBytes),
+							(unsigned long long) trackedAllocations[TH_SCHEDULER].load(std::memory_order_relaxed));
+	ImGui::Text("Load scratch heap %.2f MB in %llu blocks so far (high water %.2f MB)",
+							ToMB(current.loadHeapBytes),
+							(unsigned long long) trackedAllocations[TH_LOADS].load(std::memory_order_relaxed),
+							ToMB(highWater.loadHeapBytes));
+	if (ImGui::IsItemHovered()) {
+		ImGui::SetTooltip("Load, EXR and flipbook temporaries. Whilst a window holds them they're in its row,\n"
+											"so they aren't added to the total again");
+	}
+
+	char overlay[64];
+	snprintf(overlay, sizeof(overlay), "last %u s", (TIMELINE_LENGTH * (uint32_t) TIMELINE_PERIOD_US) / 1000000);
+	ImGui::PlotLines("MB", timeline, TIMELINE_LENGTH, timelineHead, overlay, 0.0f, FLT_MAX, ImVec2(0, 80));
+
+	if (ImGui::Button("Export snapshot")) {
+		char fileName[64];
+		snprintf(fileName, sizeof(fileName), "devon_memory_snapshot_%u.json", snapshotCount++);
+		if (MemoryPanel_ExportSnapshot(fileName)) {
+			LOGINFO("Memory snapshot written to %s", fileName);
+		}
+	}
+	ImGui::SameLine();
+	if (ImGui::Button("Reset high water")) {
+		memset(&highWater, 0, sizeof(Totals));
+		highWaterTotal = 0;
+	}
+
+	ImGui::Separator();
+	ImGui::Columns(4, "memory rows");
+	ImGui::Text("Name");
+	ImGui::NextColumn();
+	ImGui::Text("CPU MB");
+	ImGui::NextColumn();
+	ImGui::Text("GPU MB");
+	ImGui::NextColumn();
+	ImGui::Text("Overhead MB");
+	ImGui::NextColumn();
+	ImGui::Separator();
+	for (size_t i = 0; i < CADT_VectorSize(rows); ++i) {
+		auto row = (Row const *) CADT_VectorAt(rows, i);
+		DisplayRow(row->name, row->cpuBytes, row->gpuBytes, row->overheadBytes);
+	}
+	ImGui::Separator();
+	DisplayRow("Total", current.cpuBytes, current.gpuBytes, current.overheadBytes);
+	DisplayRow("High water", highWater.cpuBytes, highWater.gpuBytes, highWater.overheadBytes);
+	ImGui::Columns(1);
+
+	ImGui::End();
+}
+
+bool MemoryPanel_ExportSnapshot(char const *fileName) {
+	VFile_Handle fh = VFile_FromFile(fileName, Os_FM_Write);
+	if (!fh) {
+		LOGINFO("Unable to open %s for the memory snapshot", fileName);
+		return false;
+	}
+
+	char line[1024];
+	int len = snprintf(line, sizeof(line),
+										 "{\n\t\"totalBytes\": %llu,\n\t\"highWaterBytes\": %llu,\n"
+										 "\t\"cpuBytes\": %llu,\n\t\"gpuBytes\": %llu,\n\t\"overheadBytes\": %llu,\n"
+										 "\t\"schedulerHeapBytes\": %llu,\n\t\"loadScratchHeapBytes\": %llu,\n\t\"windows\": [",
+										 (unsigned long long) TotalOf(current),
+										 (unsigned long long) highWaterTotal,
+										 (unsigned long long) current.cpuBytes,
+										 (unsigned long long) current.gpuBytes,
+										 (unsigned long long) current.overheadBytes,
+										 (unsigned long long) current.schedulerHeapBytes,
+										 (unsigned long long) current.loadHeapBytes);
+	VFile_Write(fh, line, (size_t) len);
+
+	for (size_t i = 0; i < CADT_VectorSize(rows); ++i) {
+		auto row = (Row const *) CADT_VectorAt(rows, i);
+		char name[512];
+		EscapeJsonString(row->name, name, sizeof(name));
+		len = snprintf(line, sizeof(line),
+									 "%s\n\t\t{\"name\": \"%s\", \"cpuBytes\": %llu, \"gpuBytes\": %llu, \"overheadBytes\": %llu}",
+									 i == 0 ? "" : ",",
+									 name,
+									 (unsigned long long) row->cpuBytes,
+									 (unsigned long long) row->gpuBytes,
+									 (unsigned long long) row->overheadBytes);
+		VFile_Write(fh, line, (size_t) len);
+	}
+
+	len = snprintf(line, sizeof(line), "\n\t]\n}\n");
+	VFile_Write(fh, line, (size_t) len);
+	VFile_Close(fh);
+	return true;
+}
@@ -0,0 +1,27 @@
+#pragma once
+#ifndef DEVON_MEMORY_PANEL_HPP
+#define DEVON_MEMORY_PANEL_HPP
+
+#include "al2o3_memory/memory.h"
+
+// forward to the global allocator counting live bytes. The tracking allocator is the
+// task scheduler's, nothing else accounts for it so it's added to the total
+Memory_Allocator *MemoryPanel_TrackingAllocator();
+// the parent of every scratch arena, so load, EXR and flipbook temporaries show up.
+// Whilst a window holds them its row counts them, so they're shown but not totalled
+Memory_Allocator *MemoryPanel_LoadAllocator();
+
+// each sample is a full list of what's open, rows are only read until the next sample
+// true while the panel is showing or a timeline point is due, so idle ticks skip the walk
+bool MemoryPanel_SampleDue();
+void MemoryPanel_BeginSample();
+void MemoryPanel_AddRow(char const *name, uint64_t cpuBytes, uint64_t gpuBytes, uint64_t overheadBytes);
+void MemoryPanel_EndSample();
+
+void MemoryPanel_Open();
+void MemoryPanel_Display();
+
+// writes the current sample, totals and high water marks as json
+bool MemoryPanel_ExportSnapshot(char const *fileName);
+
+#endif //DEVON_MEMORY_PANEL_HPP
@@ -0,0 +1,44 @@
+#define MAX_CONTACT_SHEET_CELLS 512
+
+struct CellParams {
+    float4 colourMask;
+    int mipLevel;
+    float alphaReplicate;
+    float2 padding;
+};
+
+cbuffer uniformBlock : register(b0, space1)
+{
+    float4x4 ScaleOffsetMatrix;
+
+    CellParams cells[MAX_CONTACT_SHEET_CELLS];
+};
+
+struct FSInput {
+    float4 Position : SV_POSITION;
+    float2 Uv 	    : TEXCOORD;
+    nointerpolation float4 Colour   : COLOR;
+};
+
+Texture2DArray atlasTexture : register(t0, space1);
+
+SamplerState bilinearSampler : register(s0, space0);
+
+float4 FS_main(FSInput input) : SV_Target
+{
+    // the cell index is packed into the vertex colour red and green
+    uint cellIndex = (uint)round(input.Colour.r * 255.0f) + ((uint)round(input.Colour.g * 255.0f) << 8);
+    CellParams cell = cells[cellIndex];
+
+    float4 texSample = atlasTexture.SampleLevel(bilinearSampler, float3(input.Uv, cellIndex), (float)cell.mipLevel);
+
+    if(cell.alphaReplicate > 0.5) {
+        return float4(texSample.aaa, 1.0);
+    } else {
+        // if viewing rgba multiple in alpha otherwise just show rgb
+        if(cell.colourMask.a > 0.5f) {
+            texSample.rgb = texSample.rgb * texSample.a;
+        }
+        return cell.colourMask * texSample;
+    }
+}
\ No newline at end of file
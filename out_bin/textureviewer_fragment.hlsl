@@ -11,6 +11,13 @@ cbuffer uniformBlock : register(b0, space1)
 
     uint sliceToView;
     uint numSlices;
+
+    // auto lod uses autoLodLevel instead of forceMipLevel. Its worked out from the zoom
+    // on the CPU, the quad is never rotated or stretched, so the texel readout picks the same
+    uint autoLod;
+    uint trilinear;
+    float maxMipLevel;
+    float autoLodLevel;
 };
 
 struct FSInput {
@@ -25,14 +32,30 @@ Texture2DArray colourTextureArray : register(t1, space1);
 SamplerState pointSampler : register(s0, space0);
 SamplerState bilinearSampler : register(s1, space0);
 
+float4 SampleLevel(SamplerState samp, float2 uv, float lod) {
+    if(numSlices > 1 )
+    {
+        return colourTextureArray.SampleLevel(samp, float3(uv, sliceToView), lod);
+    } else {
+        return colourTexture.SampleLevel(samp, uv, lod);
+    }
+}
+
 float4 SampleTexture(float2 uv) {
     float4 texSample;
 
-    if(numSlices > 1 )
-    {
-        texSample = colourTextureArray.SampleLevel(pointSampler, float3(uv, sliceToView), (float)forceMipLevel);
+    float lod = autoLodLevel;
+    if(autoLod == 0) {
+        texSample = SampleLevel(pointSampler, uv, (float)forceMipLevel);
+    } else if(trilinear != 0 && lod > 0.0f) {
+        // blend the two mips by hand so it doesn't matter how the sampler filters between mips
+        float lod0 = floor(lod);
+        float4 sample0 = SampleLevel(bilinearSampler, uv, lod0);
+        float4 sample1 = SampleLevel(bilinearSampler, uv, min(lod0 + 1.0f, maxMipLevel));
+        texSample = lerp(sample0, sample1, lod - lod0);
     } else {
-        texSample = colourTexture.SampleLevel(pointSampler, uv, (float)forceMipLevel);
+        // magnified texels stay sharp
+        texSample = SampleLevel(pointSampler, uv, floor(lod + 0.5f));
     }
 
     if(signedRGB) {
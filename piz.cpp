@@ -0,0 +1,451 @@
+#include "al2o3_platform/platform.h"
+
+#include "piz.hpp"
+
+static const uint32_t USHORT_RANGE = 1 << 16;
+static const uint32_t BITMAP_SIZE = USHORT_RANGE >> 3;
+
+// codes up to HUF_DECBITS long decode with one lookup, longer ones share a lookup
+// entry with the others of the same prefix and are searched
+static const uint32_t HUF_ENCSIZE = (1 << 16) + 1;
+static const uint32_t HUF_DECBITS = 14;
+static const uint32_t HUF_DECSIZE = 1 << HUF_DECBITS;
+static const uint32_t HUF_DECMASK = HUF_DECSIZE - 1;
+static const uint32_t HUF_MAX_CODE_LENGTH = 58;
+// code lengths 59 to 62 are short runs of unused symbols in the table, 63 a long run
+static const uint32_t SHORT_ZEROCODE_RUN = 59;
+static const uint32_t LONG_ZEROCODE_RUN = 63;
+static const uint32_t SHORTEST_LONG_RUN = 2 + LONG_ZEROCODE_RUN - SHORT_ZEROCODE_RUN;
+static const size_t HUF_HEADER_SIZE = 20;
+
+namespace {
+
+struct HufDec {
+	uint32_t len; // of the short code here, 0 if this is a long code prefix (or unused)
+	uint32_t lit; // the short codes symbol, else how many long codes share the prefix
+	uint32_t first; // where those long codes start in longCodes
+};
+
+struct Scratch {
+	uint8_t bitmap[BITMAP_SIZE];
+	uint16_t lut[USHORT_RANGE];
+	// (code << 6) | length per symbol, only [min, max] of the block are valid
+	uint64_t hcode[HUF_ENCSIZE];
+	HufDec hdec[HUF_DECSIZE];
+	uint32_t longCodes[HUF_ENCSIZE];
+};
+
+struct BitReader {
+	uint8_t const *p;
+	uint8_t const *end;
+	uint64_t c;
+	int32_t lc;
+};
+
+bool GetChar(BitReader *r) {
+	if (r->p >= r->end) {
+		return false;
+	}
+	r->c = (r->c << 8) | *r->p++;
+	r->lc += 8;
+	return true;
+}
+
+bool GetBits(BitReader *r, int32_t bits, uint32_t *out) {
+	while (r->lc < bits) {
+		if (!GetChar(r)) {
+			return false;
+		}
+	}
+	r->lc -= bits;
+	*out = (uint32_t) ((r->c >> r->lc) & ((1u << bits) - 1));
+	return true;
+}
+
+uint32_t ReadU32(uint8_t const *p) {
+	uint32_t v;
+	memcpy(&v, p, sizeof(uint32_t));
+	return v;
+}
+
+uint32_t HufLength(uint64_t code) {
+	return (uint32_t) (code & 63);
+}
+
+uint64_t HufCode(uint64_t code) {
+	return code >> 6;
+}
+
+// code lengths are stored 6 bits each with runs of unused symbols squashed
+bool UnpackEncTable(BitReader *r, uint32_t im, uint32_t iM, uint64_t *hcode) {
+	for (; im <= iM; im++) {
+		uint32_t l;
+		if (!GetBits(r, 6, &l)) {
+			return false;
+		}
+		hcode[im] = l;
+		uint32_t zerun = 0;
+		if (l == LONG_ZEROCODE_RUN) {
+			if (!GetBits(r, 8, &zerun)) {
+				return false;
+			}
+			zerun += SHORTEST_LONG_RUN;
+		} else if (l >= SHORT_ZEROCODE_RUN) {
+			zerun = l - SHORT_ZEROCODE_RUN + 2;
+		}
+		if (zerun) {
+			if (im + zerun > iM + 1) {
+				return false;
+			}
+			for (uint32_t i = 0; i < zerun; ++i) {
+				hcode[im + i] = 0;
+			}
+			im += zerun - 1;
+		}
+	}
+	return true;
+}
+
+// canonical codes from the lengths, longest codes are numerically smallest
+void CanonicalCodeTable(uint32_t im, uint32_t iM, uint64_t *hcode) {
+	uint64_t n[HUF_MAX_CODE_LENGTH + 1] = {};
+	for (uint32_t i = im; i <= iM; ++i) {
+		n[hcode[i]] += 1;
+	}
+	uint64_t c = 0;
+	for (int32_t i = (int32_t) HUF_MAX_CODE_LENGTH; i > 0; --i) {
+		uint64_t const nc = (c + n[i]) >> 1;
+		n[i] = c;
+		c = nc;
+	}
+	for (uint32_t i = im; i <= iM; ++i) {
+		uint32_t const l = (uint32_t) hcode[i];
+		if (l > 0) {
+			hcode[i] = l | (n[l]++ << 6);
+		}
+	}
+}
+
+bool BuildDecTable(Scratch *s, uint32_t im, uint32_t iM) {
+	memset(s->hdec, 0, sizeof(s->hdec));
+
+	// short codes fill every entry they prefix, long ones count up their prefix
+	for (uint32_t i = im; i <= iM; ++i) {
+		uint64_t const c = HufCode(s->hcode[i]);
+		uint32_t const l = HufLength(s->hcode[i]);
+		if (c >> l) {
+			return false;
+		}
+		if (l > HUF_DECBITS) {
+			HufDec *pl = s->hdec + (c >> (l - HUF_DECBITS));
+			if (pl->len) {
+				return false;
+			}
+			pl->lit++;
+		} else if (l) {
+			HufDec *pl = s->hdec + (c << (HUF_DECBITS - l));
+			for (uint32_t j = 1u << (HUF_DECBITS - l); j > 0; j--, pl++) {
+				if (pl->len || pl->lit) {
+					return false;
+				}
+				pl->len = l;
+				pl->lit = i;
+			}
+		}
+	}
+
+	// then each prefix gets its slice of longCodes, filled back to front
+	uint32_t total = 0;
+	for (uint32_t i = 0; i < HUF_DECSIZE; ++i) {
+		HufDec *pl = s->hdec + i;
+		if (!pl->len && pl->lit) {
+			total += pl->lit;
+			pl->first = total;
+		}
+	}
+	for (uint32_t i = im; i <= iM; ++i) {
+		uint32_t const l = HufLength(s->hcode[i]);
+		if (l > HUF_DECBITS) {
+			HufDec *pl = s->hdec + (HufCode(s->hcode[i]) >> (l - HUF_DECBITS));
+			s->longCodes[--pl->first] = i;
+		}
+	}
+	return true;
+}
+
+// the rle symbol repeats the last value output, the next 8 bits are how many times
+bool PutCode(uint32_t symbol, uint32_t rlc, BitReader *r, uint16_t *out, size_t *outCount, size_t outSize) {
+	if (symbol == rlc) {
+		if (r->lc < 8 && !GetChar(r)) {
+			return false;
+		}
+		r->lc -= 8;
+		uint32_t const cs = (uint32_t) (r->c >> r->lc) & 0xFF;
+		if (*outCount + cs > outSize || *outCount == 0) {
+			return false;
+		}
+		uint16_t const v = out[*outCount - 1];
+		for (uint32_t i = 0; i < cs; ++i) {
+			out[(*outCount)++] = v;
+		}
+		return true;
+	}
+	if (*outCount >= outSize) {
+		return false;
+	}
+	out[(*outCount)++] = (uint16_t) symbol;
+	return true;
+}
+
+bool HufDecode(Scratch const *s, uint8_t const *in, uint32_t nBits, uint32_t rlc, uint16_t *out, size_t outSize) {
+	BitReader r{in, in + (nBits + 7) / 8, 0, 0};
+	size_t outCount = 0;
+
+	while (r.p < r.end) {
+		GetChar(&r);
+		while (r.lc >= (int32_t) HUF_DECBITS) {
+			HufDec const &pl = s->hdec[(r.c >> (r.lc - HUF_DECBITS)) & HUF_DECMASK];
+			if (pl.len) {
+				r.lc -= pl.len;
+				if (!PutCode(pl.lit, rlc, &r, out, &outCount, outSize)) {
+					return false;
+				}
+				continue;
+			}
+			if (!pl.lit) {
+				return false;
+			}
+			uint32_t j = 0;
+			for (; j < pl.lit; ++j) {
+				uint32_t const symbol = s->longCodes[pl.first + j];
+				int32_t const l = (int32_t) HufLength(s->hcode[symbol]);
+				while (r.lc < l && r.p < r.end) {
+					GetChar(&r);
+				}
+				if (r.lc >= l && HufCode(s->hcode[symbol]) == ((r.c >> (r.lc - l)) & ((1ull << l) - 1))) {
+					r.lc -= l;
+					if (!PutCode(symbol, rlc, &r, out, &outCount, outSize)) {
+						return false;
+					}
+					break;
+				}
+			}
+			if (j == pl.lit) {
+				return false;
+			}
+		}
+	}
+
+	// the last byte's padding bits aren't codes
+	int32_t const padding = (int32_t) ((8 - nBits) & 7);
+	r.c >>= padding;
+	r.lc -= padding;
+	while (r.lc > 0) {
+		HufDec const &pl = s->hdec[(r.c << (HUF_DECBITS - r.lc)) & HUF_DECMASK];
+		if (!pl.len) {
+			return false;
+		}
+		r.lc -= pl.len;
+		if (!PutCode(pl.lit, rlc, &r, out, &outCount, outSize)) {
+			return false;
+		}
+	}
+	return outCount == outSize;
+}
+
+bool HufUncompress(Scratch *s, uint8_t const *compressed, size_t compressedSize, uint16_t *out, size_t outSize) {
+	if (compressedSize == 0) {
+		return outSize == 0;
+	}
+	if (compressedSize < HUF_HEADER_SIZE) {
+		return false;
+	}
+	uint32_t const im = ReadU32(compressed);
+	uint32_t const iM = ReadU32(compressed + 4);
+	uint32_t const nBits = ReadU32(compressed + 12);
+	if (im >= HUF_ENCSIZE || iM >= HUF_ENCSIZE || im > iM) {
+		return false;
+	}
+
+	BitReader r{compressed + HUF_HEADER_SIZE, compressed + compressedSize, 0, 0};
+	if (!UnpackEncTable(&r, im, iM, s->hcode)) {
+		return false;
+	}
+	CanonicalCodeTable(im, iM, s->hcode);
+	if (!BuildDecTable(s, im, iM)) {
+		return false;
+	}
+	// the codes start on the byte after the table
+	if ((size_t) (r.end - r.p) < ((size_t) nBits + 7) / 8) {
+		return false;
+	}
+	return HufDecode(s, r.p, nBits, iM, out, outSize);
+}
+
+// 14 bit values use a lossless signed Haar step, wider ones wrap modulo 2^16
+void Wdec14(uint16_t l, uint16_t h, uint16_t *a, uint16_t *b) {
+	int32_t const hi = (int16_t) h;
+	int32_t const ai = (int16_t) l + (hi & 1) + (hi >> 1);
+	*a = (uint16_t) (int16_t) ai;
+	*b = (uint16_t) (int16_t) (ai - hi);
+}
+
+void Wdec16(uint16_t l, uint16_t h, uint16_t *a, uint16_t *b) {
+	int32_t const m = l;
+	int32_t const d = h;
+	int32_t const bb = (m - (d >> 1)) & 0xFFFF;
+	int32_t const aa = (d + bb - 0x8000) & 0xFFFF;
+	*b = (uint16_t) bb;
+	*a = (uint16_t) aa;
+}
+
+void Wdec(bool w14, uint16_t l, uint16_t h, uint16_t *a, uint16_t *b) {
+	if (w14) {
+		Wdec14(l, h, a, b);
+	} else {
+		Wdec16(l, h, a, b);
+	}
+}
+
+// inverse 2D wavelet of an nx by ny plane, ox apart in x and oy in y
+void Wav2Decode(uint16_t *in, size_t nx, size_t ox, size_t ny, size_t oy, uint16_t mx) {
+	bool const w14 = mx < (1 << 14);
+	size_t const n = nx > ny ? ny : nx;
+	size_t p = 1;
+	while (p <= n) {
+		p <<= 1;
+	}
+	p >>= 1;
+	size_t p2 = p;
+	p >>= 1;
+
+	while (p >= 1) {
+		size_t const oy1 = oy * p;
+		size_t const oy2 = oy * p2;
+		size_t const ox1 = ox * p;
+		size_t const ox2 = ox * p2;
+		size_t const ey = oy * (ny - p2);
+		size_t const ex = ox * (nx - p2);
+		uint16_t i00, i01, i10, i11;
+
+		size_t py = 0;
+		for (; py <= ey; py += oy2) {
+			size_t px = py;
+			for (; px <= py + ex; px += ox2) {
+				uint16_t *p00 = in + px;
+				uint16_t *p01 = p00 + ox1;
+				uint16_t *p10 = p00 + oy1;
+				uint16_t *p11 = p10 + ox1;
+				Wdec(w14, *p00, *p10, &i00, &i10);
+				Wdec(w14, *p01, *p11, &i01, &i11);
+				Wdec(w14, i00, i01, p00, p01);
+				Wdec(w14, i10, i11, p10, p11);
+			}
+			// odd column
+			if (nx & p) {
+				uint16_t *p00 = in + px;
+				uint16_t *p10 = p00 + oy1;
+				Wdec(w14, *p00, *p10, &i00, p10);
+				*p00 = i00;
+			}
+		}
+		// odd line
+		if (ny & p) {
+			for (size_t px = py; px <= py + ex; px += ox2) {
+				uint16_t *p00 = in + px;
+				uint16_t *p01 = p00 + ox1;
+				Wdec(w14, *p00, *p01, &i00, p01);
+				*p00 = i00;
+			}
+		}
+
+		p2 = p;
+		p >>= 1;
+	}
+}
+
+} // end anon namespace
+
+size_t Piz_ScratchSize() {
+	return sizeof(Scratch);
+}
+
+bool Piz_Decode(uint8_t const *src, size_t srcSize,
+								uint32_t width, uint32_t height,
+								uint8_t const *channelShorts, uint32_t channelCount,
+								void *scratch, uint16_t *planes, uint8_t *dst, size_t dstSize) {
+	auto s = (Scratch *) scratch;
+	size_t const valueCount = dstSize / sizeof(uint16_t);
+	uint8_t const *end = src + srcSize;
+
+	// which values are used, the lut maps their compacted index back
+	if (srcSize < 4) {
+		return false;
+	}
+	uint16_t minNonZero, maxNonZero;
+	memcpy(&minNonZero, src, sizeof(uint16_t));
+	memcpy(&maxNonZero, src + 2, sizeof(uint16_t));
+	src += 4;
+	if (maxNonZero >= BITMAP_SIZE) {
+		return false;
+	}
+	memset(s->bitmap, 0, BITMAP_SIZE);
+	if (minNonZero <= maxNonZero) {
+		size_t const bitmapBytes = (size_t) maxNonZero - minNonZero + 1;
+		if ((size_t) (end - src) < bitmapBytes) {
+			return false;
+		}
+		memcpy(s->bitmap + minNonZero, src, bitmapBytes);
+		src += bitmapBytes;
+	}
+	uint32_t k = 0;
+	for (uint32_t i = 0; i < USHORT_RANGE; ++i) {
+		if (i == 0 || (s->bitmap[i >> 3] & (1 << (i & 7)))) {
+			s->lut[k++] = (uint16_t) i;
+		}
+	}
+	uint16_t const maxValue = (uint16_t) (k - 1);
+	while (k < USHORT_RANGE) {
+		s->lut[k++] = 0;
+	}
+
+	int32_t length;
+	if ((size_t) (end - src) < sizeof(int32_t)) {
+		return false;
+	}
+	memcpy(&length, src, sizeof(int32_t));
+	src += sizeof(int32_t);
+	if (length < 0 || (size_t) length > (size_t) (end - src)) {
+		return false;
+	}
+	if (!HufUncompress(s, src, (size_t) length, planes, valueCount)) {
+		return false;
+	}
+
+	// each channel is a plane, float and uint planes interleave their two halves
+	size_t const pixels = (size_t) width * height;
+	uint16_t *start = planes;
+	for (uint32_t c = 0; c < channelCount; ++c) {
+		size_t const shorts = channelShorts[c];
+		for (size_t j = 0; j < shorts; ++j) {
+			Wav2Decode(start + j, width, shorts, height, width * shorts, maxValue);
+		}
+		start += pixels * shorts;
+	}
+	for (size_t i = 0; i < valueCount; ++i) {
+		planes[i] = s->lut[planes[i]];
+	}
+
+	// back to lines of each channel in turn
+	uint8_t *out = dst;
+	for (uint32_t y = 0; y < height; ++y) {
+		start = planes;
+		for (uint32_t c = 0; c < channelCount; ++c) {
+			size_t const lineShorts = (size_t) width * channelShorts[c];
+			memcpy(out, start + y * lineShorts, lineShorts * sizeof(uint16_t));
+			out += lineShorts * sizeof(uint16_t);
+			start += pixels * channelShorts[c];
+		}
+	}
+	return true;
+}
@@ -0,0 +1,23 @@
+#pragma once
+#ifndef DEVON_PIZ_HPP
+#define DEVON_PIZ_HPP
+
+#include "al2o3_platform/platform.h"
+
+// Decodes an OpenEXR PIZ block (Huffman coded, Haar wavelet transformed and range
+// compacted 16 bit values, channel by channel) into the uncompressed scanline layout,
+// each line holding every channel's samples in turn. Follows the OpenEXR reference
+// decoder. Thread safe as long as each thread has its own scratch, no allocations.
+
+// bytes of scratch each decoding thread needs, independent of the block size
+size_t Piz_ScratchSize();
+
+// channelShorts is the number of 16 bit values per sample of each channel, 1 for half,
+// 2 for float and uint. planes and dst are both dstSize, width * height * every
+// channels sample size. False on corrupt input
+bool Piz_Decode(uint8_t const *src, size_t srcSize,
+								uint32_t width, uint32_t height,
+								uint8_t const *channelShorts, uint32_t channelCount,
+								void *scratch, uint16_t *planes, uint8_t *dst, size_t dstSize);
+
+#endif //DEVON_PIZ_HPP
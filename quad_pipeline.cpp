@@ -0,0 +1,116 @@
+#include "al2o3_platform/platform.h"
+#include "al2o3_vfile/vfile.h"
+
+#include "render_basics/api.h"
+#include "render_basics/framebuffer.h"
+#include "render_basics/rootsignature.h"
+#include "render_basics/pipeline.h"
+#include "render_basics/shader.h"
+
+#include "quad_pipeline.hpp"
+
+namespace {
+
+bool CreateShader(Render_RendererHandle renderer, char const *vertexFile, char const *fragmentFile, QuadPipeline *out) {
+
+	static char const *const vertEntryPoint = "VS_main";
+	static char const *const fragEntryPoint = "FS_main";
+
+	VFile_Handle vfile = VFile_FromFile(vertexFile, Os_FM_Read);
+	if (!vfile) {
+		return false;
+	}
+	VFile_Handle ffile = VFile_FromFile(fragmentFile, Os_FM_Read);
+	if (!ffile) {
+		VFile_Close(vfile);
+		return false;
+	}
+	Render_ShaderObjectDesc vsod = {
+			Render_ST_VERTEXSHADER,
+			vfile,
+			vertEntryPoint
+	};
+	Render_ShaderObjectDesc fsod = {
+			Render_ST_FRAGMENTSHADER,
+			ffile,
+			fragEntryPoint
+	};
+
+	Render_ShaderObjectHandle shaderObjects[2]{};
+	shaderObjects[0] = Render_ShaderObjectCreate(renderer, &vsod);
+	shaderObjects[1] = Render_ShaderObjectCreate(renderer, &fsod);
+
+	VFile_Close(vfile);
+	VFile_Close(ffile);
+
+	if (!Render_ShaderObjectHandleIsValid(shaderObjects[0]) ||
+			!Render_ShaderObjectHandleIsValid(shaderObjects[1])) {
+		Render_ShaderObjectDestroy(renderer, shaderObjects[0]);
+		Render_ShaderObjectDestroy(renderer, shaderObjects[1]);
+		return false;
+	}
+
+	out->shader = Render_ShaderCreate(renderer, 2, shaderObjects);
+
+	Render_ShaderObjectDestroy(renderer, shaderObjects[0]);
+	Render_ShaderObjectDestroy(renderer, shaderObjects[1]);
+
+	return true;
+}
+
+} // end anon namespace
+
+bool QuadPipeline_Create(Render_RendererHandle renderer,
+												 Render_FrameBufferHandle frameBuffer,
+												 QuadPipeline_Desc const *desc,
+												 QuadPipeline *out) {
+	memset(out, 0, sizeof(QuadPipeline));
+
+	if (!CreateShader(renderer, desc->vertexFile, desc->fragmentFile, out)) {
+		QuadPipeline_Destroy(renderer, out);
+		return false;
+	}
+
+	Render_ShaderHandle shaders[]{out->shader};
+	Render_RootSignatureDesc rootSignatureDesc{};
+	rootSignatureDesc.shaderCount = 1;
+	rootSignatureDesc.shaders = shaders;
+	rootSignatureDesc.staticSamplerCount = desc->samplerCount;
+	rootSignatureDesc.staticSamplerNames = desc->samplerNames;
+	rootSignatureDesc.staticSamplers = desc->samplers;
+	out->rootSignature = Render_RootSignatureCreate(renderer, &rootSignatureDesc);
+	if (!Render_RootSignatureHandleIsValid(out->rootSignature)) {
+		QuadPipeline_Destroy(renderer, out);
+		return false;
+	}
+
+	Render_GraphicsPipelineDesc gfxPipeDesc{};
+
+	TinyImageFormat colourFormats[] = {Render_FrameBufferColourFormat(frameBuffer)};
+	gfxPipeDesc.shader = out->shader;
+	gfxPipeDesc.rootSignature = out->rootSignature;
+	gfxPipeDesc.vertexLayout = Render_GetStockVertexLayout(renderer, Render_SVL_2D_COLOUR_UV);
+	gfxPipeDesc.blendState = Render_GetStockBlendState(renderer, Render_SBS_OPAQUE);
+	gfxPipeDesc.depthState = Render_GetStockDepthState(renderer, Render_SDS_IGNORE);
+	gfxPipeDesc.rasteriserState = Render_GetStockRasterisationState(renderer, Render_SRS_NOCULL);
+	gfxPipeDesc.colourRenderTargetCount = 1;
+	gfxPipeDesc.colourFormats = colourFormats;
+	gfxPipeDesc.depthStencilFormat = TinyImageFormat_UNDEFINED;
+	gfxPipeDesc.sampleCount = 1;
+	gfxPipeDesc.sampleQuality = 0;
+	gfxPipeDesc.primitiveTopo = Render_PT_TRI_LIST;
+	out->pipeline = Render_GraphicsPipelineCreate(renderer, &gfxPipeDesc);
+	if (!Render_PipelineHandleIsValid(out->pipeline)) {
+		QuadPipeline_Destroy(renderer, out);
+		return false;
+	}
+
+	return true;
+}
+
+void QuadPipeline_Destroy(Render_RendererHandle renderer, QuadPipeline *quad) {
+	Render_PipelineDestroy(renderer, quad->pipeline);
+	Render_RootSignatureDestroy(renderer, quad->rootSignature);
+	Render_ShaderDestroy(renderer, quad->shader);
+	memset(quad, 0, sizeof(QuadPipeline));
+}
@@ -0,0 +1,31 @@
+#pragma once
+#ifndef DEVON_QUAD_PIPELINE_HPP
+#define DEVON_QUAD_PIPELINE_HPP
+
+#include "render_basics/api.h"
+
+// The shader, root signature and pipeline an imgui callback draws its quads with.
+// Vertex layout and blend, depth and raster state are the same for every view,
+// only the shader files and static samplers differ.
+typedef struct QuadPipeline {
+	Render_ShaderHandle shader;
+	Render_RootSignatureHandle rootSignature;
+	Render_PipelineHandle pipeline;
+} QuadPipeline;
+
+typedef struct QuadPipeline_Desc {
+	char const *vertexFile;
+	char const *fragmentFile;
+	uint32_t samplerCount;
+	Render_SamplerHandle *samplers;
+	char const **samplerNames;
+} QuadPipeline_Desc;
+
+// false if any part fails, anything already made is destroyed
+bool QuadPipeline_Create(Render_RendererHandle renderer,
+												 Render_FrameBufferHandle frameBuffer,
+												 QuadPipeline_Desc const *desc,
+												 QuadPipeline *out);
+void QuadPipeline_Destroy(Render_RendererHandle renderer, QuadPipeline *quad);
+
+#endif //DEVON_QUAD_PIPELINE_HPP
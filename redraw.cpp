@@ -0,0 +1,195 @@
+#include "al2o3_platform/platform.h"
+#include "al2o3_os/thread.h"
+#include "al2o3_os/time.h"
+#include "gfx_imgui/imgui.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <cstdio>
+#include <ctime>
+
+#include "redraw.hpp"
+#include "frames_in_flight.hpp"
+
+// enough to settle imgui (which often needs a 2nd frame) and cycle the frames in flight
+static const uint32_t FRAMES_AFTER_EVENT = FRAMES_IN_FLIGHT;
+// the shell polls for input and has no blocking event wait, so idle still has to
+// come back this often to let it. Redraw_MarkDirty ends the wait early
+static const uint32_t IDLE_WAIT_MS = 10;
+static const int64_t STATS_PERIOD_US = 1000000;
+
+namespace {
+
+std::atomic<uint32_t> pendingEvents{0};
+std::mutex wakeMutex;
+std::condition_variable wake;
+
+bool continuous = false;
+bool frameActive = true;
+uint32_t framesLeft = FRAMES_AFTER_EVENT;
+
+bool statsOpen = false;
+
+// accumulated over the current period
+struct Period {
+	int64_t startUs;
+	clock_t startCpu;
+	uint64_t startEnergyUj;
+	uint32_t renderedFrames;
+	uint32_t skippedFrames;
+	int64_t sleptUs;
+} period;
+
+// last completed period
+struct Stats {
+	float renderedFps;
+	float skippedFps;
+	float idlePercent;
+	float cpuPercent;
+	float packageWatts; // < 0 if not available
+} stats{0, 0, 0, 0, -1.0f};
+
+// package energy from the linux powercap interface, 0 if we can't read it
+uint64_t ReadEnergyUj() {
+#if defined(__linux__)
+	FILE *fp = fopen("/sys/class/powercap/intel-rapl:0/energy_uj", "r");
+	if (!fp) {
+		return 0;
+	}
+	unsigned long long energy = 0;
+	if (fscanf(fp, "%llu", &energy) != 1) {
+		energy = 0;
+	}
+	fclose(fp);
+	return (uint64_t) energy;
+#else
+	return 0;
+#endif
+}
+
+void StartPeriod(int64_t nowUs) {
+	period.startUs = nowUs;
+	period.startCpu = clock();
+	period.startEnergyUj = ReadEnergyUj();
+	period.renderedFrames = 0;
+	period.skippedFrames = 0;
+	period.sleptUs = 0;
+}
+
+void SamplePeriod() {
+	int64_t const nowUs = Os_GetUSec();
+	if (period.startUs == 0) {
+		StartPeriod(nowUs);
+		return;
+	}
+
+	int64_t const elapsedUs = nowUs - period.startUs;
+	if (elapsedUs < STATS_PERIOD_US) {
+		return;
+	}
+
+	float const elapsedS = (float) elapsedUs / 1e6f;
+	float const cpuS = (float) (clock() - period.startCpu) / (float) CLOCKS_PER_SEC;
+
+	stats.renderedFps = (float) period.renderedFrames / elapsedS;
+	stats.skippedFps = (float) period.skippedFrames / elapsedS;
+	stats.idlePercent = 100.0f * (float) period.sleptUs / (float) elapsedUs;
+	stats.cpuPercent = 100.0f * cpuS / elapsedS;
+
+	uint64_t const energyUj = ReadEnergyUj();
+	if (energyUj != 0 && period.startEnergyUj != 0 && energyUj > period.startEnergyUj) {
+		stats.packageWatts = (float) (energyUj - period.startEnergyUj) / 1e6f / elapsedS;
+	} else {
+		stats.packageWatts = -1.0f;
+	}
+
+	StartPeriod(nowUs);
+
+	// keep the numbers on screen fresh, this costs one redraw a second only whilst open
+	if (statsOpen) {
+		Redraw_MarkDirty();
+	}
+}
+
+} // end anon namespace
+
+void Redraw_MarkDirty() {
+	pendingEvents.fetch_add(1, std::memory_order_relaxed);
+	// taking the lock means a waiter is either not yet checking or already waiting
+	{
+		std::lock_guard<std::mutex> lock(wakeMutex);
+	}
+	wake.notify_one();
+}
+
+bool Redraw_BeginFrame() {
+	SamplePeriod();
+
+	if (pendingEvents.exchange(0, std::memory_order_relaxed) != 0) {
+		framesLeft = FRAMES_AFTER_EVENT;
+	}
+
+	if (continuous || framesLeft > 0) {
+		if (framesLeft > 0) {
+			framesLeft--;
+		}
+		period.renderedFrames++;
+		frameActive = true;
+		return true;
+	}
+
+	int64_t const sleepStartUs = Os_GetUSec();
+	{
+		std::unique_lock<std::mutex> lock(wakeMutex);
+		wake.wait_for(lock, std::chrono::milliseconds(IDLE_WAIT_MS), [] {
+			return pendingEvents.load(std::memory_order_relaxed) != 0;
+		});
+	}
+	period.sleptUs += Os_GetUSec() - sleepStartUs;
+	period.skippedFrames++;
+
+	frameActive = false;
+	return false;
+}
+
+bool Redraw_IsFrameActive() {
+	return frameActive;
+}
+
+void Redraw_SetContinuous(bool enable) {
+	continuous = enable;
+	Redraw_MarkDirty();
+}
+
+bool Redraw_IsContinuous() {
+	return continuous;
+}
+
+void Redraw_OpenStats() {
+	statsOpen = true;
+}
+
+void Redraw_DisplayStats() {
+	if (!statsOpen) {
+		return;
+	}
+
+	if (!ImGui::Begin("Idle Stats", &statsOpen, ImGuiWindowFlags_AlwaysAutoResize)) {
+		ImGui::End();
+		return;
+	}
+
+	ImGui::Text("Mode: %s", continuous ? "continuous" : "on demand");
+	ImGui::Text("Rendered frames/s: %.1f", stats.renderedFps);
+	ImGui::Text("Skipped frames/s: %.1f", stats.skippedFps);
+	ImGui::Text("Idle (sleeping): %.1f%%", stats.idlePercent);
+	ImGui::Text("Process CPU: %.1f%% of a core", stats.cpuPercent);
+	if (stats.packageWatts >= 0.0f) {
+		ImGui::Text("CPU package power: %.2f W", stats.packageWatts);
+	} else {
+		ImGui::Text("CPU package power: n/a");
+	}
+
+	ImGui::End();
+}
@@ -0,0 +1,22 @@
+#pragma once
+#ifndef DEVON_REDRAW_HPP
+#define DEVON_REDRAW_HPP
+
+// Render on demand. Whilst nothing changes frames are skipped and the main
+// loop sleeps, any event marks things dirty and a few frames get rendered.
+
+// safe to call from any thread, a worker finishing ends the idle wait straight away
+void Redraw_MarkDirty();
+
+// call at the top of each update, false means skip this frame entirely
+bool Redraw_BeginFrame();
+// true between a BeginFrame that returned true and the next BeginFrame
+bool Redraw_IsFrameActive();
+
+void Redraw_SetContinuous(bool continuous);
+bool Redraw_IsContinuous();
+
+void Redraw_OpenStats();
+void Redraw_DisplayStats();
+
+#endif //DEVON_REDRAW_HPP
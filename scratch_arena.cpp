@@ -0,0 +1,221 @@
+#include "al2o3_platform/platform.h"
+#include "al2o3_memory/memory.h"
+#include <atomic>
+#include <utility>
+
+#include "scratch_arena.hpp"
+
+static const size_t DEFAULT_ALIGNMENT = 16;
+// Memory_Allocator functions carry no context, so each arena takes a slot with
+// its own set of functions
+static const uint32_t MAX_SCRATCH_ARENAS = 256;
+
+namespace {
+
+struct Block {
+	Block *next;
+	size_t size;
+	size_t used;
+};
+
+// in front of every allocation so realloc knows how much to copy
+struct AllocHeader {
+	size_t size;
+	size_t padding;
+};
+
+} // end anon namespace
+
+struct ScratchArena {
+	Memory_Allocator *parent;
+	size_t blockSize;
+	uint32_t slot;
+	Block *head; // current block, older blocks hang off next
+	ScratchArena_Stats stats;
+};
+
+namespace {
+
+std::atomic<ScratchArena *> slots[MAX_SCRATCH_ARENAS];
+
+size_t AlignUp(size_t v, size_t align) {
+	return (v + (align - 1)) & ~(align - 1);
+}
+
+uint8_t *BlockDataOf(Block *block) {
+	return ((uint8_t *) block) + AlignUp(sizeof(Block), DEFAULT_ALIGNMENT);
+}
+
+Block *AllocBlock(ScratchArena *arena, size_t minSize) {
+	size_t const size = minSize > arena->blockSize ? minSize : arena->blockSize;
+	auto block = (Block *) MEMORY_ALLOCATOR_MALLOC(arena->parent, AlignUp(sizeof(Block), DEFAULT_ALIGNMENT) + size);
+	if (!block) {
+		return nullptr;
+	}
+	block->next = arena->head;
+	block->size = size;
+	block->used = 0;
+	arena->head = block;
+	arena->stats.reservedBytes += size;
+	arena->stats.blockCount++;
+	return block;
+}
+
+void *ArenaAlloc(ScratchArena *arena, size_t size, size_t align) {
+	align = align < DEFAULT_ALIGNMENT ? DEFAULT_ALIGNMENT : align;
+
+	Block *block = arena->head;
+	size_t offset = block ? AlignUp(block->used + sizeof(AllocHeader), align) : 0;
+	if (!block || offset + size > block->size) {
+		block = AllocBlock(arena, size + sizeof(AllocHeader) + align);
+		if (!block) {
+			return nullptr;
+		}
+		offset = AlignUp(sizeof(AllocHeader), align);
+	}
+
+	uint8_t *memory = BlockDataOf(block) + offset;
+	auto header = ((AllocHeader *) memory) - 1;
+	header->size = size;
+	block->used = offset + size;
+
+	arena->stats.allocationCount++;
+	arena->stats.bytesAllocated += size;
+	if (arena->stats.bytesAllocated > arena->stats.peakBytes) {
+		arena->stats.peakBytes = arena->stats.bytesAllocated;
+	}
+	return memory;
+}
+
+template<uint32_t Slot>
+void *SlotMalloc(size_t size) {
+	return ArenaAlloc(slots[Slot].load(std::memory_order_relaxed), size, DEFAULT_ALIGNMENT);
+}
+
+template<uint32_t Slot>
+void *SlotAalloc(size_t size, size_t align) {
+	return ArenaAlloc(slots[Slot].load(std::memory_order_relaxed), size, align);
+}
+
+template<uint32_t Slot>
+void *SlotCalloc(size_t count, size_t size) {
+	void *memory = SlotMalloc<Slot>(count * size);
+	if (memory) {
+		memset(memory, 0, count * size);
+	}
+	return memory;
+}
+
+template<uint32_t Slot>
+void SlotFree(void *memory) {
+}
+
+template<uint32_t Slot>
+void *SlotRealloc(void *memory, size_t size) {
+	if (!memory) {
+		return SlotMalloc<Slot>(size);
+	}
+	auto header = ((AllocHeader const *) memory) - 1;
+	void *newMemory = SlotMalloc<Slot>(size);
+	if (newMemory) {
+		memcpy(newMemory, memory, header->size < size ? header->size : size);
+	}
+	return newMemory;
+}
+
+struct SlotAllocators {
+	Memory_Allocator allocators[MAX_SCRATCH_ARENAS];
+};
+
+template<size_t... Slots>
+SlotAllocators MakeSlotAllocators(std::index_sequence<Slots...>) {
+	return SlotAllocators{{
+			Memory_Allocator{
+					&SlotMalloc<Slots>,
+					&SlotAalloc<Slots>,
+					&SlotCalloc<Slots>,
+					&SlotRealloc<Slots>,
+					&SlotFree<Slots>
+			}...
+	}};
+}
+
+SlotAllocators slotAllocators = MakeSlotAllocators(std::make_index_sequence<MAX_SCRATCH_ARENAS>());
+
+} // end anon namespace
+
+ScratchArenaHandle ScratchArena_Create(Memory_Allocator *parent, size_t blockSize) {
+	auto arena = (ScratchArena *) MEMORY_ALLOCATOR_MALLOC(parent, sizeof(ScratchArena));
+	if (!arena) {
+		return nullptr;
+	}
+	memset(arena, 0, sizeof(ScratchArena));
+	arena->parent = parent;
+	arena->blockSize = blockSize;
+
+	for (uint32_t i = 0; i < MAX_SCRATCH_ARENAS; ++i) {
+		ScratchArena *expected = nullptr;
+		if (slots[i].compare_exchange_strong(expected, arena)) {
+			arena->slot = i;
+			return arena;
+		}
+	}
+	LOGINFO("All %u scratch arenas are in use", MAX_SCRATCH_ARENAS);
+	MEMORY_ALLOCATOR_FREE(parent, arena);
+	return nullptr;
+}
+
+void ScratchArena_Destroy(ScratchArenaHandle handle) {
+	auto arena = (ScratchArena *) handle;
+	if (!arena) {
+		return;
+	}
+
+	Block *block = arena->head;
+	while (block) {
+		Block *next = block->next;
+		MEMORY_ALLOCATOR_FREE(arena->parent, block);
+		block = next;
+	}
+	slots[arena->slot].store(nullptr);
+	MEMORY_ALLOCATOR_FREE(arena->parent, arena);
+}
+
+void ScratchArena_Reset(ScratchArenaHandle handle) {
+	auto arena = (ScratchArena *) handle;
+	if (!arena || !arena->head) {
+		return;
+	}
+
+	Block *keep = arena->head;
+	for (Block *block = arena->head->next; block; block = block->next) {
+		keep = block->size > keep->size ? block : keep;
+	}
+	Block *block = arena->head;
+	while (block) {
+		Block *next = block->next;
+		if (block != keep) {
+			arena->stats.reservedBytes -= block->size;
+			arena->stats.blockCount--;
+			MEMORY_ALLOCATOR_FREE(arena->parent, block);
+		}
+		block = next;
+	}
+	keep->next = nullptr;
+	keep->used = 0;
+	arena->head = keep;
+	arena->stats.bytesAllocated = 0;
+}
+
+void ScratchArena_GetStats(ScratchArenaHandle handle, ScratchArena_Stats *stats) {
+	auto arena = (ScratchArena *) handle;
+	if (!arena || !stats) {
+		return;
+	}
+	*stats = arena->stats;
+}
+
+Memory_Allocator *ScratchArena_Allocator(ScratchArenaHandle handle) {
+	auto arena = (ScratchArena *) handle;
+	return arena ? &slotAllocators.allocators[arena->slot] : &Memory_GlobalAllocator;
+}
@@ -0,0 +1,31 @@
+#pragma once
+#ifndef DEVON_SCRATCH_ARENA_HPP
+#define DEVON_SCRATCH_ARENA_HPP
+
+#include "al2o3_memory/memory.h"
+
+// Bump allocator for a loads temporaries. Frees do nothing, everything goes in one
+// go with Reset or Destroy. Each arena has its own Memory_Allocator so it can be
+// handed to code that takes one, it's only ever used by one thread at a time.
+typedef struct ScratchArena *ScratchArenaHandle;
+
+typedef struct ScratchArena_Stats {
+	uint64_t allocationCount; // since Create
+	uint64_t bytesAllocated;	// since the last reset
+	uint64_t peakBytes;				// high water of bytesAllocated since Create
+	uint64_t reservedBytes;		// block memory currently held
+	uint32_t blockCount;
+} ScratchArena_Stats;
+
+// blocks come from parent, blockSize is the smallest. Null if every arena is in use,
+// the null handle's allocator is the global one so callers carry on without
+ScratchArenaHandle ScratchArena_Create(Memory_Allocator *parent, size_t blockSize);
+void ScratchArena_Destroy(ScratchArenaHandle handle);
+
+// keeps the largest block so a run of similar loads bump through the same memory
+void ScratchArena_Reset(ScratchArenaHandle handle);
+void ScratchArena_GetStats(ScratchArenaHandle handle, ScratchArena_Stats *stats);
+
+Memory_Allocator *ScratchArena_Allocator(ScratchArenaHandle handle);
+
+#endif //DEVON_SCRATCH_ARENA_HPP
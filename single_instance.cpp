@@ -0,0 +1,271 @@
+#include "al2o3_platform/platform.h"
+
+#include "single_instance.hpp"
+
+#if AL2O3_PLATFORM == AL2O3_PLATFORM_WINDOWS
+
+bool SingleInstance_ForwardToRunning(int argc, char const *argv[]) {
+	return false;
+}
+
+bool SingleInstance_Listen() {
+	LOGINFO("Single instance mode isn't supported on this platform");
+	return false;
+}
+
+void SingleInstance_Poll(SingleInstance_PathCallback callback, void *userData) {
+}
+
+void SingleInstance_Shutdown() {
+}
+
+#else
+
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <cerrno>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// paths are sent null terminated back to back, one connection per launch
+static const size_t MAX_FORWARDED_PATH_LENGTH = 1024;
+static const int MAX_CONNECTIONS_PER_POLL = 8;
+// a client that connects but doesn't send can only stall a frame this long
+static const int CLIENT_RECEIVE_TIMEOUT_MS = 100;
+
+namespace {
+
+int listenSocket = -1;
+sockaddr_un listenAddress;
+
+// /tmp is shared, so the fallback socket goes in a folder only we can get into
+// and nobody else can take the name first
+bool MakePrivateFolder(char const *folder) {
+	if (mkdir(folder, S_IRWXU) != 0 && errno != EEXIST) {
+		return false;
+	}
+	// lstat so a symlink planted there isn't followed
+	struct stat st;
+	if (lstat(folder, &st) != 0 || !S_ISDIR(st.st_mode) || st.st_uid != getuid() ||
+			(st.st_mode & (S_IRWXG | S_IRWXO)) != 0) {
+		LOGWARNING("%s isn't a folder only we can use, single instance is off", folder);
+		return false;
+	}
+	return true;
+}
+
+bool AddressOf(sockaddr_un *address) {
+	memset(address, 0, sizeof(sockaddr_un));
+	address->sun_family = AF_UNIX;
+
+	char const *runtimeDir = getenv("XDG_RUNTIME_DIR");
+	int len;
+	if (runtimeDir && runtimeDir[0]) {
+		len = snprintf(address->sun_path, sizeof(address->sun_path), "%s/devon.sock", runtimeDir);
+	} else {
+		char folder[sizeof(address->sun_path)];
+		snprintf(folder, sizeof(folder), "/tmp/devon-%u", (unsigned) getuid());
+		if (!MakePrivateFolder(folder)) {
+			return false;
+		}
+		len = snprintf(address->sun_path, sizeof(address->sun_path), "%s/devon.sock", folder);
+	}
+	return len > 0 && (size_t) len < sizeof(address->sun_path);
+}
+
+// whoever is on the other end of a connected socket must be us
+bool PeerIsUs(int fd) {
+	uid_t peer;
+#if defined(SO_PEERCRED)
+	ucred cred{};
+	socklen_t len = sizeof(cred);
+	if (getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cred, &len) != 0) {
+		return false;
+	}
+	peer = cred.uid;
+#else
+	gid_t gid;
+	if (getpeereid(fd, &peer, &gid) != 0) {
+		return false;
+	}
+#endif
+	return peer == getuid();
+}
+
+int Connect(sockaddr_un const *address) {
+	int const fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (fd < 0) {
+		return -1;
+	}
+	if (connect(fd, (sockaddr const *) address, sizeof(sockaddr_un)) != 0) {
+		close(fd);
+		return -1;
+	}
+	return fd;
+}
+
+bool WriteAll(int fd, char const *data, size_t size) {
+	while (size) {
+		ssize_t const written = write(fd, data, size);
+		if (written < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return false;
+		}
+		data += written;
+		size -= (size_t) written;
+	}
+	return true;
+}
+
+void ReceivePaths(int fd, SingleInstance_PathCallback callback, void *userData) {
+	timeval timeout{0, CLIENT_RECEIVE_TIMEOUT_MS * 1000};
+	setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+	char path[MAX_FORWARDED_PATH_LENGTH];
+	size_t len = 0;
+	bool overflowed = false;
+	char buffer[4096];
+	for (;;) {
+		ssize_t const count = read(fd, buffer, sizeof(buffer));
+		if (count < 0 && errno == EINTR) {
+			continue;
+		}
+		if (count <= 0) {
+			break;
+		}
+		for (ssize_t i = 0; i < count; ++i) {
+			if (buffer[i] != 0) {
+				if (len + 1 < MAX_FORWARDED_PATH_LENGTH) {
+					path[len++] = buffer[i];
+				} else {
+					overflowed = true;
+				}
+				continue;
+			}
+			path[len] = 0;
+			if (overflowed) {
+				LOGINFO("Forwarded path too long, ignored");
+			} else if (len) {
+				callback(userData, path);
+			}
+			len = 0;
+			overflowed = false;
+		}
+	}
+}
+
+} // end anon namespace
+
+bool SingleInstance_ForwardToRunning(int argc, char const *argv[]) {
+	sockaddr_un address;
+	if (!AddressOf(&address)) {
+		return false;
+	}
+	int const fd = Connect(&address);
+	if (fd < 0) {
+		return false;
+	}
+	if (!PeerIsUs(fd)) {
+		LOGWARNING("%s is held by another user, not forwarding to it", address.sun_path);
+		close(fd);
+		return false;
+	}
+
+	// the running instance has its own working directory so send absolute paths
+	bool ok = true;
+	for (int i = 1; i < argc && ok; ++i) {
+		if (strncmp(argv[i], "--", 2) == 0) {
+			continue;
+		}
+		char absolutePath[PATH_MAX];
+		char const *path = realpath(argv[i], absolutePath) ? absolutePath : argv[i];
+		ok = WriteAll(fd, path, strlen(path) + 1);
+	}
+	close(fd);
+	return ok;
+}
+
+bool SingleInstance_Listen() {
+	if (listenSocket >= 0) {
+		return true;
+	}
+	if (!AddressOf(&listenAddress)) {
+		return false;
+	}
+
+	int const fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (fd < 0) {
+		return false;
+	}
+	if (bind(fd, (sockaddr const *) &listenAddress, sizeof(sockaddr_un)) != 0) {
+		if (errno != EADDRINUSE) {
+			close(fd);
+			return false;
+		}
+		// something answering means another instance beat us to it, otherwise its left over from a crash
+		int const other = Connect(&listenAddress);
+		if (other >= 0) {
+			close(other);
+			close(fd);
+			return false;
+		}
+		unlink(listenAddress.sun_path);
+		if (bind(fd, (sockaddr const *) &listenAddress, sizeof(sockaddr_un)) != 0) {
+			close(fd);
+			return false;
+		}
+	}
+	chmod(listenAddress.sun_path, S_IRUSR | S_IWUSR);
+
+	if (listen(fd, MAX_CONNECTIONS_PER_POLL) != 0 ||
+			fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK) != 0) {
+		close(fd);
+		unlink(listenAddress.sun_path);
+		return false;
+	}
+
+	listenSocket = fd;
+	LOGINFO("Single instance listening on %s", listenAddress.sun_path);
+	return true;
+}
+
+void SingleInstance_Poll(SingleInstance_PathCallback callback, void *userData) {
+	if (listenSocket < 0) {
+		return;
+	}
+
+	for (int i = 0; i < MAX_CONNECTIONS_PER_POLL; ++i) {
+		int const client = accept(listenSocket, nullptr, nullptr);
+		if (client < 0) {
+			return;
+		}
+		if (!PeerIsUs(client)) {
+			LOGWARNING("Ignoring a connection from another user");
+			close(client);
+			continue;
+		}
+		// accepted sockets don't inherit non blocking on linux but may elsewhere
+		fcntl(client, F_SETFL, fcntl(client, F_GETFL) & ~O_NONBLOCK);
+		ReceivePaths(client, callback, userData);
+		close(client);
+	}
+}
+
+void SingleInstance_Shutdown() {
+	if (listenSocket < 0) {
+		return;
+	}
+	close(listenSocket);
+	unlink(listenAddress.sun_path);
+	listenSocket = -1;
+}
+
+#endif
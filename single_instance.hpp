@@ -0,0 +1,22 @@
+#pragma once
+#ifndef DEVON_SINGLE_INSTANCE_HPP
+#define DEVON_SINGLE_INSTANCE_HPP
+
+// Lets later launches hand their files to an already running devon over a
+// per user Unix domain socket instead of starting a whole new renderer.
+// Only implemented for POSIX, elsewhere every launch is its own instance.
+
+// call before any heavy init. Sends the absolute paths of the non -- arguments to
+// a running instance, true if one took them (and this process should exit)
+bool SingleInstance_ForwardToRunning(int argc, char const *argv[]);
+
+// become the instance others forward to, a stale socket from a crash is replaced
+bool SingleInstance_Listen();
+
+// non blocking, call once a frame. Calls back for each path received
+typedef void (*SingleInstance_PathCallback)(void *userData, char const *path);
+void SingleInstance_Poll(SingleInstance_PathCallback callback, void *userData);
+
+void SingleInstance_Shutdown();
+
+#endif //DEVON_SINGLE_INSTANCE_HPP
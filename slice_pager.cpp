@@ -0,0 +1,406 @@
+#include "al2o3_platform/platform.h"
+#include "al2o3_memory/memory.h"
+#include "gfx_image/image.h"
+#include "render_basics/texture.h"
+
+#include "slice_pager.hpp"
+#include "frames_in_flight.hpp"
+#include "redraw.hpp"
+
+// arrays bigger than this are paged a ring of slices at a time
+static const uint64_t SLICE_PAGING_THRESHOLD_BYTES = 256 * 1024 * 1024;
+// GPU texture creation is synchronous so limit how many we do each frame
+static const uint32_t MAX_UPLOADS_PER_UPDATE = 2;
+
+namespace {
+
+enum SlotState {
+	SS_FREE,
+	SS_STAGING,		// worker is copying the slice into staging
+	SS_STAGED,		// staging ready, waiting for main thread upload
+	SS_RESIDENT,	// texture is valid
+};
+
+struct PagerSlot {
+	SlicePager *pager;
+	SlotState state;
+	uint32_t slice;
+	uint8_t *staging;
+	enkiTaskSetHandle task;
+	Render_TextureHandle texture;
+};
+
+} // end anon namespace
+
+struct SlicePager {
+	Render_RendererHandle renderer;
+	enkiTaskSchedulerHandle taskScheduler;
+	Image_ImageHeader const *image;
+
+	uint32_t mipCount;
+	uint64_t sliceByteCount; // for all mip levels of a slice
+
+	uint32_t currentSlice;
+	int32_t direction;
+	bool suspended;
+
+	uint32_t ringSize;
+	PagerSlot *slots;
+};
+
+namespace {
+
+uint64_t ByteCountOfImageChain(Image_ImageHeader const *image) {
+	uint64_t total = 0;
+	for (size_t level = 0; level < Image_MipMapCountOf(image); ++level) {
+		total += Image_ByteCountOf(Image_LinkedImageOf(image, level));
+	}
+	return total;
+}
+
+void StageSliceTask(uint32_t start, uint32_t end, uint32_t threadnum, void *args) {
+	auto slot = (PagerSlot *) args;
+	SlicePager const *pager = slot->pager;
+
+	uint8_t *dst = slot->staging;
+	for (uint32_t level = 0; level < pager->mipCount; ++level) {
+		Image_ImageHeader const *levelImage = Image_LinkedImageOf(pager->image, level);
+		uint64_t const sliceBytes = Image_ByteCountOf(levelImage) / levelImage->slices;
+		auto src = (uint8_t const *) Image_RawDataPtr(levelImage);
+		memcpy(dst, src + (slot->slice * sliceBytes), sliceBytes);
+		dst += sliceBytes;
+	}
+	Redraw_MarkDirty();
+}
+
+// how much we'd like to keep a slice, slices behind the direction of travel are worth less
+uint32_t CostOf(SlicePager const *pager, uint32_t slice) {
+	int32_t const delta = (int32_t) slice - (int32_t) pager->currentSlice;
+	uint32_t const distance = (uint32_t) (delta < 0 ? -delta : delta);
+	if (delta == 0 || (delta > 0) == (pager->direction > 0)) {
+		return distance;
+	}
+	return distance * 2;
+}
+
+PagerSlot *FindSlot(SlicePager *pager, uint32_t slice) {
+	for (uint32_t i = 0; i < pager->ringSize; ++i) {
+		PagerSlot *slot = pager->slots + i;
+		if (slot->state != SS_FREE && slot->slice == slice) {
+			return slot;
+		}
+	}
+	return nullptr;
+}
+
+PagerSlot *FindVictim(SlicePager *pager, uint32_t wantedCost) {
+	PagerSlot *victim = nullptr;
+	uint32_t victimCost = wantedCost;
+	for (uint32_t i = 0; i < pager->ringSize; ++i) {
+		PagerSlot *slot = pager->slots + i;
+		if (slot->state == SS_FREE) {
+			return slot;
+		}
+		if (slot->state == SS_STAGING) {
+			continue;
+		}
+		uint32_t const cost = CostOf(pager, slot->slice);
+		if (cost > victimCost) {
+			victim = slot;
+			victimCost = cost;
+		}
+	}
+	return victim;
+}
+
+// a big jump of the slider can evict the slice the last frame drew with, so retire it
+void ReleaseSlot(SlicePager *pager, PagerSlot *slot) {
+	ASSERT(slot->state != SS_STAGING);
+	if (slot->state == SS_RESIDENT) {
+		FramesInFlight_DestroyTexture(pager->renderer, slot->texture);
+		slot->texture = {};
+	}
+	slot->state = SS_FREE;
+}
+
+void RequestSlice(SlicePager *pager, uint32_t slice) {
+	if (FindSlot(pager, slice)) {
+		return;
+	}
+
+	PagerSlot *slot = FindVictim(pager, CostOf(pager, slice));
+	if (!slot) {
+		return;
+	}
+	ReleaseSlot(pager, slot);
+
+	slot->slice = slice;
+	slot->state = SS_STAGING;
+	enkiAddTaskSetToPipe(pager->taskScheduler, slot->task, slot, 1);
+}
+
+// current slice first then ahead in the direction of travel then a few behind
+void Schedule(SlicePager *pager) {
+	if (pager->suspended) {
+		return;
+	}
+
+	uint32_t const numSlices = pager->image->slices;
+	uint32_t const behind = pager->ringSize / 4;
+	uint32_t const ahead = pager->ringSize - 1 - behind;
+
+	RequestSlice(pager, pager->currentSlice);
+	for (uint32_t i = 1; i <= ahead; ++i) {
+		int32_t const slice = (int32_t) pager->currentSlice + (pager->direction * (int32_t) i);
+		if (slice < 0 || slice >= (int32_t) numSlices) {
+			break;
+		}
+		RequestSlice(pager, (uint32_t) slice);
+	}
+	for (uint32_t i = 1; i <= behind; ++i) {
+		int32_t const slice = (int32_t) pager->currentSlice - (pager->direction * (int32_t) i);
+		if (slice < 0 || slice >= (int32_t) numSlices) {
+			break;
+		}
+		RequestSlice(pager, (uint32_t) slice);
+	}
+}
+
+void Upload(SlicePager *pager, PagerSlot *slot) {
+	ASSERT(slot->state == SS_STAGED);
+	Image_ImageHeader const *image = pager->image;
+
+	Render_TextureCreateDesc const createGPUDesc{
+			image->format,
+			Render_TUF_SHADER_READ,
+			image->width,
+			image->height,
+			image->depth,
+			1,
+			pager->mipCount,
+			0,
+			0,
+			slot->staging
+	};
+
+	slot->texture = Render_TextureSyncCreate(pager->renderer, &createGPUDesc);
+	slot->state = SS_RESIDENT;
+}
+
+} // end anon namespace
+
+bool SlicePager_ShouldPage(Image_ImageHeader const *image) {
+	if (!image || !Image_IsArray(image) || Image_HasPackedMipMaps(image)) {
+		return false;
+	}
+	return ByteCountOfImageChain(image) > SLICE_PAGING_THRESHOLD_BYTES;
+}
+
+SlicePagerHandle SlicePager_Create(Render_RendererHandle renderer,
+																	 enkiTaskSchedulerHandle taskScheduler,
+																	 Image_ImageHeader const *image,
+																	 uint32_t ringSize) {
+	ASSERT(image);
+	ASSERT(!Image_HasPackedMipMaps(image));
+
+	auto pager = (SlicePager *) MEMORY_CALLOC(1, sizeof(SlicePager));
+	if (!pager) {
+		return nullptr;
+	}
+
+	pager->renderer = renderer;
+	pager->taskScheduler = taskScheduler;
+	pager->image = image;
+	pager->mipCount = (uint32_t) Image_MipMapCountOf(image);
+	pager->sliceByteCount = ByteCountOfImageChain(image) / image->slices;
+	pager->direction = 1;
+	pager->ringSize = ringSize < image->slices ? ringSize : image->slices;
+
+	pager->slots = (PagerSlot *) MEMORY_CALLOC(pager->ringSize, sizeof(PagerSlot));
+	if (!pager->slots) {
+		MEMORY_FREE(pager);
+		return nullptr;
+	}
+
+	for (uint32_t i = 0; i < pager->ringSize; ++i) {
+		PagerSlot *slot = pager->slots + i;
+		slot->pager = pager;
+		slot->staging = (uint8_t *) MEMORY_MALLOC(pager->sliceByteCount);
+		slot->task = enkiCreateTaskSet(taskScheduler, &StageSliceTask);
+		if (!slot->staging || !slot->task) {
+			SlicePager_Destroy(pager);
+			return nullptr;
+		}
+	}
+
+	Schedule(pager);
+
+	return pager;
+}
+
+void SlicePager_Destroy(SlicePagerHandle handle) {
+	auto pager = (SlicePager *) handle;
+	if (!pager) {
+		return;
+	}
+
+	for (uint32_t i = 0; i < pager->ringSize; ++i) {
+		PagerSlot *slot = pager->slots + i;
+		if (slot->task) {
+			enkiWaitForTaskSet(pager->taskScheduler, slot->task);
+			enkiDeleteTaskSet(slot->task);
+		}
+		if (slot->state == SS_RESIDENT) {
+			FramesInFlight_DestroyTexture(pager->renderer, slot->texture);
+		}
+		MEMORY_FREE(slot->staging);
+	}
+
+	MEMORY_FREE(pager->slots);
+	MEMORY_FREE(pager);
+}
+
+bool SlicePager_Update(SlicePagerHandle handle) {
+	auto pager = (SlicePager *) handle;
+	if (!pager) {
+		return false;
+	}
+
+	for (uint32_t i = 0; i < pager->ringSize; ++i) {
+		PagerSlot *slot = pager->slots + i;
+		if (slot->state == SS_STAGING && enkiIsTaskSetComplete(pager->taskScheduler, slot->task)) {
+			slot->state = SS_STAGED;
+		}
+	}
+
+	// upload the most wanted first so the current slice never waits behind prefetches
+	uint32_t uploads = 0;
+	for (; uploads < MAX_UPLOADS_PER_UPDATE; ++uploads) {
+		PagerSlot *best = nullptr;
+		for (uint32_t i = 0; i < pager->ringSize; ++i) {
+			PagerSlot *slot = pager->slots + i;
+			if (slot->state != SS_STAGED) {
+				continue;
+			}
+			if (!best || CostOf(pager, slot->slice) < CostOf(pager, best->slice)) {
+				best = slot;
+			}
+		}
+		if (!best) {
+			break;
+		}
+		Upload(pager, best);
+	}
+
+	Schedule(pager);
+
+	return uploads > 0;
+}
+
+void SlicePager_SetCurrentSlice(SlicePagerHandle handle, uint32_t slice) {
+	auto pager = (SlicePager *) handle;
+	if (!pager) {
+		return;
+	}
+
+	if (slice >= pager->image->slices) {
+		slice = pager->image->slices - 1;
+	}
+	if (slice == pager->currentSlice) {
+		return;
+	}
+
+	pager->direction = slice > pager->currentSlice ? 1 : -1;
+	pager->currentSlice = slice;
+
+	Schedule(pager);
+}
+
+namespace {
+
+PagerSlot *NearestResident(SlicePager *pager) {
+	PagerSlot *nearest = nullptr;
+	uint32_t nearestDistance = ~0u;
+	for (uint32_t i = 0; i < pager->ringSize; ++i) {
+		PagerSlot *slot = pager->slots + i;
+		if (slot->state != SS_RESIDENT) {
+			continue;
+		}
+		uint32_t const distance = slot->slice > pager->currentSlice ?
+															slot->slice - pager->currentSlice :
+															pager->currentSlice - slot->slice;
+		if (distance < nearestDistance) {
+			nearest = slot;
+			nearestDistance = distance;
+		}
+	}
+
+	return nearest;
+}
+
+} // end anon namespace
+
+Render_TextureHandle SlicePager_CurrentTexture(SlicePagerHandle handle) {
+	auto pager = (SlicePager *) handle;
+	if (!pager) {
+		return {};
+	}
+
+	PagerSlot *nearest = NearestResident(pager);
+	return nearest ? nearest->texture : Render_TextureHandle{};
+}
+
+uint32_t SlicePager_ShownSlice(SlicePagerHandle handle) {
+	auto pager = (SlicePager *) handle;
+	if (!pager) {
+		return 0;
+	}
+
+	PagerSlot *nearest = NearestResident(pager);
+	return nearest ? nearest->slice : pager->currentSlice;
+}
+
+void SlicePager_Suspend(SlicePagerHandle handle) {
+	auto pager = (SlicePager *) handle;
+	if (!pager) {
+		return;
+	}
+
+	pager->suspended = true;
+
+	for (uint32_t i = 0; i < pager->ringSize; ++i) {
+		PagerSlot *slot = pager->slots + i;
+		if (slot->state == SS_STAGING || slot->state == SS_FREE) {
+			continue;
+		}
+		if (slot->slice != pager->currentSlice) {
+			ReleaseSlot(pager, slot);
+		}
+	}
+}
+
+void SlicePager_Resume(SlicePagerHandle handle) {
+	auto pager = (SlicePager *) handle;
+	if (!pager) {
+		return;
+	}
+
+	pager->suspended = false;
+	Schedule(pager);
+}
+
+void SlicePager_MemoryUsage(SlicePagerHandle handle, uint64_t *cpuBytes, uint64_t *gpuBytes) {
+	auto pager = (SlicePager *) handle;
+	*cpuBytes = 0;
+	*gpuBytes = 0;
+	if (!pager) {
+		return;
+	}
+
+	*cpuBytes = sizeof(SlicePager) + (pager->ringSize * (sizeof(PagerSlot) + pager->sliceByteCount));
+	for (uint32_t i = 0; i < pager->ringSize; ++i) {
+		if (pager->slots[i].state == SS_RESIDENT) {
+			*gpuBytes += pager->sliceByteCount;
+		}
+	}
+}
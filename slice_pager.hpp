@@ -0,0 +1,39 @@
+#pragma once
+#ifndef DEVON_SLICE_PAGER_HPP
+#define DEVON_SLICE_PAGER_HPP
+
+#include "render_basics/api.h"
+#include "al2o3_enki/TaskScheduler_c.h"
+
+typedef struct SlicePager *SlicePagerHandle;
+struct Image_ImageHeader;
+
+// true if an array is big enough it should be paged in rather than uploaded whole
+bool SlicePager_ShouldPage(Image_ImageHeader const *image);
+
+// image must not have packed mipmaps and must outlive the pager
+SlicePagerHandle SlicePager_Create(Render_RendererHandle renderer,
+																	 enkiTaskSchedulerHandle taskScheduler,
+																	 Image_ImageHeader const *image,
+																	 uint32_t ringSize);
+void SlicePager_Destroy(SlicePagerHandle handle);
+
+// main thread once per frame, uploads slices the workers have finished staging
+// returns true if any new slice became resident
+bool SlicePager_Update(SlicePagerHandle handle);
+
+// moves the view, this also decides the prefetch direction
+void SlicePager_SetCurrentSlice(SlicePagerHandle handle, uint32_t slice);
+
+// a 2D texture of the current slice, or the nearest resident one whilst its paging in
+Render_TextureHandle SlicePager_CurrentTexture(SlicePagerHandle handle);
+// the slice CurrentTexture is of, the current slice if nothing is resident yet
+uint32_t SlicePager_ShownSlice(SlicePagerHandle handle);
+
+void SlicePager_MemoryUsage(SlicePagerHandle handle, uint64_t *cpuBytes, uint64_t *gpuBytes);
+
+// drops every resident slice except the current one and stops prefetching
+void SlicePager_Suspend(SlicePagerHandle handle);
+void SlicePager_Resume(SlicePagerHandle handle);
+
+#endif //DEVON_SLICE_PAGER_HPP
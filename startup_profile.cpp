@@ -0,0 +1,79 @@
+#include "al2o3_platform/platform.h"
+#include "al2o3_os/time.h"
+
+#include "startup_profile.hpp"
+
+static const uint32_t MAX_PHASES = 32;
+// launch to first present, over this and we say so every run
+static const int64_t TIME_TO_FIRST_FRAME_BUDGET_US = 500000;
+
+namespace {
+
+struct Phase {
+	char const *name;
+	int64_t startUs;
+};
+
+Phase phases[MAX_PHASES];
+uint32_t phaseCount = 0;
+int64_t firstFrameUs = 0;
+bool report = false;
+bool complete = false;
+
+double ToMs(int64_t us) {
+	return (double) us / 1000.0;
+}
+
+void Report(int64_t totalUs) {
+	LOGINFO("Startup report");
+	for (uint32_t i = 0; i < phaseCount; ++i) {
+		int64_t const endUs = (i + 1 < phaseCount) ? phases[i + 1].startUs : firstFrameUs;
+		int64_t const us = endUs - phases[i].startUs;
+		LOGINFO("  %-24s %8.2f ms %5.1f%%", phases[i].name, ToMs(us),
+						totalUs ? (100.0 * (double) us) / (double) totalUs : 0.0);
+	}
+	LOGINFO("  %-24s %8.2f ms (budget %.0f ms)", "time to first frame", ToMs(totalUs),
+					ToMs(TIME_TO_FIRST_FRAME_BUDGET_US));
+}
+
+} // end anon namespace
+
+void StartupProfile_Phase(char const *name) {
+	if (complete) {
+		return;
+	}
+	// past the table just extend the last phase
+	if (phaseCount == MAX_PHASES) {
+		return;
+	}
+	phases[phaseCount].name = name;
+	phases[phaseCount].startUs = Os_GetUSec();
+	phaseCount++;
+}
+
+void StartupProfile_EnableReport() {
+	report = true;
+}
+
+void StartupProfile_FirstFrame() {
+	if (complete || phaseCount == 0) {
+		return;
+	}
+	complete = true;
+	firstFrameUs = Os_GetUSec();
+
+	int64_t const totalUs = firstFrameUs - phases[0].startUs;
+	if (report) {
+		Report(totalUs);
+	}
+	if (totalUs > TIME_TO_FIRST_FRAME_BUDGET_US) {
+		LOGWARNING("Time to first frame %.2f ms is over the %.0f ms budget%s", ToMs(totalUs),
+							 ToMs(TIME_TO_FIRST_FRAME_BUDGET_US), report ? "" : ", --startup-report for details");
+	} else {
+		LOGINFO("Time to first frame %.2f ms", ToMs(totalUs));
+	}
+}
+
+bool StartupProfile_IsComplete() {
+	return complete;
+}
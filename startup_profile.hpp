@@ -0,0 +1,19 @@
+#pragma once
+#ifndef DEVON_STARTUP_PROFILE_HPP
+#define DEVON_STARTUP_PROFILE_HPP
+
+// Times startup phase by phase up to the first presented frame. Phases run back
+// to back, starting one ends the last. Time to first frame is always checked
+// against a budget, the per phase table is only logged when asked for.
+
+// names must outlive the profile (literals). The first call starts the clock
+void StartupProfile_Phase(char const *name);
+
+// log the phase table when the first frame lands
+void StartupProfile_EnableReport();
+
+// call after presenting, only the first call does anything
+void StartupProfile_FirstFrame();
+bool StartupProfile_IsComplete();
+
+#endif //DEVON_STARTUP_PROFILE_HPP
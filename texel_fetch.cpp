@@ -0,0 +1,249 @@
+#include "al2o3_platform/platform.h"
+#include "al2o3_memory/memory.h"
+#include "gfx_image/image.h"
+#include "gfx_imagedecompress/imagedecompress.h"
+#include "tiny_imageformat/tinyimageformat_decode.h"
+
+#include "texel_fetch.hpp"
+#include "texture_bytes.hpp"
+#include "bc6h.hpp"
+
+// direct mapped, a power of 2. Enough for a few neighbourhoods of hovering
+static const uint32_t BLOCK_CACHE_SIZE = 32;
+// biggest block is 12x12 ASTC
+static const uint32_t MAX_BLOCK_TEXELS = 12 * 12;
+static const uint32_t MAX_PLANES = 3;
+
+struct CachedBlock {
+	uint64_t key;
+	bool valid;
+	float texels[MAX_BLOCK_TEXELS * 4];
+};
+
+struct TexelFetch {
+	Image_ImageHeader const *source;
+	bool owned;
+
+	// only compressed formats use the cache, allocated on the first fetch
+	CachedBlock *cache;
+};
+
+namespace {
+
+uint64_t BlockKey(uint32_t bx, uint32_t by, uint32_t slice, uint32_t mipLevel) {
+	return ((uint64_t) mipLevel << 56) | ((uint64_t) (slice & 0xFFFF) << 40) |
+			((uint64_t) (by & 0xFFFFF) << 20) | (uint64_t) (bx & 0xFFFFF);
+}
+
+// decodes a whole block to float RGBA, BC6H directly everything else via a block sized image
+bool DecodeBlock(TinyImageFormat format, uint8_t const *block, float *texels) {
+	uint32_t const bw = TinyImageFormat_WidthOfBlock(format);
+	uint32_t const bh = TinyImageFormat_HeightOfBlock(format);
+
+	if (Bc6h_IsBc6h(format)) {
+		uint16_t halfs[16 * 4];
+		Bc6h_DecodeBlock(block, format == TinyImageFormat_DXBC6H_SFLOAT, halfs);
+		TinyImageFormat_DecodeInput input{};
+		input.pixel = halfs;
+		return TinyImageFormat_DecodeLogicalPixelsF(TinyImageFormat_R16G16B16A16_SFLOAT, &input, 16, texels);
+	}
+
+	Image_ImageHeader *image = Image_Create(bw, bh, 1, 1, format);
+	if (!image) {
+		return false;
+	}
+	memcpy(Image_RawDataPtr(image), block, TinyImageFormat_BitSizeOfBlock(format) / 8);
+	Image_ImageHeader const *decompressed = Image_Decompress(image);
+	Image_Destroy(image);
+	if (!decompressed || decompressed == image) {
+		return false;
+	}
+
+	bool ok = TinyImageFormat_CanDecodeLogicalPixelsF(decompressed->format);
+	if (ok) {
+		TinyImageFormat_DecodeInput input{};
+		input.pixel = Image_RawDataPtr(decompressed);
+		ok = TinyImageFormat_DecodeLogicalPixelsF(decompressed->format, &input, bw * bh, texels);
+	}
+	Image_Destroy(decompressed);
+	return ok;
+}
+
+bool FetchCompressed(TexelFetch *fetch,
+										 Image_ImageHeader const *level,
+										 uint32_t x, uint32_t y, uint32_t slice, uint32_t mipLevel,
+										 TexelFetch_Texel *out) {
+	TinyImageFormat const format = level->format;
+	uint32_t const bw = TinyImageFormat_WidthOfBlock(format);
+	uint32_t const bh = TinyImageFormat_HeightOfBlock(format);
+	uint32_t const blockBytes = TinyImageFormat_BitSizeOfBlock(format) / 8;
+	if (bw * bh > MAX_BLOCK_TEXELS || blockBytes > sizeof(out->raw)) {
+		return false;
+	}
+
+	uint32_t const blocksWide = (level->width + bw - 1) / bw;
+	uint32_t const blocksHigh = (level->height + bh - 1) / bh;
+	uint32_t const bx = x / bw;
+	uint32_t const by = y / bh;
+	uint64_t const sliceBytes = (uint64_t) blocksWide * blocksHigh * level->depth * blockBytes;
+	auto const block = (uint8_t const *) Image_RawDataPtr(level) + (slice * sliceBytes) +
+			(((uint64_t) by * blocksWide) + bx) * blockBytes;
+
+	memcpy(out->raw, block, blockBytes);
+	out->rawSize = blockBytes;
+
+	if (!fetch->cache) {
+		fetch->cache = (CachedBlock *) MEMORY_CALLOC(BLOCK_CACHE_SIZE, sizeof(CachedBlock));
+		if (!fetch->cache) {
+			return false;
+		}
+	}
+
+	uint64_t const key = BlockKey(bx, by, slice, mipLevel);
+	CachedBlock *cached = fetch->cache + ((bx ^ (by * 7) ^ (slice * 13) ^ (mipLevel * 31)) & (BLOCK_CACHE_SIZE - 1));
+	if (!cached->valid || cached->key != key) {
+		cached->valid = DecodeBlock(format, block, cached->texels);
+		cached->key = key;
+		if (!cached->valid) {
+			return false;
+		}
+	}
+
+	float const *texel = cached->texels + (((y % bh) * bw) + (x % bw)) * 4;
+	for (uint32_t c = 0; c < 4; ++c) {
+		out->channels[c] = texel[c];
+	}
+	return true;
+}
+
+// packed and planar formats, each plane is stored whole after the previous one
+bool FetchUncompressed(Image_ImageHeader const *level,
+											 uint32_t x, uint32_t y, uint32_t slice,
+											 TexelFetch_Texel *out) {
+	TinyImageFormat const format = level->format;
+	if (!TinyImageFormat_CanDecodeLogicalPixelsD(format)) {
+		return false;
+	}
+
+	uint32_t const planeCount = TinyImageFormat_NumOfPlanes(format);
+	if (planeCount > MAX_PLANES) {
+		return false;
+	}
+
+	TinyImageFormat_DecodeInput input{};
+	out->rawSize = 0;
+	if (planeCount <= 1) {
+		uint32_t const pixelBits = TinyImageFormat_BitSizeOfBlock(format);
+		if ((pixelBits % 8) != 0 || pixelBits / 8 > sizeof(out->raw)) {
+			return false;
+		}
+		uint32_t const pixelBytes = pixelBits / 8;
+		uint64_t const sliceBytes = (uint64_t) level->width * level->height * level->depth * pixelBytes;
+		auto const pixel = (uint8_t const *) Image_RawDataPtr(level) + (slice * sliceBytes) +
+				(((uint64_t) y * level->width) + x) * pixelBytes;
+		memcpy(out->raw, pixel, pixelBytes);
+		out->rawSize = pixelBytes;
+		input.pixel = pixel;
+	} else {
+		uint8_t const *planes[MAX_PLANES] = {};
+		uint64_t sliceBytes = 0;
+		for (uint32_t p = 0; p < planeCount; ++p) {
+			uint32_t const pw = level->width / TinyImageFormat_PlaneWidthScale(format, p);
+			uint32_t const ph = level->height / TinyImageFormat_PlaneHeightScale(format, p);
+			sliceBytes += (uint64_t) pw * ph * TinyImageFormat_PlaneSizeOfBlock(format, p);
+		}
+
+		auto base = (uint8_t const *) Image_RawDataPtr(level) + (slice * sliceBytes * level->depth);
+		for (uint32_t p = 0; p < planeCount; ++p) {
+			uint32_t const ws = TinyImageFormat_PlaneWidthScale(format, p);
+			uint32_t const hs = TinyImageFormat_PlaneHeightScale(format, p);
+			uint32_t const pw = level->width / ws;
+			uint32_t const ph = level->height / hs;
+			uint32_t const pixelBytes = TinyImageFormat_PlaneSizeOfBlock(format, p);
+			planes[p] = base + (((uint64_t) (y / hs) * pw) + (x / ws)) * pixelBytes;
+			if (out->rawSize + pixelBytes <= sizeof(out->raw)) {
+				memcpy(out->raw + out->rawSize, planes[p], pixelBytes);
+				out->rawSize += pixelBytes;
+			}
+			base += (uint64_t) pw * ph * pixelBytes;
+		}
+		input.pixelPlane0 = planes[0];
+		input.pixelPlane1 = planes[1];
+		input.pixelPlane2 = planes[2];
+	}
+
+	return TinyImageFormat_DecodeLogicalPixelsD(format, &input, 1, out->channels);
+}
+
+} // end anon namespace
+
+TexelFetchHandle TexelFetch_Create(Image_ImageHeader const *source, bool owned) {
+	if (!source) {
+		return nullptr;
+	}
+
+	auto fetch = (TexelFetch *) MEMORY_CALLOC(1, sizeof(TexelFetch));
+	if (!fetch) {
+		if (owned) {
+			Image_Destroy(source);
+		}
+		return nullptr;
+	}
+	fetch->source = source;
+	fetch->owned = owned;
+	return fetch;
+}
+
+void TexelFetch_Destroy(TexelFetchHandle handle) {
+	auto fetch = (TexelFetch *) handle;
+	if (!fetch) {
+		return;
+	}
+	if (fetch->owned) {
+		Image_Destroy(fetch->source);
+	}
+	MEMORY_FREE(fetch->cache);
+	MEMORY_FREE(fetch);
+}
+
+TinyImageFormat TexelFetch_Format(TexelFetchHandle handle) {
+	auto fetch = (TexelFetch *) handle;
+	return fetch ? fetch->source->format : TinyImageFormat_UNDEFINED;
+}
+
+uint64_t TexelFetch_MemoryUsage(TexelFetchHandle handle) {
+	auto fetch = (TexelFetch *) handle;
+	if (!fetch) {
+		return 0;
+	}
+	uint64_t total = sizeof(TexelFetch);
+	if (fetch->owned) {
+		total += TextureBytes_OfImage(fetch->source);
+	}
+	if (fetch->cache) {
+		total += sizeof(CachedBlock) * BLOCK_CACHE_SIZE;
+	}
+	return total;
+}
+
+bool TexelFetch_Fetch(TexelFetchHandle handle,
+											uint32_t x,
+											uint32_t y,
+											uint32_t slice,
+											uint32_t mipLevel,
+											TexelFetch_Texel *out) {
+	auto fetch = (TexelFetch *) handle;
+	if (!fetch || !out || mipLevel >= Image_MipMapCountOf(fetch->source)) {
+		return false;
+	}
+
+	Image_ImageHeader const *level = Image_LinkedImageOf(fetch->source, mipLevel);
+	if (x >= level->width || y >= level->height || slice >= level->slices) {
+		return false;
+	}
+
+	if (TinyImageFormat_IsCompressed(level->format)) {
+		return FetchCompressed(fetch, level, x, y, slice, mipLevel, out);
+	}
+	return FetchUncompressed(level, x, y, slice, out);
+}
@@ -0,0 +1,35 @@
+#pragma once
+#ifndef DEVON_TEXEL_FETCH_HPP
+#define DEVON_TEXEL_FETCH_HPP
+
+#include "gfx_image/image.h"
+
+// Random access reads of single texels from an image as it was stored, before any
+// conversion to something the GPU can sample. Only the pixel (or for compressed
+// formats the block) asked for is decoded, recent blocks are cached so hovering
+// around a compressed texture costs a decode per new block.
+typedef struct TexelFetch *TexelFetchHandle;
+
+typedef struct TexelFetch_Texel {
+	double channels[4]; // logical RGBA as tiny_imageformat decodes it
+	uint8_t raw[16]; // the stored bytes of the pixel, or of the whole block when compressed
+	uint32_t rawSize;
+} TexelFetch_Texel;
+
+// source is the image as loaded (packed or not). owned sources are destroyed with the fetcher
+TexelFetchHandle TexelFetch_Create(Image_ImageHeader const *source, bool owned);
+void TexelFetch_Destroy(TexelFetchHandle handle);
+
+TinyImageFormat TexelFetch_Format(TexelFetchHandle handle);
+// the owned source and the block cache
+uint64_t TexelFetch_MemoryUsage(TexelFetchHandle handle);
+
+// x and y are in texels of mipLevel. False if out of range or the format can't be decoded
+bool TexelFetch_Fetch(TexelFetchHandle handle,
+											uint32_t x,
+											uint32_t y,
+											uint32_t slice,
+											uint32_t mipLevel,
+											TexelFetch_Texel *out);
+
+#endif //DEVON_TEXEL_FETCH_HPP
@@ -0,0 +1,37 @@
+#pragma once
+#ifndef DEVON_TEXTURE_BYTES_HPP
+#define DEVON_TEXTURE_BYTES_HPP
+
+#include "gfx_image/image.h"
+
+// Bytes a texture needs for the given shape, all mips and slices, independent
+// of whether an image stores its mips packed or as a linked chain
+inline uint64_t TextureBytes_Of(TinyImageFormat format,
+																uint32_t width, uint32_t height, uint32_t depth,
+																uint32_t slices, uint32_t mipCount) {
+	uint32_t const bw = TinyImageFormat_WidthOfBlock(format);
+	uint32_t const bh = TinyImageFormat_HeightOfBlock(format);
+	uint32_t const bd = TinyImageFormat_DepthOfBlock(format);
+	uint64_t const blockBytes = TinyImageFormat_BitSizeOfBlock(format) / 8;
+
+	uint64_t total = 0;
+	for (uint32_t level = 0; level < mipCount; ++level) {
+		uint32_t const w = (width >> level) ? (width >> level) : 1;
+		uint32_t const h = (height >> level) ? (height >> level) : 1;
+		uint32_t const d = (depth >> level) ? (depth >> level) : 1;
+		uint64_t const blocks = (uint64_t) ((w + bw - 1) / bw) * ((h + bh - 1) / bh) * ((d + bd - 1) / bd);
+		total += blocks * blockBytes;
+	}
+	return total * slices;
+}
+
+inline uint64_t TextureBytes_OfImage(Image_ImageHeader const *image) {
+	if (!image) {
+		return 0;
+	}
+	return TextureBytes_Of(image->format,
+												 image->width, image->height, image->depth,
+												 image->slices, (uint32_t) Image_MipMapCountOf(image));
+}
+
+#endif //DEVON_TEXTURE_BYTES_HPP
@@ -0,0 +1,285 @@
+#include "al2o3_platform/platform.h"
+#include "al2o3_memory/memory.h"
+#include "gfx_imageio/io.h"
+#include "gfx_image/utils.h"
+#include "gfx_imagedecompress/imagedecompress.h"
+#include "render_basics/texture.h"
+
+#include "texture_load.hpp"
+#include "texture_bytes.hpp"
+#include "bc6h.hpp"
+#include "slice_pager.hpp"
+#include "frames_in_flight.hpp"
+
+// hashing streams the file through a buffer this big, a multiple of 8 for the hash
+static const size_t READ_CHUNK_SIZE = 1024 * 1024;
+
+namespace {
+
+// block compressed originals are always kept, they're a quarter to an eighth the size
+// of their conversion. Uncompressed ones cost as much again so only when asked for
+bool keepSource = false;
+
+// 64 bit content hash, 8 bytes a step with a murmur style finish. Only needs to tell
+// files apart not resist attack, and sizes are compared as well
+struct ContentHash {
+	uint64_t h;
+	uint64_t length;
+};
+
+const uint64_t HASH_PRIME_1 = 0x9E3779B185EBCA87ULL;
+const uint64_t HASH_PRIME_2 = 0xC2B2AE3D27D4EB4FULL;
+
+uint64_t RotateLeft(uint64_t v, int r) {
+	return (v << r) | (v >> (64 - r));
+}
+
+uint64_t Mix(uint64_t h, uint64_t v) {
+	return RotateLeft(h ^ (v * HASH_PRIME_2), 31) * HASH_PRIME_1;
+}
+
+// every update but the last must be a multiple of 8 bytes
+void ContentHash_Update(ContentHash *hash, uint8_t const *data, size_t size) {
+	size_t i = 0;
+	for (; i + 8 <= size; i += 8) {
+		uint64_t v;
+		memcpy(&v, data + i, 8);
+		hash->h = Mix(hash->h, v);
+	}
+	if (i < size) {
+		uint64_t v = 0;
+		memcpy(&v, data + i, size - i);
+		hash->h = Mix(hash->h, v);
+	}
+	hash->length += size;
+}
+
+uint64_t ContentHash_Final(ContentHash *hash) {
+	uint64_t h = Mix(hash->h, hash->length);
+	h ^= h >> 33;
+	h *= 0xFF51AFD7ED558CCDULL;
+	h ^= h >> 33;
+	h *= 0xC4CEB9FE1A85EC53ULL;
+	h ^= h >> 33;
+	return h;
+}
+
+} // end anon namespace
+
+void TextureLoad_SetKeepSource(bool keep) {
+	keepSource = keep;
+}
+
+void TextureLoad_StatsImageCreated(TextureLoad_Stats *stats, Image_ImageHeader const *image) {
+	if (!stats || !image) {
+		return;
+	}
+	stats->imageAllocations++;
+	stats->liveImageBytes += TextureBytes_OfImage(image);
+	if (stats->liveImageBytes > stats->peakImageBytes) {
+		stats->peakImageBytes = stats->liveImageBytes;
+	}
+}
+
+void TextureLoad_StatsImageDestroyed(TextureLoad_Stats *stats, Image_ImageHeader const *image) {
+	if (!stats) {
+		return;
+	}
+	uint64_t const bytes = TextureBytes_OfImage(image);
+	stats->liveImageBytes = bytes < stats->liveImageBytes ? stats->liveImageBytes - bytes : 0;
+}
+
+Image_ImageHeader const *TextureLoad_Decode(Render_RendererHandle renderer,
+																						enkiTaskSchedulerHandle taskScheduler,
+																						VFile_Handle fh,
+																						char const *name,
+																						TextureLoad_Stats *stats,
+																						TinyImageFormat *originalFormat,
+																						bool *gpuNative,
+																						Image_ImageHeader const **source) {
+	if (source) {
+		*source = nullptr;
+	}
+	Image_ImageHeader const *image = Image_Load(fh);
+	TextureLoad_StatsImageCreated(stats, image);
+	if (!image) {
+		LOGINFO("Image_Load failed for %s", name);
+		return nullptr;
+	}
+
+	*originalFormat = image->format;
+	bool const supported = Render_RendererCanShaderReadFrom(renderer, image->format);
+	*gpuNative = supported;
+
+	// force CPU for testing
+	// supported = false;
+
+	if (supported) {
+		return image;
+	}
+
+	// convert to R8G8B8A8 for now
+	Image_ImageHeader const *converted;
+	if (!TinyImageFormat_IsCompressed(image->format)) {
+		if (TinyImageFormat_IsSigned(image->format)) {
+			converted = Image_FastConvert(image, TinyImageFormat_R8G8B8A8_SNORM, true);
+		} else {
+			converted = Image_FastConvert(image, TinyImageFormat_R8G8B8A8_UNORM, true);
+		}
+	} else {
+		// gfx_imagedecompress doesn't do BC6H
+		converted = Bc6h_IsBc6h(image->format) ? Bc6h_Decode(image, taskScheduler) : Image_Decompress(image);
+		if (converted == nullptr || converted == image) {
+			LOGINFO("%s with format %s isn't supported by this GPU/backend and can't be converted",
+							name,
+							TinyImageFormat_Name(image->format));
+			TextureLoad_StatsImageDestroyed(stats, image);
+			Image_Destroy(image);
+			return nullptr;
+		}
+	}
+
+	if (converted && converted != image) {
+		TextureLoad_StatsImageCreated(stats, converted);
+		if (source) {
+			*source = image;
+		} else {
+			TextureLoad_StatsImageDestroyed(stats, image);
+			Image_Destroy(image);
+		}
+		image = converted;
+	}
+	return image;
+}
+
+Image_ImageHeader const *TextureLoad_PackMipmaps(Image_ImageHeader const *image, TextureLoad_Stats *stats) {
+	if (Image_MipMapCountOf(image) <= 1) {
+		return image;
+	}
+
+	Image_ImageHeader const *packed = Image_PackMipmaps(image);
+	if (image != packed) {
+		TextureLoad_StatsImageCreated(stats, packed);
+		TextureLoad_StatsImageDestroyed(stats, image);
+		Image_Destroy(image);
+	}
+	ASSERT(Image_HasPackedMipMaps(packed));
+	return packed;
+}
+
+Render_TextureHandle TextureLoad_CreateGpu(Render_RendererHandle renderer,
+																					 Image_ImageHeader const *image,
+																					 char const *debugName) {
+	Render_TextureCreateDesc createGPUDesc{
+			image->format,
+			Render_TUF_SHADER_READ,
+			image->width,
+			image->height,
+			image->depth,
+			image->slices,
+			(uint32_t) Image_MipMapCountOf(image),
+			0,
+			0,
+			(unsigned char *) Image_RawDataPtr(image),
+			debugName,
+	};
+
+	return Render_TextureSyncCreate(renderer, &createGPUDesc);
+}
+
+bool TextureLoad_HashFile(char const *fileName, Memory_Allocator *allocator, TextureLoad_File *file) {
+	memset(file, 0, sizeof(TextureLoad_File));
+	VFile_Handle fh = VFile_FromFile(fileName, Os_FM_ReadBinary);
+	if (!fh) {
+		LOGINFO("Load From File failed for %s", fileName);
+		return false;
+	}
+
+	file->size = VFile_Size(fh);
+	auto buffer = (uint8_t *) MEMORY_ALLOCATOR_MALLOC(allocator, READ_CHUNK_SIZE);
+	if (!buffer) {
+		VFile_Close(fh);
+		return false;
+	}
+
+	// streamed through one chunk so hashing never holds more than that of the file
+	ContentHash hash{};
+	uint64_t done = 0;
+	while (done < file->size) {
+		uint64_t const remaining = file->size - done;
+		size_t const chunk = (size_t) (remaining < READ_CHUNK_SIZE ? remaining : READ_CHUNK_SIZE);
+		if (VFile_Read(fh, buffer, chunk) != chunk) {
+			LOGINFO("Read failed for %s", fileName);
+			MEMORY_ALLOCATOR_FREE(allocator, buffer);
+			VFile_Close(fh);
+			return false;
+		}
+		ContentHash_Update(&hash, buffer, chunk);
+		done += chunk;
+	}
+	MEMORY_ALLOCATOR_FREE(allocator, buffer);
+	VFile_Close(fh);
+
+	file->contentHash = ContentHash_Final(&hash);
+	return true;
+}
+
+bool TextureLoad_DecodeHashedFile(Render_RendererHandle renderer,
+																	enkiTaskSchedulerHandle taskScheduler,
+																	char const *fileName,
+																	TextureLoad_File const *file,
+																	TextureLoad_Stats *stats,
+																	TextureLoad_Decoded *decoded) {
+	memset(decoded, 0, sizeof(TextureLoad_Decoded));
+	VFile_Handle fh = VFile_FromFile(fileName, Os_FM_ReadBinary);
+	if (!fh) {
+		LOGINFO("Load From File failed for %s", fileName);
+		return false;
+	}
+
+	decoded->image = TextureLoad_Decode(renderer, taskScheduler, fh, fileName, stats,
+																			&decoded->originalFormat, &decoded->gpuNative,
+																			&decoded->source);
+	VFile_Close(fh);
+	if (!decoded->image) {
+		return false;
+	}
+	if (decoded->source && !keepSource && !TinyImageFormat_IsCompressed(decoded->source->format)) {
+		TextureLoad_StatsImageDestroyed(stats, decoded->source);
+		Image_Destroy(decoded->source);
+		decoded->source = nullptr;
+	}
+
+	// huge arrays keep their mip chain unpacked, the pager copies slices out of it
+	decoded->paged = SlicePager_ShouldPage(decoded->image);
+	if (!decoded->paged) {
+		decoded->image = TextureLoad_PackMipmaps(decoded->image, stats);
+	}
+	decoded->contentHash = file->contentHash;
+	decoded->contentSize = file->size;
+	return true;
+}
+
+bool TextureLoad_DecodeFile(Render_RendererHandle renderer,
+														enkiTaskSchedulerHandle taskScheduler,
+														char const *fileName,
+														TextureLoad_Stats *stats,
+														TextureLoad_Decoded *decoded) {
+	TextureLoad_File file;
+	if (!TextureLoad_HashFile(fileName, &Memory_GlobalAllocator, &file)) {
+		memset(decoded, 0, sizeof(TextureLoad_Decoded));
+		return false;
+	}
+	return TextureLoad_DecodeHashedFile(renderer, taskScheduler, fileName, &file, stats, decoded);
+}
+
+void TextureLoad_ReleaseDecoded(Render_RendererHandle renderer, TextureLoad_Decoded *decoded) {
+	FramesInFlight_DestroyTexture(renderer, decoded->gpu);
+	if (decoded->source) {
+		Image_Destroy(decoded->source);
+	}
+	if (decoded->image) {
+		Image_Destroy(decoded->image);
+	}
+	memset(decoded, 0, sizeof(TextureLoad_Decoded));
+}
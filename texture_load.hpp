@@ -0,0 +1,95 @@
+#pragma once
+#ifndef DEVON_TEXTURE_LOAD_HPP
+#define DEVON_TEXTURE_LOAD_HPP
+
+#include "render_basics/api.h"
+#include "al2o3_vfile/vfile.h"
+#include "al2o3_memory/memory.h"
+#include "al2o3_enki/TaskScheduler_c.h"
+
+struct Image_ImageHeader;
+
+// image temporaries come from gfx_image, which takes no allocator, so are counted per load.
+// The rest (hash buffer, EXR file contents) come from the loads scratch arena
+typedef struct TextureLoad_Stats {
+	uint32_t imageAllocations;
+	uint64_t liveImageBytes;
+	uint64_t peakImageBytes;
+	uint64_t scratchAllocations;
+	uint64_t peakScratchBytes;
+} TextureLoad_Stats;
+
+void TextureLoad_StatsImageCreated(TextureLoad_Stats *stats, Image_ImageHeader const *image);
+void TextureLoad_StatsImageDestroyed(TextureLoad_Stats *stats, Image_ImageHeader const *image);
+
+// Image_Load then converts anything the renderer can't sample (to RGBA8 or by
+// decompressing, BC6H to half float across the task scheduler). Mips are left as
+// loaded. Safe to call from worker threads, name is only used for logging and
+// stats may be null.
+// gpuNative is false if the CPU had to convert it. If source isn't null a
+// converted image's original is handed back there rather than destroyed,
+// otherwise it's set to null
+Image_ImageHeader const *TextureLoad_Decode(Render_RendererHandle renderer,
+																						enkiTaskSchedulerHandle taskScheduler,
+																						VFile_Handle fh,
+																						char const *name,
+																						TextureLoad_Stats *stats,
+																						TinyImageFormat *originalFormat,
+																						bool *gpuNative,
+																						Image_ImageHeader const **source);
+
+// packs a mip chain into a single allocation ready for upload, destroying the unpacked image
+Image_ImageHeader const *TextureLoad_PackMipmaps(Image_ImageHeader const *image, TextureLoad_Stats *stats);
+
+// what a file's content is known by, its bytes aren't kept
+typedef struct TextureLoad_File {
+	uint64_t size;
+	uint64_t contentHash;
+} TextureLoad_File;
+
+// streams the file through a small buffer from allocator. Worker thread safe, false if
+// it can't be read
+bool TextureLoad_HashFile(char const *fileName, Memory_Allocator *allocator, TextureLoad_File *file);
+
+// block compressed textures the GPU can't sample always keep their original so the texel
+// readout shows the stored values. This keeps uncompressed ones too, costing their size
+// again in CPU memory, otherwise their readout is of the converted image. Set before any
+// decodes start
+void TextureLoad_SetKeepSource(bool keep);
+
+// a whole file decoded and ready to view, image is packed unless paged
+typedef struct TextureLoad_Decoded {
+	uint64_t contentHash; // of the file it came from
+	uint64_t contentSize;
+	Image_ImageHeader const *image;
+	Image_ImageHeader const *source; // the unconverted original if kept, else null
+	TinyImageFormat originalFormat;
+	bool gpuNative;
+	bool paged; // too big to upload whole, for a slice pager
+	Render_TextureHandle gpu; // invalid until someone uploads image
+} TextureLoad_Decoded;
+
+// decodes straight from the file (read a second time after hashing, so the OS cache
+// normally serves it) and for non paged images packs the mips. Only the decoded images
+// are held, never the file as well. Worker thread safe, false if it can't be decoded
+bool TextureLoad_DecodeHashedFile(Render_RendererHandle renderer,
+																	enkiTaskSchedulerHandle taskScheduler,
+																	char const *fileName,
+																	TextureLoad_File const *file,
+																	TextureLoad_Stats *stats,
+																	TextureLoad_Decoded *decoded);
+// HashFile then DecodeHashedFile
+bool TextureLoad_DecodeFile(Render_RendererHandle renderer,
+														enkiTaskSchedulerHandle taskScheduler,
+														char const *fileName,
+														TextureLoad_Stats *stats,
+														TextureLoad_Decoded *decoded);
+// destroys whatever the decode still owns, its GPU texture is retired. Main thread only
+void TextureLoad_ReleaseDecoded(Render_RendererHandle renderer, TextureLoad_Decoded *decoded);
+
+// creates a sampleable texture from a packed image
+Render_TextureHandle TextureLoad_CreateGpu(Render_RendererHandle renderer,
+																					 Image_ImageHeader const *image,
+																					 char const *debugName);
+
+#endif //DEVON_TEXTURE_LOAD_HPP
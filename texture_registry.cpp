@@ -0,0 +1,90 @@
+#include "al2o3_platform/platform.h"
+#include "al2o3_memory/memory.h"
+
+#include "texture_registry.hpp"
+
+// power of 2, entries chain off their bucket
+static const uint32_t BUCKET_COUNT = 256;
+
+struct TextureRegistry_Entry {
+	TextureRegistry_Entry *next;
+	uint32_t refCount;
+	TextureLoad_Decoded decoded;
+};
+
+namespace {
+
+TextureRegistry_Entry *buckets[BUCKET_COUNT];
+
+TextureRegistry_Entry **BucketOf(uint64_t contentHash) {
+	return &buckets[contentHash & (BUCKET_COUNT - 1)];
+}
+
+TextureRegistry_Entry *Find(uint64_t contentHash, uint64_t contentSize) {
+	for (TextureRegistry_Entry *entry = *BucketOf(contentHash); entry; entry = entry->next) {
+		if (entry->decoded.contentHash == contentHash && entry->decoded.contentSize == contentSize) {
+			return entry;
+		}
+	}
+	return nullptr;
+}
+
+} // end anon namespace
+
+TextureRegistry_EntryHandle TextureRegistry_Acquire(uint64_t contentHash, uint64_t contentSize) {
+	TextureRegistry_Entry *entry = Find(contentHash, contentSize);
+	if (entry) {
+		entry->refCount++;
+	}
+	return entry;
+}
+
+TextureRegistry_EntryHandle TextureRegistry_Add(Render_RendererHandle renderer, TextureLoad_Decoded *decoded) {
+	TextureRegistry_Entry *entry = TextureRegistry_Acquire(decoded->contentHash, decoded->contentSize);
+	if (entry) {
+		// two loads of the same content were in flight at once, keep the first
+		TextureLoad_ReleaseDecoded(renderer, decoded);
+		return entry;
+	}
+
+	entry = (TextureRegistry_Entry *) MEMORY_CALLOC(1, sizeof(TextureRegistry_Entry));
+	if (!entry) {
+		TextureLoad_ReleaseDecoded(renderer, decoded);
+		return nullptr;
+	}
+	entry->refCount = 1;
+	entry->decoded = *decoded;
+	memset(decoded, 0, sizeof(TextureLoad_Decoded));
+
+	TextureRegistry_Entry **bucket = BucketOf(entry->decoded.contentHash);
+	entry->next = *bucket;
+	*bucket = entry;
+	return entry;
+}
+
+void TextureRegistry_Release(Render_RendererHandle renderer, TextureRegistry_EntryHandle entry) {
+	if (!entry) {
+		return;
+	}
+	ASSERT(entry->refCount > 0);
+	if (--entry->refCount > 0) {
+		return;
+	}
+
+	TextureRegistry_Entry **link = BucketOf(entry->decoded.contentHash);
+	while (*link != entry) {
+		link = &(*link)->next;
+	}
+	*link = entry->next;
+
+	TextureLoad_ReleaseDecoded(renderer, &entry->decoded);
+	MEMORY_FREE(entry);
+}
+
+TextureLoad_Decoded *TextureRegistry_DecodedOf(TextureRegistry_EntryHandle entry) {
+	return entry ? &entry->decoded : nullptr;
+}
+
+uint32_t TextureRegistry_RefCountOf(TextureRegistry_EntryHandle entry) {
+	return entry ? entry->refCount : 0;
+}
@@ -0,0 +1,25 @@
+#pragma once
+#ifndef DEVON_TEXTURE_REGISTRY_HPP
+#define DEVON_TEXTURE_REGISTRY_HPP
+
+#include "render_basics/api.h"
+#include "texture_load.hpp"
+
+// Decoded textures shared between windows by content. Entries are keyed on the hash
+// and size of the file bytes, so the same file opened twice or byte identical files
+// under different names decode and upload once. Main thread only.
+typedef struct TextureRegistry_Entry *TextureRegistry_EntryHandle;
+
+// a new reference to content already open, null if there isn't any
+TextureRegistry_EntryHandle TextureRegistry_Acquire(uint64_t contentHash, uint64_t contentSize);
+// takes the decode and returns a reference to it. If its content got there first the
+// decode is released and the existing entry is shared instead
+TextureRegistry_EntryHandle TextureRegistry_Add(Render_RendererHandle renderer, TextureLoad_Decoded *decoded);
+// the last reference releases the decode and its GPU texture
+void TextureRegistry_Release(Render_RendererHandle renderer, TextureRegistry_EntryHandle entry);
+
+// shared, the GPU texture is uploaded by whoever first needs it
+TextureLoad_Decoded *TextureRegistry_DecodedOf(TextureRegistry_EntryHandle entry);
+uint32_t TextureRegistry_RefCountOf(TextureRegistry_EntryHandle entry);
+
+#endif //DEVON_TEXTURE_REGISTRY_HPP
@@ -4,19 +4,22 @@
 #include "gfx_imgui/imgui.h"
 #include "gfx_imgui/imgui_internal.h"
 #include "al2o3_cadt/vector.h"
+#include "al2o3_os/time.h"
+#include <cstdio> // for snprintf
+#include <cmath>
 
 #include "render_basics/api.h"
 #include "render_basics/buffer.h"
 #include "render_basics/descriptorset.h"
 #include "render_basics/framebuffer.h"
 #include "render_basics/graphicsencoder.h"
-#include "render_basics/rootsignature.h"
-#include "render_basics/pipeline.h"
-#include "render_basics/shader.h"
 #include "render_basics/texture.h"
 #include "render_basics/view.h"
 
 #include "texture_viewer.hpp"
+#include "texture_bytes.hpp"
+#include "frames_in_flight.hpp"
+#include "quad_pipeline.hpp"
 
 struct UniformBuffer {
 	float scaleOffsetMatrix[16];
@@ -26,27 +29,54 @@ struct UniformBuffer {
 	int32_t signedRGB;
 	uint32_t sliceToView;
 	uint32_t numSlices;
+	uint32_t autoLod;
+	uint32_t trilinear;
+	float maxMipLevel;
+	float autoLodLevel;
 };
 
 static const uint64_t UNIFORM_BUFFER_SIZE_PER_FRAME = 256;
 
-struct TextureViewer {
+// every viewer draws with the same pipeline and dummies, made when the first
+// viewer is and destroyed with the last so startup doesn't pay for them
+struct SharedResources {
+	uint32_t refCount;
 	Render_RendererHandle renderer;
-	Render_FrameBufferHandle frameBuffer;
 
-	Render_ShaderHandle shader;
-	Render_RootSignatureHandle rootSignature;
-	Render_PipelineHandle pipeline;
-	Render_DescriptorSetHandle descriptorSet;
-	Render_BufferHandle uniformBuffer;
+	QuadPipeline quad;
 
 	Render_TextureHandle dummy2DTexture;
 	Render_TextureHandle dummy2DArrayTexture;
 	Render_TextureHandle dummy3DTexture;
+};
+
+struct TextureViewer {
+	Render_RendererHandle renderer;
+	Render_FrameBufferHandle frameBuffer;
+
+	Render_DescriptorSetHandle descriptorSet;
+	Render_BufferHandle uniformBuffer;
 
 	UniformBuffer uniforms;
+	UniformBuffer uploadedUniforms;
+	uint32_t dirtyFrames;
 	bool colourChannelEnable[4];
 	float zoom;
+	// mip from the on screen footprint rather than the slider, optionally blending mips
+	bool autoLod;
+	bool trilinear;
+
+	// culled viewers skip uniform upload, descriptor update and draw
+	bool visible;
+	bool focused;
+	// last frames cost, CPU time spent encoding the draw and how much of the screen it covered
+	int64_t encodeUs;
+	uint64_t screenPixels;
+	TextureViewer_ResidencyCallback residencyCallback;
+	void *residencyUserData;
+
+	TextureViewer_ExtraUICallback extraUICallback;
+	void *extraUIUserData;
 
 	Render_GraphicsEncoderHandle currentEncoder;
 
@@ -55,6 +85,8 @@ struct TextureViewer {
 
 namespace {
 
+SharedResources shared;
+
 static uint32_t const DummyData[] = {
 		0x00FFFF00, 0x00FFFF00, 0x00FFFF00, 0x00FFFF00,
 		0x00000000, 0x00000000, 0x00000000, 0x00000000,
@@ -71,7 +103,7 @@ static uint32_t const DummyData[] = {
 		0xFF8000FF, 0xFF8000FF, 0xFF8000FF, 0xFF8000FF,
 		0xFF0080FF, 0xFF0080FF, 0xFF0080FF, 0xFF0080FF};
 
-static void CreateDummyTextures(TextureViewer *ctx) {
+static void CreateDummyTextures(SharedResources *res) {
 	Render_TextureCreateDesc const raw2DImageData{
 			TinyImageFormat_R8G8B8A8_UNORM,
 			Render_TUF_SHADER_READ,
@@ -91,56 +123,147 @@ static void CreateDummyTextures(TextureViewer *ctx) {
 			DummyData
 	};
 
-	ctx->dummy2DTexture = Render_TextureSyncCreate(ctx->renderer, &raw2DImageData);
-	ctx->dummy2DArrayTexture = Render_TextureSyncCreate(ctx->renderer, &raw2DArrayImageData);
-	ctx->dummy3DTexture = Render_TextureSyncCreate(ctx->renderer, &raw3DImageData);
+	res->dummy2DTexture = Render_TextureSyncCreate(res->renderer, &raw2DImageData);
+	res->dummy2DArrayTexture = Render_TextureSyncCreate(res->renderer, &raw2DArrayImageData);
+	res->dummy3DTexture = Render_TextureSyncCreate(res->renderer, &raw3DImageData);
 }
 
-bool CreateShaders(TextureViewer *ctx) {
+void DestroySharedResources() {
+	Render_TextureDestroy(shared.renderer, shared.dummy3DTexture);
+	Render_TextureDestroy(shared.renderer, shared.dummy2DArrayTexture);
+	Render_TextureDestroy(shared.renderer, shared.dummy2DTexture);
+	QuadPipeline_Destroy(shared.renderer, &shared.quad);
+	memset(&shared, 0, sizeof(SharedResources));
+}
 
-	static char const *const vertEntryPoint = "VS_main";
-	static char const *const fragEntryPoint = "FS_main";
+bool AcquireSharedResources(Render_RendererHandle renderer, Render_FrameBufferHandle frameBuffer) {
+	if (shared.refCount) {
+		shared.refCount++;
+		return true;
+	}
+	shared.renderer = renderer;
 
-	VFile_Handle vfile = VFile_FromFile("textureviewer_vertex.hlsl", Os_FM_Read);
-	if (!vfile) {
+	Render_SamplerHandle samplers[]{
+			Render_GetStockSampler(renderer, Render_SST_POINT),
+			Render_GetStockSampler(renderer, Render_SST_LINEAR),
+	};
+	char const *staticSamplerNames[]{"pointSampler", "bilinearSampler"};
+	QuadPipeline_Desc const quadDesc{
+			"textureviewer_vertex.hlsl",
+			"textureviewer_fragment.hlsl",
+			2,
+			samplers,
+			staticSamplerNames
+	};
+	if (!QuadPipeline_Create(renderer, frameBuffer, &quadDesc, &shared.quad)) {
+		DestroySharedResources();
 		return false;
 	}
-	VFile_Handle ffile = VFile_FromFile("textureviewer_fragment.hlsl", Os_FM_Read);
-	if (!ffile) {
-		VFile_Close(vfile);
+
+	CreateDummyTextures(&shared);
+	shared.refCount = 1;
+	return true;
+}
+
+void ReleaseSharedResources() {
+	ASSERT(shared.refCount);
+	if (--shared.refCount == 0) {
+		DestroySharedResources();
+	}
+}
+
+// true if any of the image can be seen. Occlusion uses last frames window order
+// and only counts a single window fully covering it
+bool IsImageVisible(ImGuiWindow *window, ImRect const &imageRect) {
+	ImGuiIO const &io = ImGui::GetIO();
+
+	ImRect visibleRect = imageRect;
+	visibleRect.ClipWithFull(window->ClipRect);
+	visibleRect.ClipWithFull(ImRect(0.0f, 0.0f, io.DisplaySize.x, io.DisplaySize.y));
+	if (visibleRect.GetWidth() <= 0.0f || visibleRect.GetHeight() <= 0.0f) {
 		return false;
 	}
-	Render_ShaderObjectDesc vsod = {
-			Render_ST_VERTEXSHADER,
-			vfile,
-			vertEntryPoint
-	};
-	Render_ShaderObjectDesc fsod = {
-			Render_ST_FRAGMENTSHADER,
-			ffile,
-			fragEntryPoint
-	};
 
-	Render_ShaderObjectHandle shaderObjects[2]{};
-	shaderObjects[0] = Render_ShaderObjectCreate(ctx->renderer, &vsod);
-	shaderObjects[1] = Render_ShaderObjectCreate(ctx->renderer, &fsod);
+	// imgui keeps its windows in display order, back to front
+	ImGuiContext const &g = *GImGui;
+	ImGuiWindow const *root = window->RootWindow;
+	bool inFront = false;
+	for (int i = 0; i < g.Windows.Size; ++i) {
+		ImGuiWindow const *other = g.Windows[i];
+		if (other == root) {
+			inFront = true;
+			continue;
+		}
+		if (!inFront || other->RootWindow == root || other->Hidden) {
+			continue;
+		}
+		if (!other->Active && !other->WasActive) {
+			continue;
+		}
+		if (other->Rect().Contains(visibleRect)) {
+			return false;
+		}
+	}
+	return true;
+}
 
-	VFile_Close(vfile);
-	VFile_Close(ffile);
+// texels per framebuffer pixel as a mip level, 0 when magnifying. The shader is handed
+// this rather than working it out itself so the readout always reads the mip drawn
+float AutoLodLevel(float zoom, uint32_t mipCount) {
+	float const pixelsPerTexel = zoom * ImGui::GetIO().DisplayFramebufferScale.x;
+	float const lod = log2f(1.0f / pixelsPerTexel);
+	float const maxLod = (float) (mipCount - 1);
+	return lod <= 0.0f ? 0.0f : (lod < maxLod ? lod : maxLod);
+}
 
-	if (!Render_ShaderObjectHandleIsValid(shaderObjects[0]) ||
-			!Render_ShaderObjectHandleIsValid(shaderObjects[1])) {
-		Render_ShaderObjectDestroy(ctx->renderer, shaderObjects[0]);
-		Render_ShaderObjectDestroy(ctx->renderer, shaderObjects[1]);
-		return false;
+// readout of the texel under the mouse from whatever the fetcher reads. When
+// trilinear blends, blend is how much of the next mip down is mixed into what's shown
+void TexelTooltip(TextureViewer_Texture const *texture,
+									ImRect const &imageRect,
+									uint32_t mipLevel,
+									float blend,
+									uint32_t slice) {
+	if (!texture->fetcher || !ImGui::IsWindowHovered() || !ImGui::IsMouseHoveringRect(imageRect.Min, imageRect.Max)) {
+		return;
 	}
 
-	ctx->shader = Render_ShaderCreate(ctx->renderer, 2, shaderObjects);
+	uint32_t const width = (texture->cpu->width >> mipLevel) ? (texture->cpu->width >> mipLevel) : 1;
+	uint32_t const height = (texture->cpu->height >> mipLevel) ? (texture->cpu->height >> mipLevel) : 1;
+	ImVec2 const mouse = ImGui::GetIO().MousePos;
+	auto x = (uint32_t) (((mouse.x - imageRect.Min.x) / imageRect.GetWidth()) * (float) width);
+	auto y = (uint32_t) (((mouse.y - imageRect.Min.y) / imageRect.GetHeight()) * (float) height);
+	x = x < width ? x : width - 1;
+	y = y < height ? y : height - 1;
 
-	Render_ShaderObjectDestroy(ctx->renderer, shaderObjects[0]);
-	Render_ShaderObjectDestroy(ctx->renderer, shaderObjects[1]);
+	TexelFetch_Texel texel;
+	if (!TexelFetch_Fetch(texture->fetcher, x, y, slice, mipLevel, &texel)) {
+		return;
+	}
 
-	return true;
+	char raw[sizeof(texel.raw) * 2 + 1];
+	for (uint32_t i = 0; i < texel.rawSize; ++i) {
+		snprintf(raw + (i * 2), 3, "%02X", texel.raw[i]);
+	}
+	raw[texel.rawSize * 2] = 0;
+
+	ImGui::BeginTooltip();
+	ImGui::Text("%u, %u  mip %u  slice %u", x, y, mipLevel, slice);
+	if (blend > 0.0f) {
+		ImGui::Text("shown blended %.0f%% with mip %u", blend * 100.0f, mipLevel + 1);
+	}
+	ImGui::Text("%s %s", TinyImageFormat_Name(TexelFetch_Format(texture->fetcher)), raw);
+	ImGui::Text("R %g  G %g  B %g  A %g", texel.channels[0], texel.channels[1], texel.channels[2], texel.channels[3]);
+	ImGui::EndTooltip();
+}
+
+void SetVisible(TextureViewer *ctx, TextureViewer_Texture *texture, bool visible) {
+	if (ctx->visible == visible) {
+		return;
+	}
+	ctx->visible = visible;
+	if (ctx->residencyCallback) {
+		ctx->residencyCallback(ctx->residencyUserData, texture, visible);
+	}
 }
 
 } // end anon namespace
@@ -156,57 +279,21 @@ TextureViewerHandle TextureViewer_Create(Render_RendererHandle renderer,
 	ctx->renderer = renderer;
 	ctx->frameBuffer = frameBuffer;
 
-	if (!CreateShaders(ctx)) {
+	if (!AcquireSharedResources(renderer, frameBuffer)) {
 		MEMORY_FREE(ctx);
 		return nullptr;
 	}
 
-	Render_ShaderHandle shaders[]{ctx->shader};
-	Render_SamplerHandle samplers[]{
-			Render_GetStockSampler(renderer, Render_SST_POINT),
-			Render_GetStockSampler(renderer, Render_SST_LINEAR),
-	};
-
-	char const *staticSamplerNames[]{"pointSampler", "bilinearSampler"};
-	Render_RootSignatureDesc rootSignatureDesc{};
-	rootSignatureDesc.shaderCount = 1;
-	rootSignatureDesc.shaders = shaders;
-	rootSignatureDesc.staticSamplerCount = 2;
-	rootSignatureDesc.staticSamplerNames = staticSamplerNames;
-	rootSignatureDesc.staticSamplers = samplers;
-	ctx->rootSignature = Render_RootSignatureCreate(ctx->renderer, &rootSignatureDesc);
-	if (!Render_RootSignatureHandleIsValid(ctx->rootSignature)) {
-		return nullptr;
-	}
-
-	Render_GraphicsPipelineDesc gfxPipeDesc{};
-
-	TinyImageFormat colourFormats[] = {Render_FrameBufferColourFormat(frameBuffer)};
-	gfxPipeDesc.shader = ctx->shader;
-	gfxPipeDesc.rootSignature = ctx->rootSignature;
-	gfxPipeDesc.vertexLayout = Render_GetStockVertexLayout(renderer, Render_SVL_2D_COLOUR_UV);
-	gfxPipeDesc.blendState = Render_GetStockBlendState(renderer, Render_SBS_OPAQUE);
-	gfxPipeDesc.depthState = Render_GetStockDepthState(renderer, Render_SDS_IGNORE);
-	gfxPipeDesc.rasteriserState = Render_GetStockRasterisationState(renderer, Render_SRS_NOCULL);
-	gfxPipeDesc.colourRenderTargetCount = 1;
-	gfxPipeDesc.colourFormats = colourFormats;
-	gfxPipeDesc.depthStencilFormat = TinyImageFormat_UNDEFINED;
-	gfxPipeDesc.sampleCount = 1;
-	gfxPipeDesc.sampleQuality = 0;
-	gfxPipeDesc.primitiveTopo = Render_PT_TRI_LIST;
-	ctx->pipeline = Render_GraphicsPipelineCreate(ctx->renderer, &gfxPipeDesc);
-	if (!Render_PipelineHandleIsValid(ctx->pipeline)) {
-		return nullptr;
-	}
-
 	Render_DescriptorSetDesc const setDesc = {
-			ctx->rootSignature,
+			shared.quad.rootSignature,
 			Render_DUF_PER_FRAME,
 			1
 	};
 
 	ctx->descriptorSet = Render_DescriptorSetCreate(ctx->renderer, &setDesc);
 	if (!Render_DescriptorSetHandleIsValid(ctx->descriptorSet)) {
+		ReleaseSharedResources();
+		MEMORY_FREE(ctx);
 		return nullptr;
 	}
 
@@ -217,17 +304,20 @@ TextureViewerHandle TextureViewer_Create(Render_RendererHandle renderer,
 
 	ctx->uniformBuffer = Render_BufferCreateUniform(ctx->renderer, &ubDesc);
 	if (!Render_BufferHandleIsValid(ctx->uniformBuffer)) {
+		Render_DescriptorSetDestroy(ctx->renderer, ctx->descriptorSet);
+		ReleaseSharedResources();
+		MEMORY_FREE(ctx);
 		return nullptr;
 	}
 
-	CreateDummyTextures(ctx);
-
 	// defaults
 	ctx->colourChannelEnable[0] = true;
 	ctx->colourChannelEnable[1] = true;
 	ctx->colourChannelEnable[2] = true;
 	ctx->colourChannelEnable[3] = false;
 	ctx->zoom = 1.0f;
+	ctx->autoLod = true;
+	ctx->visible = true;
 
 	static char const DefaultName[] = "Texture Viewer";
 	ctx->windowName = (char *) MEMORY_CALLOC(strlen(DefaultName) + 1, 1);
@@ -244,15 +334,9 @@ void TextureViewer_Destroy(TextureViewerHandle handle) {
 
 	MEMORY_FREE(ctx->windowName);
 
-	Render_TextureDestroy(ctx->renderer, ctx->dummy3DTexture);
-	Render_TextureDestroy(ctx->renderer, ctx->dummy2DArrayTexture);
-	Render_TextureDestroy(ctx->renderer, ctx->dummy2DTexture);
-
 	Render_BufferDestroy(ctx->renderer, ctx->uniformBuffer);
 	Render_DescriptorSetDestroy(ctx->renderer, ctx->descriptorSet);
-	Render_PipelineDestroy(ctx->renderer, ctx->pipeline);
-	Render_RootSignatureDestroy(ctx->renderer, ctx->rootSignature);
-	Render_ShaderDestroy(ctx->renderer, ctx->shader);
+	ReleaseSharedResources();
 
 	MEMORY_FREE(ctx);
 }
@@ -263,6 +347,7 @@ static void ImCallback(ImDrawList const *list, ImDrawCmd const *imcmd) {
 	}
 
 	auto ctx = (TextureViewer *) imcmd->UserCallbackData;
+	int64_t const startUs = Os_GetUSec();
 
 	TextureViewer_Texture const *texture = (TextureViewer_Texture *) imcmd->TextureId;
 
@@ -271,19 +356,26 @@ static void ImCallback(ImDrawList const *list, ImDrawCmd const *imcmd) {
 	displayPos.x *= drawData->FramebufferScale.x;
 	displayPos.y *= drawData->FramebufferScale.y;
 
-	Render_GraphicsEncoderBindPipeline(ctx->currentEncoder, ctx->pipeline);
+	Render_GraphicsEncoderBindPipeline(ctx->currentEncoder, shared.quad.pipeline);
 
 	Render_DescriptorDesc params[3];
 	params[0].name = "colourTexture";
 	params[0].type = Render_DT_TEXTURE;
 	params[1].name = "colourTextureArray";
 	params[1].type = Render_DT_TEXTURE;
-	if (Image_IsArray(texture->cpu)) {
-		params[0].texture = ctx->dummy2DTexture;
+	if (texture->pager) {
+		Render_TextureHandle const sliceTexture = SlicePager_CurrentTexture(texture->pager);
+		if (!Render_TextureHandleIsValid(sliceTexture)) {
+			return;
+		}
+		params[0].texture = sliceTexture;
+		params[1].texture = shared.dummy2DArrayTexture;
+	} else if (Image_IsArray(texture->cpu)) {
+		params[0].texture = shared.dummy2DTexture;
 		params[1].texture = texture->gpu;
 	} else {
 		params[0].texture = texture->gpu;
-		params[1].texture = ctx->dummy2DArrayTexture;
+		params[1].texture = shared.dummy2DArrayTexture;
 	}
 	params[2].name = "uniformBlock";
 	params[2].type = Render_DT_BUFFER;
@@ -308,6 +400,7 @@ static void ImCallback(ImDrawList const *list, ImDrawCmd const *imcmd) {
 																	 });
 
 	Render_GraphicsEncoderDrawIndexed(ctx->currentEncoder, 6, imcmd->IdxOffset, imcmd->VtxOffset);
+	ctx->encodeUs += Os_GetUSec() - startUs;
 }
 
 bool TextureViewer_DrawUI(TextureViewerHandle handle, TextureViewer_Texture *texture) {
@@ -323,13 +416,20 @@ bool TextureViewer_DrawUI(TextureViewerHandle handle, TextureViewer_Texture *tex
 		ImGui::End();
 		return false;
 	}
+	ctx->focused = ImGui::IsWindowFocused(ImGuiFocusedFlags_RootAndChildWindows);
 
 	ImGuiWindow *window = ImGui::GetCurrentWindow();
 	ImDrawList *drawList = ImGui::GetWindowDrawList();
-	if (window->SkipItems || !texture) {
+	if (!texture) {
 		ImGui::End();
 		return false;
 	}
+	if (window->SkipItems) {
+		// collapsed, still open just nothing to draw
+		SetVisible(ctx, texture, false);
+		ImGui::End();
+		return true;
+	}
 
 	ImGui::Checkbox("R", ctx->colourChannelEnable + 0);
 	ImGui::SameLine();
@@ -340,17 +440,35 @@ bool TextureViewer_DrawUI(TextureViewerHandle handle, TextureViewer_Texture *tex
 	ImGui::Checkbox("A", ctx->colourChannelEnable + 3);
 	ImGui::SameLine();
 
+	auto const mipCount = (uint32_t) Image_MipMapCountOf(texture->cpu);
+	if (mipCount > 1) {
+		ImGui::Checkbox("Auto mip", &ctx->autoLod);
+		ImGui::SameLine();
+		if (ctx->autoLod) {
+			ImGui::Checkbox("Trilinear", &ctx->trilinear);
+			ImGui::SameLine();
+		}
+	}
+
 	ImGui::SliderFloat("Zoom", &ctx->zoom, 1.0f / texture->cpu->width, 256.0f, "%.3f", 2);
 	ImVec2 rb{window->DC.CursorPos.x + (texture->cpu->width * ctx->zoom),
 						window->DC.CursorPos.y + (texture->cpu->height * ctx->zoom)};
 	ImRect const bb(window->DC.CursorPos, rb);
 
-	drawList->PushTextureID(texture);
-	drawList->PrimReserve(6, 4);
-	drawList->PrimRectUV(bb.Min, bb.Max, {0, 0}, {1, 1}, 0xFFFFFFFF);
-	drawList->CmdBuffer.back().ElemCount = 0; // stop the rect rendering instead do a callback
-	drawList->AddCallback(&ImCallback, handle);
-	drawList->PopTextureID();
+	SetVisible(ctx, texture, IsImageVisible(window, bb));
+	ctx->screenPixels = 0;
+	if (ctx->visible) {
+		ImRect onScreen = bb;
+		onScreen.ClipWith(window->ClipRect);
+		ctx->screenPixels = (uint64_t) (onScreen.GetWidth() * onScreen.GetHeight());
+
+		drawList->PushTextureID(texture);
+		drawList->PrimReserve(6, 4);
+		drawList->PrimRectUV(bb.Min, bb.Max, {0, 0}, {1, 1}, 0xFFFFFFFF);
+		drawList->CmdBuffer.back().ElemCount = 0; // stop the rect rendering instead do a callback
+		drawList->AddCallback(&ImCallback, handle);
+		drawList->PopTextureID();
+	}
 
 	// size of the auto size window takes
 	if (rb.y < window->DC.CursorPos.y + 32.0f) {
@@ -362,18 +480,41 @@ bool TextureViewer_DrawUI(TextureViewerHandle handle, TextureViewer_Texture *tex
 	int forceMipLevel = 0;
 	int sliceToView = 0;
 	bool signedRGB = false;
-	if (Image_MipMapCountOf(texture->cpu) > 1) {
+	bool const autoLod = ctx->autoLod && mipCount > 1;
+	if (mipCount > 1 && !autoLod) {
 		forceMipLevel = (int) ctx->uniforms.forceMipLevel;
 		ImGui::SameLine();
 		ImGui::VSliderInt("Mipmap Level", ImVec2(20.0f, 100.0f),
-											&forceMipLevel, 0, (int) Image_MipMapCountOf(texture->cpu) - 1);
+											&forceMipLevel, 0, (int) mipCount - 1);
+	} else if (autoLod) {
+		// keep the slider where it was for when auto is turned off
+		forceMipLevel = (int) ctx->uniforms.forceMipLevel;
 	}
 	ctx->uniforms.forceMipLevel = (int32_t) forceMipLevel;
+	ctx->uniforms.autoLod = autoLod;
+	ctx->uniforms.trilinear = ctx->trilinear;
+	ctx->uniforms.maxMipLevel = (float) (mipCount - 1);
+	ctx->uniforms.autoLodLevel = AutoLodLevel(ctx->zoom, mipCount);
+	// whilst the pager is still bringing the asked for slice in it draws the nearest it has
+	uint32_t shownSlice = ctx->uniforms.sliceToView;
+	if (texture->pager) {
+		shownSlice = SlicePager_ShownSlice(texture->pager);
+	}
 	if (texture->cpu->slices > 1) {
 		sliceToView = (int) ctx->uniforms.sliceToView;
+		bool const pagingIn = shownSlice != ctx->uniforms.sliceToView;
 		ImGui::SameLine();
+		if (pagingIn) {
+			ImGui::PushStyleColor(ImGuiCol_SliderGrab, ImVec4(1.0f, 0.6f, 0.0f, 1.0f));
+		}
 		ImGui::VSliderInt("Slice", ImVec2(20.0f, 100.0f),
 											&sliceToView, 0, (int) texture->cpu->slices - 1);
+		if (pagingIn) {
+			ImGui::PopStyleColor();
+			if (ImGui::IsItemHovered()) {
+				ImGui::SetTooltip("Showing slice %u whilst slice %d pages in", shownSlice, sliceToView);
+			}
+		}
 	}
 	if (TinyImageFormat_IsSigned(texture->cpu->format)) {
 		signedRGB = (bool) ctx->uniforms.signedRGB;
@@ -381,10 +522,36 @@ bool TextureViewer_DrawUI(TextureViewerHandle handle, TextureViewer_Texture *tex
 		ImGui::Checkbox("Signed decode", &signedRGB);
 	}
 
-	ctx->uniforms.numSlices = texture->cpu->slices;
+	if (texture->pager) {
+		// the pager hands out a single slice as a 2D texture
+		SlicePager_SetCurrentSlice(texture->pager, (uint32_t) sliceToView);
+		shownSlice = SlicePager_ShownSlice(texture->pager);
+		ctx->uniforms.numSlices = 1;
+	} else {
+		shownSlice = (uint32_t) sliceToView;
+		ctx->uniforms.numSlices = texture->cpu->slices;
+	}
 	ctx->uniforms.sliceToView = (uint32_t) sliceToView;
 	ctx->uniforms.signedRGB = signedRGB;
 
+	if (ctx->visible) {
+		// the same picks the shader makes with autoLodLevel
+		float const lod = ctx->uniforms.autoLodLevel;
+		uint32_t mipLevel = (uint32_t) forceMipLevel;
+		float blend = 0.0f;
+		if (autoLod && ctx->trilinear) {
+			mipLevel = (uint32_t) floorf(lod);
+			blend = lod - floorf(lod);
+		} else if (autoLod) {
+			mipLevel = (uint32_t) floorf(lod + 0.5f);
+		}
+		TexelTooltip(texture, bb, mipLevel, blend, shownSlice);
+	}
+
+	if (ctx->extraUICallback) {
+		ctx->extraUICallback(ctx->extraUIUserData, texture);
+	}
+
 	ImGui::End();
 	return true;
 }
@@ -394,6 +561,10 @@ void TextureViewer_RenderSetup(TextureViewerHandle handle, Render_GraphicsEncode
 	if (!ctx) {
 		return;
 	}
+	ctx->encodeUs = 0;
+	if (!ctx->visible) {
+		return;
+	}
 
 	static_assert(sizeof(UniformBuffer) < UNIFORM_BUFFER_SIZE_PER_FRAME);
 
@@ -415,16 +586,126 @@ void TextureViewer_RenderSetup(TextureViewerHandle handle, Render_GraphicsEncode
 		ctx->uniforms.alphaReplicate = 0.0f;
 	}
 
+	ctx->currentEncoder = encoder;
+
+	// the viewers dirty flag. Uniforms are written by the widgets, the setters, a resize
+	// (the scale offset matrix) and texture swaps (size and mip count), comparing the block
+	// catches all of them without each having to remember to flag it
+	if (memcmp(&ctx->uploadedUniforms, &ctx->uniforms, sizeof(UniformBuffer)) != 0) {
+		memcpy(&ctx->uploadedUniforms, &ctx->uniforms, sizeof(UniformBuffer));
+		ctx->dirtyFrames = UNIFORM_UPLOADS_PER_CHANGE;
+	}
+	if (ctx->dirtyFrames == 0) {
+		return;
+	}
+	ctx->dirtyFrames--;
+
 	Render_BufferUpdateDesc uniformUpdate = {
 			&ctx->uniforms,
 			0,
 			UNIFORM_BUFFER_SIZE_PER_FRAME
 	};
 	Render_BufferUpload(ctx->uniformBuffer, &uniformUpdate);
-	ctx->currentEncoder = encoder;
 
 }
 
+void TextureViewer_SetResidencyCallback(TextureViewerHandle handle,
+																				TextureViewer_ResidencyCallback callback,
+																				void *userData) {
+	auto ctx = (TextureViewer *) handle;
+	if (!ctx) {
+		return;
+	}
+
+	ctx->residencyCallback = callback;
+	ctx->residencyUserData = userData;
+}
+
+void TextureViewer_SetExtraUICallback(TextureViewerHandle handle,
+																			TextureViewer_ExtraUICallback callback,
+																			void *userData) {
+	auto ctx = (TextureViewer *) handle;
+	if (!ctx) {
+		return;
+	}
+
+	ctx->extraUICallback = callback;
+	ctx->extraUIUserData = userData;
+}
+
+bool TextureViewer_IsVisible(TextureViewerHandle handle) {
+	auto ctx = (TextureViewer *) handle;
+	if (!ctx) {
+		return false;
+	}
+
+	return ctx->visible;
+}
+
+void TextureViewer_GetTiming(TextureViewerHandle handle, int64_t *encodeUs, uint64_t *screenPixels) {
+	auto ctx = (TextureViewer *) handle;
+	if (!ctx) {
+		*encodeUs = 0;
+		*screenPixels = 0;
+		return;
+	}
+
+	*encodeUs = ctx->encodeUs;
+	*screenPixels = ctx->screenPixels;
+}
+
+void TextureViewer_SetMipLevel(TextureViewerHandle handle, uint32_t mipLevel) {
+	auto ctx = (TextureViewer *) handle;
+	if (!ctx) {
+		return;
+	}
+	ctx->autoLod = false;
+	ctx->uniforms.forceMipLevel = (int32_t) mipLevel;
+}
+
+void TextureViewer_SetAutoMip(TextureViewerHandle handle) {
+	auto ctx = (TextureViewer *) handle;
+	if (!ctx) {
+		return;
+	}
+	ctx->autoLod = true;
+}
+
+void TextureViewer_SetSlice(TextureViewerHandle handle, uint32_t slice) {
+	auto ctx = (TextureViewer *) handle;
+	if (!ctx) {
+		return;
+	}
+	ctx->uniforms.sliceToView = slice;
+}
+
+bool TextureViewer_IsFocused(TextureViewerHandle handle) {
+	auto ctx = (TextureViewer *) handle;
+	if (!ctx) {
+		return false;
+	}
+
+	return ctx->focused;
+}
+
+uint64_t TextureViewer_OverheadBytes(TextureViewerHandle handle) {
+	auto ctx = (TextureViewer *) handle;
+	if (!ctx) {
+		return 0;
+	}
+
+	// the dummy textures are shared, each viewer carries its share of them
+	uint64_t const dummyBytes =
+			TextureBytes_Of(TinyImageFormat_R8G8B8A8_UNORM, 4, 4, 1, 1, 1) +
+			TextureBytes_Of(TinyImageFormat_R8G8B8A8_UNORM, 4, 4, 1, 3, 1) +
+			TextureBytes_Of(TinyImageFormat_R8G8B8A8_UNORM, 4, 4, 3, 1, 1);
+
+	return sizeof(TextureViewer) +
+			strlen(ctx->windowName) + 1 +
+			(UNIFORM_BUFFER_SIZE_PER_FRAME * FRAMES_IN_FLIGHT) +
+			(shared.refCount ? dummyBytes / shared.refCount : 0);
+}
+
 void TextureViewer_SetWindowName(TextureViewerHandle handle, char const *windowName) {
 	auto ctx = (TextureViewer *) handle;
 	if (!ctx) {
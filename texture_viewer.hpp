@@ -3,12 +3,18 @@
 #define DEVON_TEXTURE_VIEWER_HPP
 
 #include "render_basics/api.h"
+#include "slice_pager.hpp"
+#include "texel_fetch.hpp"
 typedef struct TextureViewer *TextureViewerHandle;
 struct Image_ImageHeader;
 
 typedef struct TextureViewer_Texture {
 	Image_ImageHeader const *cpu;
 	Render_TextureHandle gpu;
+	// if set the array is paged, gpu is unused and slices come from the pager
+	SlicePagerHandle pager;
+	// if set hovering shows the stored texel under the mouse
+	TexelFetchHandle fetcher;
 } TextureViewer_Texture;
 
 TextureViewerHandle TextureViewer_Create(Render_RendererHandle renderer,
@@ -19,7 +25,38 @@ bool TextureViewer_DrawUI(TextureViewerHandle handle, TextureViewer_Texture *tex
 // must be called before Imguibinding render. Sets up things for the callbacks from imgui
 void TextureViewer_RenderSetup(TextureViewerHandle handle, Render_GraphicsEncoderHandle encoder);
 
+// called when a viewer is culled (collapsed, covered or off screen) or becomes visible again
+// so the owner can demote/promote the textures resources
+typedef void (*TextureViewer_ResidencyCallback)(void *userData, TextureViewer_Texture *texture, bool visible);
+void TextureViewer_SetResidencyCallback(TextureViewerHandle handle,
+																				TextureViewer_ResidencyCallback callback,
+																				void *userData);
+bool TextureViewer_IsVisible(TextureViewerHandle handle);
+// true if the window had keyboard focus as of the last DrawUI
+bool TextureViewer_IsFocused(TextureViewerHandle handle);
+
+// lets the owner add its own controls under the standard ones
+typedef void (*TextureViewer_ExtraUICallback)(void *userData, TextureViewer_Texture *texture);
+void TextureViewer_SetExtraUICallback(TextureViewerHandle handle,
+																			TextureViewer_ExtraUICallback callback,
+																			void *userData);
+
+// CPU and GPU bytes the viewer itself holds, not counting the texture being viewed.
+// The pipeline and dummy textures are shared by every viewer (made with the first,
+// gone with the last) so each counts its share. Driver side pipeline and descriptor
+// memory isn't visible so isn't included
+uint64_t TextureViewer_OverheadBytes(TextureViewerHandle handle);
+
 void TextureViewer_SetWindowName(TextureViewerHandle handle, char const *windowName);
 void TextureViewer_SetZoom(TextureViewerHandle handle, float zoom);
+// fixes the mip level shown (turning auto mip off) and the slice, both must be in range
+void TextureViewer_SetMipLevel(TextureViewerHandle handle, uint32_t mipLevel);
+// back to picking the mip from the zoom as the GPU would
+void TextureViewer_SetAutoMip(TextureViewerHandle handle);
+void TextureViewer_SetSlice(TextureViewerHandle handle, uint32_t slice);
+
+// the last drawn frames CPU time encoding this viewer and its on screen area. There are
+// no GPU timestamps in render_basics, pixels covered is the best proxy for its GPU cost
+void TextureViewer_GetTiming(TextureViewerHandle handle, int64_t *encodeUs, uint64_t *screenPixels);
 
 #endif //DEVON__TEXTURE_VIEWER_HPP